@@ -0,0 +1,868 @@
+//
+//  ColladaDocument.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "ColladaDocument.h"
+#include "MappedFile.h"
+#include "ParallelFor.h"
+#include "TextHelpers.h"
+#include <string.h>
+#include <limits.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wsign-conversion"
+#include "rapidxml.hpp"
+#pragma clang diagnostic pop
+#else
+#include "rapidxml.hpp"
+#endif
+
+using namespace rapidxml;
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static const char *skipSpaces(const char *p, const char *end)
+{
+    while (p < end && isSpace(*p))
+        p++;
+    return p;
+}
+
+static const char *attributeValue(xml_node< > *node, const char *name)
+{
+    xml_attribute< > *attribute = node->first_attribute(name);
+    return attribute != NULL ? attribute->value() : "";
+}
+
+static uint attributeUInt(xml_node< > *node, const char *name, uint defaultValue)
+{
+    xml_attribute< > *attribute = node->first_attribute(name);
+    if (attribute == NULL)
+        return defaultValue;
+    
+    const char *p = attribute->value();
+    int value = 0;
+    if (!ParseInt(p, p + attribute->value_size(), value) || value < 0)
+        return defaultValue;
+    return (uint)value;
+}
+
+// url="#Geometry-Mesh_0" and source="#Geometry-Mesh_0-positions" refer to ids
+static const char *urlId(const char *url)
+{
+    return url[0] == '#' ? url + 1 : url;
+}
+
+// Ids of geometries hashed into buckets, lookups do not depend on how many
+// geometries the document has.
+class ColladaIdTable
+{
+private:
+    vector<const char *> _ids;
+    vector<uint> _next;
+    vector<uint> _buckets;
+    
+    static uint hash(const char *id)
+    {
+        // FNV-1a
+        uint value = 2166136261U;
+        for (; *id != '\0'; id++)
+            value = (value ^ (unsigned char)*id) * 16777619U;
+        return value;
+    }
+public:
+    ColladaIdTable(uint count)
+    {
+        uint bucketCount = 16;
+        while (bucketCount < count * 2)
+            bucketCount *= 2;
+        
+        _buckets.resize(bucketCount, UINT_MAX);
+        _ids.reserve(count);
+        _next.reserve(count);
+    }
+    
+    // ids are found in the order they were added
+    void add(const char *id)
+    {
+        uint &bucket = _buckets[hash(id) & (_buckets.size() - 1)];
+        uint index = _ids.size();
+        _ids.push_back(id);
+        _next.push_back(UINT_MAX);
+        
+        if (bucket == UINT_MAX)
+        {
+            bucket = index;
+            return;
+        }
+        
+        uint last = bucket;
+        while (_next[last] != UINT_MAX)
+            last = _next[last];
+        _next[last] = index;
+    }
+    
+    uint find(const char *id) const
+    {
+        for (uint i = _buckets[hash(id) & (_buckets.size() - 1)]; i != UINT_MAX; i = _next[i])
+        {
+            if (strcmp(_ids[i], id) == 0)
+                return i;
+        }
+        return UINT_MAX;
+    }
+};
+
+static xml_node< > *findSource(xml_node< > *mesh, const char *url)
+{
+    const char *id = urlId(url);
+    
+    for (xml_node< > *source = mesh->first_node("source"); source != NULL; source = source->next_sibling("source"))
+    {
+        if (strcmp(attributeValue(source, "id"), id) == 0)
+            return source;
+    }
+    return NULL;
+}
+
+static xml_node< > *findInput(xml_node< > *node, const char *semantic)
+{
+    for (xml_node< > *input = node->first_node("input"); input != NULL; input = input->next_sibling("input"))
+    {
+        if (strcmp(attributeValue(input, "semantic"), semantic) == 0)
+            return input;
+    }
+    return NULL;
+}
+
+// Appends vectors of float_array in source, only the first components of
+// every accessor stride are used.
+static bool readVectors(xml_node< > *source, uint components, vector<Vector3D> &vectors)
+{
+    xml_node< > *floatArray = source->first_node("float_array");
+    if (floatArray == NULL)
+        return false;
+    
+    uint stride = components;
+    xml_node< > *techniqueCommon = source->first_node("technique_common");
+    if (techniqueCommon != NULL && techniqueCommon->first_node("accessor") != NULL)
+        stride = attributeUInt(techniqueCommon->first_node("accessor"), "stride", components);
+    if (stride < components)
+        return false;
+    
+    vectors.reserve(vectors.size() + attributeUInt(floatArray, "count", 0) / stride);
+    
+    const char *p = floatArray->value();
+    const char *end = p + floatArray->value_size();
+    
+    Vector3D vector;
+    uint component = 0;
+    
+    while (true)
+    {
+        p = skipSpaces(p, end);
+        if (p >= end)
+            break;
+        
+        float value;
+        if (!ParseFloat(p, end, value))
+            return false;
+        
+        if (component < components)
+            vector[component] = value;
+        
+        if (++component == stride)
+        {
+            vectors.push_back(vector);
+            component = 0;
+        }
+    }
+    
+    return true;
+}
+
+// Reads p of triangles element, indices of inputs are interleaved.
+static bool readTriangles(xml_node< > *trianglesNode, xml_node< > *mesh, ColladaGeometry &geometry,
+                          vector<xml_node< > *> &texCoordSources, vector<uint> &texCoordStarts)
+{
+    xml_node< > *vertexInput = findInput(trianglesNode, "VERTEX");
+    if (vertexInput == NULL)
+        return false;
+    
+    uint stride = 0;
+    for (xml_node< > *input = trianglesNode->first_node("input"); input != NULL; input = input->next_sibling("input"))
+    {
+        uint offset = attributeUInt(input, "offset", 0);
+        if (offset + 1 > stride)
+            stride = offset + 1;
+    }
+    
+    uint vertexOffset = attributeUInt(vertexInput, "offset", 0);
+    uint texCoordOffset = UINT_MAX;
+    uint texCoordStart = UINT_MAX;
+    uint texCoordCount = 0;
+    
+    xml_node< > *texCoordInput = findInput(trianglesNode, "TEXCOORD");
+    if (texCoordInput != NULL)
+    {
+        xml_node< > *source = findSource(mesh, attributeValue(texCoordInput, "source"));
+        if (source == NULL)
+            return false;
+        
+        texCoordOffset = attributeUInt(texCoordInput, "offset", 0);
+        
+        // every source is read once even when more triangles use it
+        for (uint i = 0; i < texCoordSources.size(); i++)
+        {
+            if (texCoordSources[i] == source)
+            {
+                texCoordStart = texCoordStarts[i];
+                texCoordCount = (i + 1 < texCoordStarts.size() ? texCoordStarts[i + 1] : geometry.texCoords.size()) - texCoordStart;
+            }
+        }
+        
+        if (texCoordStart == UINT_MAX)
+        {
+            texCoordStart = geometry.texCoords.size();
+            texCoordSources.push_back(source);
+            texCoordStarts.push_back(texCoordStart);
+            
+            if (!readVectors(source, 2, geometry.texCoords))
+                return false;
+            
+            texCoordCount = geometry.texCoords.size() - texCoordStart;
+        }
+    }
+    
+    xml_node< > *indices = trianglesNode->first_node("p");
+    if (indices == NULL)
+        return true;
+    
+    geometry.triangles.reserve(geometry.triangles.size() + attributeUInt(trianglesNode, "count", 0));
+    
+    const char *p = indices->value();
+    const char *end = p + indices->value_size();
+    
+    uint vertexIndices[3];
+    uint texCoordIndices[3];
+    uint corner = 0;
+    uint offset = 0;
+    
+    while (true)
+    {
+        p = skipSpaces(p, end);
+        if (p >= end)
+            break;
+        
+        int index;
+        if (!ParseInt(p, end, index) || index < 0)
+            return false;
+        
+        if (offset == vertexOffset)
+            vertexIndices[corner] = (uint)index;
+        if (offset == texCoordOffset)
+        {
+            // indices of one source must not reach into another one
+            if ((uint)index >= texCoordCount)
+                return false;
+            texCoordIndices[corner] = texCoordStart + (uint)index;
+        }
+        
+        if (++offset < stride)
+            continue;
+        
+        offset = 0;
+        
+        // without TEXCOORD corners use the (0, 0) at the end, see readGeometry
+        if (texCoordOffset == UINT_MAX)
+            texCoordIndices[corner] = UINT_MAX;
+        
+        if (++corner < 3)
+            continue;
+        
+        corner = 0;
+        
+        // reversed order is the same as Mesh2::flipAllTriangles
+        TriQuad triQuad;
+        triQuad.isQuad = false;
+        for (uint i = 0; i < 3; i++)
+        {
+            triQuad.vertexIndices[i] = vertexIndices[2 - i];
+            triQuad.texCoordIndices[i] = texCoordIndices[2 - i];
+        }
+        triQuad.vertexIndices[3] = triQuad.vertexIndices[0];
+        triQuad.texCoordIndices[3] = triQuad.texCoordIndices[0];
+        geometry.triangles.push_back(triQuad);
+    }
+    
+    return true;
+}
+
+static bool readGeometry(xml_node< > *geometryNode, ColladaGeometry &geometry)
+{
+    // other geometries like splines stay empty
+    xml_node< > *mesh = geometryNode->first_node("mesh");
+    if (mesh == NULL)
+        return true;
+    
+    xml_node< > *verticesNode = mesh->first_node("vertices");
+    if (verticesNode == NULL)
+        return false;
+    
+    xml_node< > *positionInput = findInput(verticesNode, "POSITION");
+    if (positionInput == NULL)
+        return false;
+    
+    xml_node< > *positions = findSource(mesh, attributeValue(positionInput, "source"));
+    if (positions == NULL || !readVectors(positions, 3, geometry.vertices))
+        return false;
+    
+    vector<xml_node< > *> texCoordSources;
+    vector<uint> texCoordStarts;
+    
+    for (xml_node< > *trianglesNode = mesh->first_node("triangles"); trianglesNode != NULL; trianglesNode = trianglesNode->next_sibling("triangles"))
+    {
+        if (!readTriangles(trianglesNode, mesh, geometry, texCoordSources, texCoordStarts))
+            return false;
+    }
+    
+    // corners without TEXCOORD input share one (0, 0) at the end
+    uint vertexCount = geometry.vertices.size();
+    uint missingTexCoord = geometry.texCoords.size();
+    bool hasMissingTexCoords = false;
+    
+    for (uint i = 0; i < geometry.triangles.size(); i++)
+    {
+        TriQuad &triQuad = geometry.triangles[i];
+        
+        for (uint j = 0; j < 4; j++)
+        {
+            if (triQuad.vertexIndices[j] >= vertexCount)
+                return false;
+            
+            if (triQuad.texCoordIndices[j] == UINT_MAX)
+            {
+                triQuad.texCoordIndices[j] = missingTexCoord;
+                hasMissingTexCoords = true;
+            }
+            else if (triQuad.texCoordIndices[j] >= missingTexCoord)
+            {
+                return false;
+            }
+        }
+    }
+    
+    if (hasMissingTexCoords)
+        geometry.texCoords.push_back(Vector3D());
+    
+    return true;
+}
+
+struct ReadGeometriesBody
+{
+    const vector<xml_node< > *> &nodes;
+    const vector<bool> &instanced;
+    vector<ColladaGeometry> &geometries;
+    
+    ReadGeometriesBody(const vector<xml_node< > *> &nodes, const vector<bool> &instanced,
+                       vector<ColladaGeometry> &geometries)
+        : nodes(nodes), instanced(instanced), geometries(geometries) { }
+    
+    void operator()(uint first, uint last)
+    {
+        for (uint i = first; i < last; i++)
+        {
+            if (instanced[i])
+                geometries[i].valid = readGeometry(nodes[i], geometries[i]);
+        }
+    }
+};
+
+bool ColladaDocument::readFile(const char *fileName)
+{
+    MappedFile file(fileName);
+    if (!file.isOpen())
+        return false;
+    
+    // rapidxml writes zero terminators into the text
+    vector<char> text(file.length() + 1, '\0');
+    copy(file.data(), file.data() + file.length(), text.begin());
+    
+    return read(&text[0]);
+}
+
+bool ColladaDocument::read(char *text)
+{
+    geometries.clear();
+    instances.clear();
+    
+    xml_document< > document;
+    
+    try
+    {
+        document.parse<0>(text);
+    }
+    catch (parse_error &)
+    {
+        return false;
+    }
+    
+    xml_node< > *collada = document.first_node("COLLADA");
+    if (collada == NULL)
+        return false;
+    
+    vector<xml_node< > *> geometryNodes;
+    
+    xml_node< > *libraryGeometries = collada->first_node("library_geometries");
+    if (libraryGeometries != NULL)
+    {
+        for (xml_node< > *geometry = libraryGeometries->first_node("geometry"); geometry != NULL; geometry = geometry->next_sibling("geometry"))
+            geometryNodes.push_back(geometry);
+    }
+    
+    ColladaIdTable geometryIds(geometryNodes.size());
+    for (uint i = 0; i < geometryNodes.size(); i++)
+        geometryIds.add(attributeValue(geometryNodes[i], "id"));
+    
+    vector<bool> instanced(geometryNodes.size(), false);
+    
+    xml_node< > *libraryVisualScenes = collada->first_node("library_visual_scenes");
+    xml_node< > *visualScene = libraryVisualScenes != NULL ? libraryVisualScenes->first_node("visual_scene") : NULL;
+    
+    if (visualScene != NULL)
+    {
+        for (xml_node< > *node = visualScene->first_node("node"); node != NULL; node = node->next_sibling("node"))
+        {
+            xml_node< > *instanceGeometry = node->first_node("instance_geometry");
+            if (instanceGeometry == NULL)
+                continue;
+            
+            ColladaInstance instance;
+            instance.geometryIndex = geometryIds.find(urlId(attributeValue(instanceGeometry, "url")));
+            
+            if (instance.geometryIndex != UINT_MAX)
+                instanced[instance.geometryIndex] = true;
+            
+            xml_node< > *translate = node->first_node("translate");
+            if (translate != NULL)
+            {
+                const char *p = translate->value();
+                const char *end = p + translate->value_size();
+                
+                for (uint i = 0; i < 3; i++)
+                {
+                    p = skipSpaces(p, end);
+                    if (!ParseFloat(p, end, instance.position[i]))
+                        break;
+                }
+            }
+            
+            instances.push_back(instance);
+        }
+    }
+    
+    // valid is kept by each geometry, vector<bool> packs flags of
+    // neighbouring geometries into one word written from several threads
+    geometries.resize(geometryNodes.size());
+    
+    ReadGeometriesBody readGeometries(geometryNodes, instanced, geometries);
+    ParallelFor(geometryNodes.size(), 1, readGeometries);
+    
+    for (uint i = 0; i < geometries.size(); i++)
+    {
+        if (!geometries[i].valid)
+            return false;
+    }
+    
+    return true;
+}
+
+struct MakeMeshesBody
+{
+    const vector<ColladaGeometry> &geometries;
+    const vector<Mesh2 *> &meshes;
+    
+    MakeMeshesBody(const vector<ColladaGeometry> &geometries, const vector<Mesh2 *> &meshes)
+        : geometries(geometries), meshes(meshes) { }
+    
+    void operator()(uint first, uint last)
+    {
+        for (uint i = first; i < last; i++)
+        {
+            const ColladaGeometry &geometry = geometries[i];
+            if (meshes[i] != NULL)
+                meshes[i]->fromIndexRepresentation(geometry.vertices, geometry.texCoords, geometry.triangles);
+        }
+    }
+};
+
+ItemCollection *ColladaDocument::makeItems() const
+{
+    // meshes are created here, their random colors are not thread safe
+    vector<Mesh2 *> meshes(geometries.size(), NULL);
+    for (uint i = 0; i < instances.size(); i++)
+    {
+        uint geometryIndex = instances[i].geometryIndex;
+        if (geometryIndex != UINT_MAX && meshes[geometryIndex] == NULL)
+            meshes[geometryIndex] = new Mesh2();
+    }
+    
+    MakeMeshesBody makeMeshes(geometries, meshes);
+    ParallelFor(geometries.size(), 1, makeMeshes);
+    
+    ItemCollection *items = new ItemCollection();
+    
+    for (uint i = 0; i < instances.size(); i++)
+    {
+        uint geometryIndex = instances[i].geometryIndex;
+        
+        Item *item = new Item(geometryIndex != UINT_MAX ? meshes[geometryIndex] : new Mesh2());
+        item->position = instances[i].position;
+        items->addItem(item);
+    }
+    
+    return items;
+}
+
+static const char *colladaHeader =
+    "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n"
+    "<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\">\n"
+    "<asset>\n"
+    "<contributor>\n"
+    "<authoring_tool>MeshMaker ";
+
+static const char *colladaLibraries =
+    "</authoring_tool>\n"
+    "</contributor>\n"
+    "<created>2011-01-23T15:41:29Z</created>\n"     // TODO: fill real date-time
+    "<modified>2011-01-23T15:41:29Z</modified>\n"   // TODO: fill real date-time
+    "<up_axis>Y_UP</up_axis>\n"
+    "</asset>\n"
+    "<library_cameras>\n"
+    "<camera id=\"Camera-Camera\" name=\"Camera\">\n"
+    "<optics>\n"
+    "<technique_common>\n"
+    "<perspective>\n"
+    "<xfov sid=\"HFOV\">39.5978</xfov>\n"           // TODO: fill real HFOV
+    "<yfov sid=\"YFOV\">26.9915</yfov>\n"           // TODO: fill real YFOV
+    "<znear sid=\"near_clip\">0.01</znear>\n"       // TODO: fill real near_clip
+    "<zfar sid=\"far_clip\">10000</zfar>\n"         // TODO: fill real far_clip
+    "</perspective>\n"
+    "</technique_common>\n"
+    "</optics>\n"
+    "</camera>\n"
+    "</library_cameras>\n"
+    "<library_materials>\n"
+    "<material id=\"Material-Default\" name=\"Default\">\n"
+    "<instance_effect url=\"#Effect-Default\" />\n"
+    "</material>\n"
+    "</library_materials>\n"
+    "<library_effects>\n"
+    "<effect id=\"Effect-Default\" name=\"Default\">\n"
+    "<profile_COMMON>\n"
+    "<technique sid=\"common\">\n"
+    "<phong>\n"
+    "<diffuse>\n"
+    "<color sid=\"diffuse_effect_rgb\">0.8 0.8 0.8 1</color>\n"
+    "</diffuse>\n"
+    "<specular>\n"
+    "<color sid=\"specular_effect_rgb\">0.2 0.2 0.2 1</color>\n"
+    "</specular>\n"
+    "</phong>\n"
+    "</technique>\n"
+    "</profile_COMMON>\n"
+    "</effect>\n"
+    "</library_effects>\n"
+    "<library_geometries>\n";
+
+static const char *colladaLights =
+    "</library_geometries>\n"
+    "<library_lights>\n"
+    "<light id=\"Light-Render\" name=\"Render\">\n"
+    "<technique_common>\n"
+    "<ambient>\n"
+    "<color sid=\"ambient_light_rgb\">0.05 0.05 0.05</color>\n"
+    "</ambient>\n"
+    "</technique_common>\n"
+    "</light>\n"
+    "<light id=\"Light-Directional_Light\" name=\"Directional_Light\">\n"
+    "<technique_common>\n"
+    "<directional>\n"
+    "<color sid=\"directional_light_rgb\">1 1 1</color>\n"
+    "</directional>\n"
+    "</technique_common>\n"
+    "</light>\n"
+    "</library_lights>\n"
+    "<library_visual_scenes>\n"
+    "<visual_scene id=\"DefaultScene\">\n"
+    "<node id=\"RenderNode\" name=\"Render\" type=\"NODE\">\n"
+    "<instance_light url=\"#Light-Render\" />\n"
+    "</node>\n";
+
+static const char *colladaFooter =
+    "<node id=\"Camera-CameraNode\" name=\"Camera\" type=\"NODE\">\n"
+    "<translate sid=\"Position\">0 0.75 10</translate>\n"
+    "<rotate sid=\"RotationY\">0 1 0 0</rotate>\n"
+    "<rotate sid=\"RotationX\">1 0 0 -5</rotate>\n"
+    "<rotate sid=\"RotationZ\">0 0 1 0</rotate>\n"
+    "<instance_camera url=\"#Camera-Camera\" />\n"
+    "</node>\n"
+    "<node id=\"Light-Directional_LightNode\" name=\"Directional_Light\" type=\"NODE\">\n"
+    "<translate sid=\"Position__2_\">-2 2 2</translate>\n"
+    "<rotate sid=\"Rotation__2_Y\">0 1 0 -45</rotate>\n"
+    "<rotate sid=\"Rotation__2_X\">1 0 0 -30</rotate>\n"
+    "<rotate sid=\"Rotation__2_Z\">0 0 1 0</rotate>\n"
+    "<instance_light url=\"#Light-Directional_Light\" />\n"
+    "</node>\n"
+    "</visual_scene>\n"
+    "</library_visual_scenes>\n"
+    "<scene>\n"
+    "<instance_visual_scene url=\"#DefaultScene\" />\n"
+    "</scene>\n"
+    "</COLLADA>\n";
+
+// <source> with float_array and its accessor, like Geometry-Mesh_0-positions
+static void appendSource(string &text, const string &geometryId, const char *name, const char *params,
+                         const vector<Vector3D> &vectors, uint components)
+{
+    string sourceId = geometryId + "-" + name;
+    
+    text += "<source id=\"" + sourceId + "\" name=\"" + name + "\">\n";
+    text += "<float_array id=\"" + sourceId + "-array\" count=\"";
+    AppendUInt(text, vectors.size() * components);
+    text += "\">\n";
+    
+    for (uint i = 0; i < vectors.size(); i++)
+    {
+        for (uint j = 0; j < components; j++)
+        {
+            if (j > 0)
+                text += ' ';
+            AppendFloat(text, vectors[i][j]);
+        }
+        text += '\n';
+    }
+    
+    text += "</float_array>\n";
+    text += "<technique_common>\n";
+    text += "<accessor count=\"";
+    AppendUInt(text, vectors.size());
+    text += "\" source=\"#" + sourceId + "-array\" stride=\"";
+    AppendUInt(text, components);
+    text += "\">\n";
+    
+    for (uint j = 0; j < components; j++)
+    {
+        text += "<param name=\"";
+        text += params[j];
+        text += "\" type=\"float\" />\n";
+    }
+    
+    text += "</accessor>\n";
+    text += "</technique_common>\n";
+    text += "</source>\n";
+}
+
+// Index representation of one item formatted into its geometry element.
+struct ColladaItemGeometry
+{
+    uint itemIndex;
+    Matrix4x4 transform;
+    vector<Vector3D> vertices;
+    vector<Vector3D> texCoords;
+    vector<TriQuad> triangles;
+    
+    vector<Vector3D> normals;
+    vector<uint> corners;
+    string text;
+    
+    void format();
+};
+
+void ColladaItemGeometry::format()
+{
+    if (!vertices.empty())
+        transform.TransformPositions(&vertices[0], vertices.size());
+    
+    // quads split like Mesh2::triangulate, each triangle reversed like
+    // Mesh2::flipAllTriangles, indices of corners are in output order
+    corners.clear();
+    
+    for (uint i = 0; i < triangles.size(); i++)
+    {
+        const TriQuad &triQuad = triangles[i];
+        uint count = triQuad.isQuad ? 6 : 3;
+        
+        for (uint j = 0; j < count; j += 3)
+        {
+            for (int k = 2; k >= 0; k--)
+            {
+                uint corner = Triangle2::twoTriIndices[j + k];
+                corners.push_back(triQuad.vertexIndices[corner]);
+                corners.push_back(triQuad.texCoordIndices[corner]);
+            }
+        }
+    }
+    
+    // the same normals Mesh2 computes for smooth shading, only unit length
+    normals.assign(vertices.size(), Vector3D());
+    
+    for (uint i = 0; i < corners.size(); i += 6)
+    {
+        const Vector3D &v0 = vertices[corners[i]];
+        const Vector3D &v1 = vertices[corners[i + 2]];
+        const Vector3D &v2 = vertices[corners[i + 4]];
+        
+        Vector3D normal = (v0 - v1).Cross(v1 - v2);
+        
+        for (uint j = 0; j < 6; j += 2)
+            normals[corners[i + j]] += normal;
+    }
+    
+    for (uint i = 0; i < normals.size(); i++)
+    {
+        if (normals[i].GetLengthSq() > 0.0f)
+            normals[i].Normalize();
+    }
+    
+    string geometryId = "Geometry-Mesh_";
+    AppendUInt(geometryId, itemIndex);
+    
+    text.clear();
+    text.reserve(vertices.size() * 64 + texCoords.size() * 24 + corners.size() * 12 + 2048);
+    
+    text += "<geometry id=\"" + geometryId + "\" name=\"Mesh_";
+    AppendUInt(text, itemIndex);
+    text += "\">\n";
+    text += "<mesh>\n";
+    
+    appendSource(text, geometryId, "positions", "XYZ", vertices, 3);
+    appendSource(text, geometryId, "normals", "XYZ", normals, 3);
+    appendSource(text, geometryId, "Texture", "ST", texCoords, 2);
+    
+    text += "<vertices id=\"" + geometryId + "-vertices\">\n";
+    text += "<input semantic=\"POSITION\" source=\"#" + geometryId + "-positions\" />\n";
+    text += "</vertices>\n";
+    
+    text += "<triangles count=\"";
+    AppendUInt(text, corners.size() / 6);
+    text += "\" material=\"Material-Default\">\n";
+    text += "<input semantic=\"VERTEX\" source=\"#" + geometryId + "-vertices\" offset=\"0\" />\n";
+    text += "<input semantic=\"NORMAL\" source=\"#" + geometryId + "-normals\" offset=\"1\" />\n";
+    text += "<input semantic=\"TEXCOORD\" source=\"#" + geometryId + "-Texture\" offset=\"2\" set=\"0\" />\n";
+    
+    // normals are per vertex, so they have the vertex index
+    text += "<p>";
+    for (uint i = 0; i < corners.size(); i += 2)
+    {
+        AppendUInt(text, corners[i]);
+        text += ' ';
+        AppendUInt(text, corners[i]);
+        text += ' ';
+        AppendUInt(text, corners[i + 1]);
+        text += ' ';
+    }
+    text += "</p>\n";
+    
+    text += "</triangles>\n";
+    text += "</mesh>\n";
+    text += "</geometry>\n";
+}
+
+struct FormatGeometriesBody
+{
+    vector<ColladaItemGeometry> &geometries;
+    FormatGeometriesBody(vector<ColladaItemGeometry> &geometries) : geometries(geometries) { }
+    void operator()(uint first, uint last)
+    {
+        for (uint i = first; i < last; i++)
+            geometries[i].format();
+    }
+};
+
+static void writeItems(ItemCollection &items, const char *version, TextOutput &output)
+{
+    output.append(colladaHeader);
+    output.append(version);
+    output.append(colladaLibraries);
+    
+    // buffers of every worker thread are kept from batch to batch
+    vector<ColladaItemGeometry> batch(ParallelForThreadCount());
+    
+    for (uint first = 0; first < items.count() && output.isValid(); first += batch.size())
+    {
+        uint count = min((uint)batch.size(), items.count() - first);
+        
+        for (uint i = 0; i < count; i++)
+        {
+            Item *item = items.itemAtIndex(first + i);
+            ColladaItemGeometry &geometry = batch[i];
+            
+            geometry.itemIndex = first + i;
+            geometry.transform = item->transform();
+            geometry.vertices.clear();
+            geometry.texCoords.clear();
+            geometry.triangles.clear();
+            
+            // algorithm data of shared meshes are written here, not on workers
+            item->mesh->toIndexRepresentation(geometry.vertices, geometry.texCoords, geometry.triangles);
+        }
+        
+        FormatGeometriesBody formatGeometries(batch);
+        ParallelFor(count, 1, formatGeometries);
+        
+        for (uint i = 0; i < count; i++)
+            output.append(batch[i].text);
+    }
+    
+    output.append(colladaLights);
+    
+    string node;
+    
+    for (uint i = 0; i < items.count(); i++)
+    {
+        // positions of geometries are transformed, so nodes stay at origin
+        node = "<node id=\"Geometry-MeshNode_";
+        AppendUInt(node, i);
+        node += "\" name=\"Mesh_";
+        AppendUInt(node, i);
+        node += "\" type=\"NODE\">\n";
+        node += "<translate sid=\"Position_";
+        AppendUInt(node, i);
+        node += "\">0 0 0</translate>\n";
+        node += "<instance_geometry url=\"#Geometry-Mesh_";
+        AppendUInt(node, i);
+        node += "\">\n";
+        node += "<bind_material>\n";
+        node += "<technique_common>\n";
+        node += "<instance_material symbol=\"Material-Default\" target=\"#Material-Default\" />\n";
+        node += "</technique_common>\n";
+        node += "</bind_material>\n";
+        node += "</instance_geometry>\n";
+        node += "</node>\n";
+        output.append(node);
+    }
+    
+    output.append(colladaFooter);
+}
+
+void ColladaDocument::write(ItemCollection &items, const char *version, string &text)
+{
+    TextOutput output(text);
+    writeItems(items, version, output);
+}
+
+bool ColladaDocument::writeFile(ItemCollection &items, const char *version, const char *fileName)
+{
+    TextOutput output(fileName);
+    writeItems(items, version, output);
+    return output.close();
+}
@@ -0,0 +1,65 @@
+//
+//  ColladaDocument.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "MathDeclaration.h"
+#include "MeshForwardDeclaration.h"
+#include "ItemCollection.h"
+#include <string>
+
+// One geometry of library_geometries in the index representation of Mesh2,
+// already in MeshMaker winding. Corners without TEXCOORD input use the last
+// texture coordinate, which is then (0, 0). Geometries without instance
+// are not read and stay valid.
+struct ColladaGeometry
+{
+    vector<Vector3D> vertices;
+    vector<Vector3D> texCoords;
+    vector<TriQuad> triangles;
+    bool valid;
+    
+    ColladaGeometry() : valid(true) { }
+};
+
+// node of the visual scene, geometryIndex is UINT_MAX for unknown url
+struct ColladaInstance
+{
+    uint geometryIndex;
+    Vector3D position;
+};
+
+// Geometries and their instances in a Collada document. Text is parsed in
+// place by rapidxml, numbers are read straight from it without copies.
+// Instances find their geometry by id in a hash table and every instanced
+// geometry is read on a ParallelFor worker thread.
+class ColladaDocument
+{
+public:
+    vector<ColladaGeometry> geometries;
+    vector<ColladaInstance> instances;
+    
+    // reads the whole file into memory, fileName is in UTF-8
+    bool readFile(const char *fileName);
+    // text is changed by the parser and must end with zero, returns false
+    // for malformed XML and indices out of range
+    bool read(char *text);
+    
+    // instances of the same geometry share its mesh, meshes are filled on
+    // ParallelFor worker threads
+    ItemCollection *makeItems() const;
+    
+    // Items as Collada document, each of them in its own geometry with
+    // positions already transformed. Geometries of as many items as there
+    // are ParallelFor worker threads are formatted at once and appended in
+    // order, quads are split into triangles and vertex normals are averaged
+    // from triangles while formatting.
+    static void write(ItemCollection &items, const char *version, string &text);
+    // streams text to the file, fileName is in UTF-8
+    static bool writeFile(ItemCollection &items, const char *version, const char *fileName);
+};
@@ -0,0 +1,224 @@
+//
+//  ColoredVertexBuffer.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "ColoredVertexBuffer.h"
+#include "RenderStatistics.h"
+#include <algorithm>
+
+uint MergeDirtyRanges(vector<uint> &indices, vector<uint> &ranges)
+{
+    sort(indices.begin(), indices.end());
+    indices.erase(unique(indices.begin(), indices.end()), indices.end());
+    
+    const uint maximumGap = 32;
+    ranges.clear();
+    
+    for (uint i = 0; i < indices.size(); i++)
+    {
+        if (!ranges.empty() && indices[i] <= ranges.back() + maximumGap)
+        {
+            ranges.back() = indices[i] + 1;
+        }
+        else
+        {
+            ranges.push_back(indices[i]);
+            ranges.push_back(indices[i] + 1);
+        }
+    }
+    
+    uint dirtyCount = 0;
+    for (uint i = 0; i < ranges.size(); i += 2)
+        dirtyCount += ranges[i + 1] - ranges[i];
+    
+    return dirtyCount;
+}
+
+ColoredVertexBuffer::ColoredVertexBuffer()
+{
+    _vboID = 0U;
+    _vboGenerated = false;
+    _positionsUploaded = false;
+    _colorsUploaded = false;
+}
+
+ColoredVertexBuffer::~ColoredVertexBuffer()
+{
+#if defined(__APPLE__) || defined(SHADERS)
+    if (_vboGenerated)
+        glDeleteBuffers(1, &_vboID);
+#endif
+}
+
+void ColoredVertexBuffer::invalidate()
+{
+    _positions.setValid(false);
+    _colors.setValid(false);
+    _colorIndices.clear();
+    _dirtyPositions.clear();
+}
+
+void ColoredVertexBuffer::invalidateColors()
+{
+    _colors.setValid(false);
+}
+
+void ColoredVertexBuffer::resize(uint count)
+{
+    _positions.resize(count);
+    _colors.setValid(false);
+    _dirtyPositions.clear();
+    _positionsUploaded = false;
+}
+
+void ColoredVertexBuffer::resizeColors()
+{
+    _colors.resize(_positions.count());
+    _colorsUploaded = false;
+}
+
+void ColoredVertexBuffer::setValid()
+{
+    _positions.setValid(true);
+}
+
+void ColoredVertexBuffer::setColorsValid()
+{
+    _colors.setValid(true);
+}
+
+void ColoredVertexBuffer::updatePosition(uint index, const Vector3D &position)
+{
+    if (!_positions.isValid() || index >= _positions.count())
+        return;
+    
+    Point3D &point = _positions[index];
+    
+    for (uint k = 0; k < 3; k++)
+    {
+        point.coords[k] = position[k];
+    }
+    
+    if (_positionsUploaded)
+        _dirtyPositions.push_back(index);
+}
+
+size_t ColoredVertexBuffer::colorIndicesOffset() const
+{
+    return _positions.count() * (sizeof(Point3D) + sizeof(PackedColor));
+}
+
+void ColoredVertexBuffer::upload()
+{
+#if defined(__APPLE__) || defined(SHADERS)
+    RENDER_STATISTICS_SCOPE(RenderPhase::Upload);
+    
+    uint count = _positions.count();
+    
+    if (!_vboGenerated)
+    {
+        glGenBuffers(1, &_vboID);
+        _vboGenerated = true;
+    }
+    
+    glBindBuffer(GL_ARRAY_BUFFER, _vboID);
+    
+    if (!_positionsUploaded)
+    {
+        // colors live behind positions, so new storage needs both again,
+        // color indices change only with positions and go last
+        glBufferData(GL_ARRAY_BUFFER, count * (sizeof(Point3D) + sizeof(PackedColor) + sizeof(uint)), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Point3D), _positions);
+        if (_colorIndices.size() == count)
+            glBufferSubData(GL_ARRAY_BUFFER, colorIndicesOffset(), count * sizeof(uint), &_colorIndices[0]);
+        _positionsUploaded = true;
+        _colorsUploaded = false;
+    }
+    else if (!_dirtyPositions.empty())
+    {
+        vector<uint> ranges;
+        MergeDirtyRanges(_dirtyPositions, ranges);
+        
+        Point3D *positions = _positions;
+        
+        for (uint i = 0; i < ranges.size(); i += 2)
+        {
+            uint first = ranges[i];
+            uint rangeCount = ranges[i + 1] - first;
+            glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(Point3D), rangeCount * sizeof(Point3D), positions + first);
+        }
+    }
+    
+    _dirtyPositions.clear();
+    
+    if (!_colorsUploaded && _colors.isValid())
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, count * sizeof(Point3D), count * sizeof(PackedColor), _colors);
+        _colorsUploaded = true;
+    }
+#endif
+}
+
+void ColoredVertexBuffer::draw(GLenum mode)
+{
+    RENDER_STATISTICS_SCOPE(RenderPhase::Draw);
+    
+    uint count = _positions.count();
+    if (count == 0)
+        return;
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+#if defined(__APPLE__) || defined(SHADERS)
+    upload();
+    glColorPointer(3, GL_UNSIGNED_BYTE, sizeof(PackedColor), (void *)(count * sizeof(Point3D)));
+    glVertexPointer(3, GL_FLOAT, sizeof(Point3D), NULL);
+#else
+    glColorPointer(3, GL_UNSIGNED_BYTE, sizeof(PackedColor), (PackedColor *)_colors);
+    glVertexPointer(3, GL_FLOAT, sizeof(Point3D), (Point3D *)_positions);
+#endif
+    
+    glDrawArrays(mode, 0, (int)count);
+
+#if defined(__APPLE__) || defined(SHADERS)
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+    
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void ColoredVertexBuffer::drawForSelection(GLenum mode)
+{
+    RENDER_STATISTICS_SCOPE(RenderPhase::Draw);
+    
+    uint count = _positions.count();
+    if (count == 0 || _colorIndices.size() != count)
+        return;
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+#if defined(__APPLE__) || defined(SHADERS)
+    upload();
+    ColorIndexPointer((void *)colorIndicesOffset());
+    glVertexPointer(3, GL_FLOAT, sizeof(Point3D), NULL);
+#else
+    ColorIndexPointer(&_colorIndices[0]);
+    glVertexPointer(3, GL_FLOAT, sizeof(Point3D), (Point3D *)_positions);
+#endif
+    
+    glDrawArrays(mode, 0, (int)count);
+
+#if defined(__APPLE__) || defined(SHADERS)
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+    
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
@@ -0,0 +1,77 @@
+//
+//  ColoredVertexBuffer.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "OpenGLDrawing.h"
+#include "FPArrayCache.h"
+
+struct Point3D
+{
+    float coords[3];
+};
+
+struct PackedColor
+{
+    unsigned char coords[4]; // last one is padding
+};
+
+// Sorts indices of changed vertices and merges them into [first, last) pairs,
+// small gaps are cheaper to upload than another call. Returns the number of
+// vertices covered by ranges.
+uint MergeDirtyRanges(vector<uint> &indices, vector<uint> &ranges);
+
+// Positions and colors of lines, points or triangles in one vertex buffer, all
+// positions first, colors and selection color indices after them. Moved
+// vertices upload just their positions and selection changes upload just the
+// colors. Without shaders it draws from client memory.
+class ColoredVertexBuffer
+{
+private:
+    FPArrayCache<Point3D> _positions;
+    FPArrayCache<PackedColor> _colors;
+    vector<uint> _colorIndices;
+    vector<uint> _dirtyPositions;
+    
+    uint _vboID;
+    bool _vboGenerated;
+    bool _positionsUploaded;
+    bool _colorsUploaded;
+    
+    size_t colorIndicesOffset() const;
+    void upload();
+    
+    ColoredVertexBuffer(const ColoredVertexBuffer &);
+    ColoredVertexBuffer &operator=(const ColoredVertexBuffer &);
+public:
+    ColoredVertexBuffer();
+    ~ColoredVertexBuffer();
+    
+    uint count() const { return _positions.count(); }
+    bool isValid() const { return _positions.isValid(); }
+    bool areColorsValid() const { return _colors.isValid(); }
+    
+    void invalidate();
+    void invalidateColors();
+    
+    // Callers fill positions and colorIndices, then resize to the real count
+    // and call setValid. Colors are filled separately after resizeColors.
+    void resize(uint count);
+    void resizeColors();
+    Point3D *positions() { return _positions; }
+    PackedColor *colors() { return _colors; }
+    vector<uint> &colorIndices() { return _colorIndices; }
+    void setValid();
+    void setColorsValid();
+    
+    void updatePosition(uint index, const Vector3D &position);
+    
+    void draw(GLenum mode);
+    // colors come from colorIndices, see ColorIndexPointer
+    void drawForSelection(GLenum mode);
+};
@@ -116,8 +116,10 @@ EnumClass ModelVersion : uint
     TriQuads = 3U,
     CrossPlatform = 4U,
     TextureNames = 5U,
+    SharedMeshes = 6U,
+    BulkArrays = 7U,
 
-    Latest = TextureNames
+    Latest = BulkArrays
 };
 
 EnumClass VertexWindowMode
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "FPPool.h"
+
 template <class TNode, class TData>
 class FPList
 {
@@ -15,62 +17,88 @@ private:
     TNode *_begin;
     TNode *_end;
     uint _count;
-public:
-    FPList()
+    FPPool<TNode> *_pool;
+    
+    TNode *createNode()
+    {
+        if (_pool)
+            return _pool->create();
+        return new TNode();
+    }
+    
+    void destroyNode(TNode *node)
+    {
+        if (_pool)
+            _pool->destroy(node);
+        else
+            delete node;
+    }
+    
+    // Sentinels are created on first add, so empty adjacency lists
+    // inside of vertices do not allocate anything.
+    void createSentinels()
     {
-        _begin = new TNode();
-        _end = new TNode();
+        _begin = createNode();
+        _end = createNode();
         
         _begin->_next = _end;
         _end->_previous = _begin;
-        _count = 0U;
     }
     
-    virtual ~FPList()
+    void destroySentinels()
     {
         if (_begin && _end)
         {
             removeAll();
-            delete _begin;
+            destroyNode(_begin);
             _begin = NULL;
-            delete _end;
-            _end = NULL;        
+            destroyNode(_end);
+            _end = NULL;
         }
     }
+public:
+    FPList(FPPool<TNode> *pool = NULL)
+    {
+        _begin = NULL;
+        _end = NULL;
+        _count = 0U;
+        _pool = pool;
+    }
+    
+    virtual ~FPList()
+    {
+        destroySentinels();
+    }
+    
+    FPPool<TNode> *pool() const { return _pool; }
     
     void moveFrom(FPList &other)
     {
-        if (_begin && _end)
-        {
-            removeAll();
-            delete _begin;
-            _begin = NULL;
-            delete _end;
-            _end = NULL;        
-        }
+        destroySentinels();
         
         _begin = other._begin;
         _end = other._end;
         _count = other._count;
+        _pool = other._pool;
         
         other._begin = NULL;
         other._end = NULL;
         other._count = 0U;
     }
     
-    TNode *begin() const { return _begin->_next; }
+    TNode *begin() const { return _begin ? _begin->_next : NULL; }
     TNode *end() const { return _end; } 
     
     TNode *first() const
     {
-        if (_begin->_next != _end)
+        if (_begin && _begin->_next != _end)
             return _begin->_next;
         return NULL;
     }
     
     TNode *last() const
     {
-        if (_end->_previous != _begin)
+        if (_end && _end->_previous != _begin)
             return _end->_previous;
         return NULL;
     }
@@ -88,7 +116,7 @@ public:
         next->_previous = previous;
         previous->_next = next;
         
-        delete node;
+        destroyNode(node);
         
         node = previous;
         
@@ -97,12 +125,15 @@ public:
     
     void removeAll()
     {
+        if (!_begin || !_end)
+            return;
+        
         TNode *current = _begin->_next;
         
         while (current != _end)
         {
             current = current->_next;
-            delete current->_previous;
+            destroyNode(current->_previous);
         }
         
         _begin->_next = _end;
@@ -111,9 +142,21 @@ public:
         _count = 0U;
     }
     
+    // Forgets all nodes including sentinels without destroying them,
+    // their pool has to be released in bulk right after this call.
+    void abandonAll()
+    {
+        _begin = NULL;
+        _end = NULL;
+        _count = 0U;
+    }
+    
     TNode *add(const TData &data)
     {
-        TNode *newEnd = new TNode();
+        if (!_end)
+            createSentinels();
+        
+        TNode *newEnd = createNode();
         TNode *oldEnd = _end;
         oldEnd->setData(data);
         oldEnd->_next = newEnd;
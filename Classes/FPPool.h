@@ -0,0 +1,141 @@
+//
+//  FPPool.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include <new>
+#include <vector>
+using namespace std;
+
+struct FPPoolStatistics
+{
+    uint nodeCount;
+    uint slabCount;
+    uint nodeAllocations;
+    uint heapAllocations;
+
+    FPPoolStatistics() : nodeCount(0U), slabCount(0U), nodeAllocations(0U), heapAllocations(0U) { }
+
+    void add(const FPPoolStatistics &other)
+    {
+        nodeCount += other.nodeCount;
+        slabCount += other.slabCount;
+        nodeAllocations += other.nodeAllocations;
+        heapAllocations += other.heapAllocations;
+    }
+};
+
+// Slab allocator for list nodes. Freed nodes are kept in a free list,
+// releaseAll() returns every slab to the heap without running destructors.
+template <class TNode>
+class FPPool
+{
+private:
+    struct FreeNode
+    {
+        FreeNode *next;
+    };
+
+    static const uint _firstSlabCapacity = 32U;
+    static const uint _maxSlabCapacity = 4096U;
+
+    vector<unsigned char *> _slabs;
+    uint _slabCapacity;
+    uint _slabUsed;
+    FreeNode *_freeNodes;
+
+    uint _nodeCount;
+    uint _nodeAllocations;
+    uint _heapAllocations;
+
+    FPPool(const FPPool &);
+    FPPool &operator=(const FPPool &);
+public:
+    FPPool()
+    {
+        _slabCapacity = 0U;
+        _slabUsed = 0U;
+        _freeNodes = NULL;
+        _nodeCount = 0U;
+        _nodeAllocations = 0U;
+        _heapAllocations = 0U;
+    }
+
+    virtual ~FPPool()
+    {
+        releaseAll();
+    }
+
+    void *allocate()
+    {
+        _nodeCount++;
+        _nodeAllocations++;
+
+        if (_freeNodes)
+        {
+            FreeNode *node = _freeNodes;
+            _freeNodes = node->next;
+            return node;
+        }
+
+        if (_slabs.empty() || _slabUsed == _slabCapacity)
+        {
+            if (_slabs.empty())
+                _slabCapacity = _firstSlabCapacity;
+            else if (_slabCapacity < _maxSlabCapacity)
+                _slabCapacity *= 2U;
+
+            _slabs.push_back(static_cast<unsigned char *>(::operator new(_slabCapacity * sizeof(TNode))));
+            _slabUsed = 0U;
+            _heapAllocations++;
+        }
+
+        return _slabs.back() + sizeof(TNode) * _slabUsed++;
+    }
+
+    void deallocate(void *memory)
+    {
+        FreeNode *node = static_cast<FreeNode *>(memory);
+        node->next = _freeNodes;
+        _freeNodes = node;
+        _nodeCount--;
+    }
+
+    virtual TNode *create()
+    {
+        return new (allocate()) TNode();
+    }
+
+    void destroy(TNode *node)
+    {
+        node->~TNode();
+        deallocate(node);
+    }
+
+    virtual void releaseAll()
+    {
+        for (uint i = 0; i < _slabs.size(); i++)
+            ::operator delete(_slabs[i]);
+
+        _slabs.clear();
+        _slabCapacity = 0U;
+        _slabUsed = 0U;
+        _freeNodes = NULL;
+        _nodeCount = 0U;
+    }
+
+    virtual FPPoolStatistics statistics() const
+    {
+        FPPoolStatistics result;
+        result.nodeCount = _nodeCount;
+        result.slabCount = _slabs.size();
+        result.nodeAllocations = _nodeAllocations;
+        result.heapAllocations = _heapAllocations;
+        return result;
+    }
+};
@@ -85,10 +85,14 @@
     texture->setName([textureView imageName]);
     texture->setImage([textureView image]);
     [textureList reloadData];
-        
-    Mesh2 *mesh = _delegate.items->currentMesh();
-    if (mesh != NULL)
-        mesh->setTexture(texture);
+    
+    // texture is part of the mesh, shared mesh is copied first
+    Item *item = _delegate.items->firstSelectedItem();
+    if (item != NULL)
+    {
+        item->makeMeshUnique();
+        item->mesh->setTexture(texture);
+    }
     
     [_delegate setNeedsDisplayOnAllViews];
 }
@@ -8,11 +8,13 @@
 
 #include "OpenGLDrawing.h"
 #include "Item.h"
+#include "SelectionFrustum.h"
 
 Item::Item(Mesh2 *aMesh)
 {
     scale = Vector3D(1, 1, 1);
     mesh = aMesh;
+    mesh->retain();
     selected = false;
     visible = true;
     _viewMode = ViewMode::SolidFlat;
@@ -20,10 +22,10 @@ Item::Item(Mesh2 *aMesh)
 
 Item::~Item()
 {
-    delete mesh;
+    mesh->release();
 }
 
-Item::Item(MemoryReadStream *stream, TextureCollection &textures)
+Item::Item(MemoryReadStream *stream, TextureCollection &textures, Mesh2 *sharedMesh)
 {
     if (stream->version() >= (uint)ModelVersion::CrossPlatform)
     {
@@ -51,11 +53,17 @@ Item::Item(MemoryReadStream *stream, TextureCollection &textures)
     }
     
     visible = true;
+    _viewMode = ViewMode::SolidFlat;
+    
+    if (sharedMesh != NULL)
+        mesh = sharedMesh;
+    else
+        mesh = new Mesh2(stream, textures);
     
-    mesh = new Mesh2(stream, textures);
+    mesh->retain();
 }
 
-void Item::encode(MemoryWriteStream *stream, TextureCollection &textures)
+void Item::encode(MemoryWriteStream *stream, TextureCollection &textures, bool encodeMesh)
 {
     stream->write<float>(position.x);
     stream->write<float>(position.y);
@@ -71,8 +79,9 @@ void Item::encode(MemoryWriteStream *stream, TextureCollection &textures)
     stream->write<float>(scale.z);
     
     stream->write<bool>(selected);
-
-    mesh->encode(stream, textures);
+    
+    if (encodeMesh)
+        mesh->encode(stream, textures);
 }
 
 Matrix4x4 Item::transform()
@@ -82,9 +91,36 @@ Matrix4x4 Item::transform()
     return m;
 }
 
+bool Item::isInViewFrustum()
+{
+    // unwrapped meshes draw texture coordinates, the vertex box does not apply
+    if (mesh->isUnwrapped())
+        return true;
+    
+    float modelview[16], projection[16];
+    int viewport[4], rect[4];
+    
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    
+    // selection pass scissors the picked rectangle
+    if (glIsEnabled(GL_SCISSOR_TEST))
+        glGetIntegerv(GL_SCISSOR_BOX, rect);
+    else
+        for (uint i = 0; i < 4; i++)
+            rect[i] = viewport[i];
+    
+    SelectionFrustum frustum(projection, modelview, transform(), viewport, rect[0], rect[1], rect[2], rect[3]);
+    
+    Vector3D minimum, maximum;
+    mesh->getBounds(minimum, maximum);
+    return frustum.intersectsBox(minimum, maximum);
+}
+
 void Item::drawForSelection(bool forSelection)
 {
-    if (visible)
+    if (visible && isInViewFrustum())
 	{
 		glPushMatrix();
 		glTranslatef(position.x, position.y, position.z);
@@ -128,22 +164,40 @@ void Item::scaleByOffset(Vector3D offset)
 
 Item *Item::duplicate()
 {
-    Item *newItem = new Item(new Mesh2());
+    Item *newItem = new Item(mesh);
     
     newItem->position = position;
     newItem->rotation = rotation;
     newItem->scale = scale;
-    
-    newItem->mesh->merge(mesh);
-    newItem->mesh->setColor(mesh->color());
-    newItem->mesh->setTexture(mesh->texture());
     newItem->selected = selected;
-	
-	return newItem;
+    
+    // unwrapping is state of the mesh, shared meshes are never unwrapped
+    if (mesh->isUnwrapped())
+        newItem->makeMeshUnique();
+    
+    return newItem;
+}
+
+void Item::makeMeshUnique()
+{
+    if (!mesh->isShared())
+        return;
+    
+    Mesh2 *uniqueMesh = new Mesh2();
+    uniqueMesh->merge(mesh);
+    uniqueMesh->setColor(mesh->color());
+    uniqueMesh->setTexture(mesh->texture());
+    uniqueMesh->setUnwrapped(_viewMode == ViewMode::Unwrap);
+    
+    mesh->release();
+    mesh = uniqueMesh;
+    mesh->retain();
 }
 
 void Item::setPositionToGeometricCenter()
 {
+    makeMeshUnique();
+    
     Vector3D center = Vector3D();
     
     for (VertexNode *node = mesh->vertices().begin(), *end = mesh->vertices().end(); node != end; node = node->next())
@@ -167,6 +221,8 @@ ViewMode Item::viewMode()
 void Item::setViewMode(ViewMode viewMode)
 {
     _viewMode = viewMode;
+    if (_viewMode == ViewMode::Unwrap)
+        makeMeshUnique();
     mesh->setUnwrapped(_viewMode == ViewMode::Unwrap);
 }
 
@@ -217,6 +273,7 @@ Vector4D Item::selectionColor()
 
 void Item::setSelectionColor(Vector4D color)
 {
+    makeMeshUnique();
     mesh->setColor(color);
 }
 
@@ -227,7 +284,7 @@ void Item::willSelectThrough(bool selectThrough)
 
 void Item::didSelect()
 {
-    mesh->resetTriangleCache();
+    mesh->resetSelectionCache();
     mesh->computeSoftSelection();
 }
 
@@ -34,16 +34,24 @@ public:
     Item(Mesh2 *aMesh);
     virtual ~Item();
     
-    Item(MemoryReadStream *stream, TextureCollection &textures);
-    void encode(MemoryWriteStream *stream, TextureCollection &textures);
+    // with sharedMesh the stream has no mesh data, the item shares the mesh
+    Item(MemoryReadStream *stream, TextureCollection &textures, Mesh2 *sharedMesh = NULL);
+    void encode(MemoryWriteStream *stream, TextureCollection &textures, bool encodeMesh = true);
     
     Matrix4x4 transform();
     
+    // false when the mesh bounds are outside of the view with current OpenGL
+    // matrices and viewport, which drawForSelection expects on entry
+    bool isInViewFrustum();
+    
     void drawForSelection(bool forSelection);
     void moveByOffset(Vector3D offset);
     void rotateByOffset(Quaternion offset);
     void scaleByOffset(Vector3D offset);
+    // duplicate shares the mesh, copy-on-write
     Item *duplicate();
+    // copies a shared mesh, call it before changing the mesh
+    void makeMeshUnique();
     void setPositionToGeometricCenter();
     
     // IOpenGLManipulatingModel
@@ -70,6 +70,7 @@ void MeshState::apply(ItemCollection &collection)
 {
     Item *item = collection.itemAtIndex(_index);
     item->selected = true;
+    item->makeMeshUnique();
     Mesh2 *mesh = item->mesh;
     mesh->fromIndexRepresentation(_vertices, _texCoords, _triangles);
     mesh->setSelectionMode(_selectionMode);
@@ -96,13 +97,24 @@ ItemCollection::~ItemCollection()
 ItemCollection::ItemCollection(MemoryReadStream *stream, TextureCollection &textures)
 {
     uint itemsCount = stream->read<uint>();
-    for (uint i = 0; i < itemsCount; i++)
+    for (uint i = 0; i < itemsCount && stream->isValid(); i++)
     {
-        Item *item = new Item(stream, textures);
+        Mesh2 *sharedMesh = NULL;
+        
+        if (stream->version() >= (uint)ModelVersion::SharedMeshes)
+        {
+            uint sharedIndex = stream->read<uint>();
+            if (sharedIndex < items.size())
+                sharedMesh = items[sharedIndex]->mesh;
+        }
+        
+        Item *item = new Item(stream, textures, sharedMesh);
         items.push_back(item);
     }
 }
 
+// Items sharing a mesh write it only with the first of them, the others
+// write index of that item. Index of the item itself means its own mesh.
 void ItemCollection::encode(MemoryWriteStream *stream, TextureCollection &textures)
 {
     uint itemsCount = items.size();
@@ -110,7 +122,26 @@ void ItemCollection::encode(MemoryWriteStream *stream, TextureCollection &textur
 	for (uint i = 0; i < itemsCount; i++)
 	{
 		Item *item = items.at(i);
-        item->encode(stream, textures);
+        
+        uint sharedIndex = i;
+        if (stream->version() >= (uint)ModelVersion::SharedMeshes)
+        {
+            if (item->mesh->isShared())
+            {
+                for (uint j = 0; j < i; j++)
+                {
+                    if (items[j]->mesh == item->mesh)
+                    {
+                        sharedIndex = j;
+                        break;
+                    }
+                }
+            }
+            
+            stream->write<uint>(sharedIndex);
+        }
+        
+        item->encode(stream, textures, sharedIndex == i);
 	}
 }
 
@@ -344,6 +375,7 @@ void ItemCollection::mergeSelectedItems()
 			itemMatrix.TranslateRotateScale(item->position, item->rotation, scale);
 			
 			Matrix4x4 finalMatrix = firstMatrix * itemMatrix;
+			item->makeMeshUnique();
 			Mesh2 *itemMesh = item->mesh;
 			
 			itemMesh->transformAll(finalMatrix);
@@ -0,0 +1,132 @@
+//
+//  MappedFile.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "MappedFile.h"
+
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+
+using namespace std;
+
+#if defined(WIN32)
+
+MappedFile::MappedFile(const char *fileName)
+{
+    _data = NULL;
+    _length = 0;
+    _isOpen = false;
+    _mapping = NULL;
+    
+    int wideLength = MultiByteToWideChar(CP_UTF8, 0, fileName, -1, NULL, 0);
+    if (wideLength <= 0)
+        return;
+    
+    vector<wchar_t> wideFileName(wideLength);
+    MultiByteToWideChar(CP_UTF8, 0, fileName, -1, &wideFileName[0], wideLength);
+    
+    HANDLE file = CreateFileW(&wideFileName[0], GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return;
+    }
+    
+    _length = (size_t)size.QuadPart;
+    
+    // empty files cannot be mapped
+    if (_length == 0)
+    {
+        CloseHandle(file);
+        _isOpen = true;
+        return;
+    }
+    
+    // the mapping keeps the file open by itself
+    _mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (_mapping == NULL)
+        return;
+    
+    _data = (const char *)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (_data == NULL)
+    {
+        CloseHandle(_mapping);
+        _mapping = NULL;
+        return;
+    }
+    
+    _isOpen = true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data != NULL)
+        UnmapViewOfFile(_data);
+    if (_mapping != NULL)
+        CloseHandle(_mapping);
+}
+
+#else
+
+MappedFile::MappedFile(const char *fileName)
+{
+    _data = NULL;
+    _length = 0;
+    _isOpen = false;
+    
+    int file = open(fileName, O_RDONLY);
+    if (file < 0)
+        return;
+    
+    struct stat status;
+    if (fstat(file, &status) != 0)
+    {
+        close(file);
+        return;
+    }
+    
+    _length = (size_t)status.st_size;
+    
+    // empty files cannot be mapped
+    if (_length == 0)
+    {
+        close(file);
+        _isOpen = true;
+        return;
+    }
+    
+    // the mapping keeps the file open by itself
+    void *data = mmap(NULL, _length, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED)
+        return;
+    
+    madvise(data, _length, MADV_SEQUENTIAL);
+    
+    _data = (const char *)data;
+    _isOpen = true;
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data != NULL)
+        munmap((void *)_data, _length);
+}
+
+#endif
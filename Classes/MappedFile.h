@@ -0,0 +1,39 @@
+//
+//  MappedFile.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include <stddef.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#endif
+
+// Whole file mapped read only into memory. Pages are loaded by the system
+// on first access, so parsers can read large files without copying them.
+class MappedFile
+{
+private:
+    const char *_data;
+    size_t _length;
+    bool _isOpen;
+#if defined(WIN32)
+    HANDLE _mapping;
+#endif
+    
+    MappedFile(const MappedFile &);
+    MappedFile &operator =(const MappedFile &);
+public:
+    // fileName is in UTF-8
+    MappedFile(const char *fileName);
+    ~MappedFile();
+    
+    bool isOpen() const { return _isOpen; }
+    const char *data() const { return _data; }
+    size_t length() const { return _length; }
+};
@@ -8,6 +8,12 @@
 
 #include "MathDeclaration.h"
 
+// SSE kernels are not used in managed code of the C++/CLI build
+#if !defined(_MANAGED) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define MATRIX_SSE
+#include <xmmintrin.h>
+#endif
+
 Matrix4x4::Matrix4x4()
 {
 	Identity();
@@ -349,6 +355,95 @@ Vector4D Matrix4x4::Transform(const Vector4D & v) const
     return t;
 }
 
+#if defined(MATRIX_SSE)
+
+// four packed Vector3D positions to and from separate x, y, z registers
+static inline void LoadPositions(const float * p, __m128 & x, __m128 & y, __m128 & z)
+{
+    __m128 a = _mm_loadu_ps(p);
+    __m128 b = _mm_loadu_ps(p + 4);
+    __m128 c = _mm_loadu_ps(p + 8);
+    
+    __m128 x2y2x3y3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    __m128 y0z0y1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    
+    x = _mm_shuffle_ps(a, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm_shuffle_ps(y0z0y1z1, c, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+static inline void StorePositions(float * p, __m128 x, __m128 y, __m128 z)
+{
+    __m128 x0y0x1y1 = _mm_unpacklo_ps(x, y);
+    __m128 x2y2x3y3 = _mm_unpackhi_ps(x, y);
+    
+    __m128 z0z0x1x1 = _mm_shuffle_ps(z, x0y0x1y1, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 y1y1z1z1 = _mm_shuffle_ps(x0y0x1y1, z, _MM_SHUFFLE(1, 1, 3, 3));
+    __m128 z2z2x3x3 = _mm_shuffle_ps(z, x2y2x3y3, _MM_SHUFFLE(2, 2, 2, 2));
+    __m128 y3y3z3z3 = _mm_shuffle_ps(x2y2x3y3, z, _MM_SHUFFLE(3, 3, 3, 3));
+    
+    _mm_storeu_ps(p, _mm_shuffle_ps(x0y0x1y1, z0z0x1x1, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(y1y1z1z1, x2y2x3y3, _MM_SHUFFLE(1, 0, 2, 0)));
+    _mm_storeu_ps(p + 8, _mm_shuffle_ps(z2z2x3x3, y3y3z3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+static inline __m128 TransformComponent(const float * m, int row, __m128 x, __m128 y, __m128 z)
+{
+    __m128 t = _mm_mul_ps(x, _mm_set1_ps(m[row]));
+    t = _mm_add_ps(t, _mm_mul_ps(y, _mm_set1_ps(m[row + 4])));
+    t = _mm_add_ps(t, _mm_mul_ps(z, _mm_set1_ps(m[row + 8])));
+    return _mm_add_ps(t, _mm_set1_ps(m[row + 12]));
+}
+
+#endif
+
+void Matrix4x4::TransformPositions(Vector3D * positions, unsigned int count) const
+{
+    unsigned int i = 0;
+    
+#if defined(MATRIX_SSE)
+    // Vector3D is three packed floats, so four positions are twelve floats
+    for (; i + 4 <= count; i += 4)
+    {
+        float * p = &positions[i].x;
+        __m128 x, y, z;
+        LoadPositions(p, x, y, z);
+        StorePositions(p, TransformComponent(m, 0, x, y, z), TransformComponent(m, 1, x, y, z), TransformComponent(m, 2, x, y, z));
+    }
+#endif
+    
+    for (; i < count; i++)
+        positions[i] = Transform(positions[i]);
+}
+
+void Matrix4x4::TransformPositions(Vector3D * positions, const float * weights, unsigned int count) const
+{
+    unsigned int i = 0;
+    
+#if defined(MATRIX_SSE)
+    __m128 one = _mm_set1_ps(1.0f);
+    
+    for (; i + 4 <= count; i += 4)
+    {
+        float * p = &positions[i].x;
+        __m128 x, y, z;
+        LoadPositions(p, x, y, z);
+        
+        // same as Vector3D::Lerp, v * (1 - w) + t * w
+        __m128 w = _mm_loadu_ps(weights + i);
+        __m128 iw = _mm_sub_ps(one, w);
+        
+        __m128 tx = _mm_add_ps(_mm_mul_ps(x, iw), _mm_mul_ps(TransformComponent(m, 0, x, y, z), w));
+        __m128 ty = _mm_add_ps(_mm_mul_ps(y, iw), _mm_mul_ps(TransformComponent(m, 1, x, y, z), w));
+        __m128 tz = _mm_add_ps(_mm_mul_ps(z, iw), _mm_mul_ps(TransformComponent(m, 2, x, y, z), w));
+        
+        StorePositions(p, tx, ty, tz);
+    }
+#endif
+    
+    for (; i < count; i++)
+        positions[i] = positions[i].Lerp(Transform(positions[i]), weights[i]);
+}
 
 void Matrix4x4::Frustum(float l, float r, float b, float t, float n, float f)
 {
@@ -62,6 +62,11 @@ public:
     Vector3D Transform(const Vector3D &v) const;
     Vector4D Transform(const Vector4D & v) const;
     
+    // batch transforms of contiguous positions in place, the weighted
+    // variant lerps each position towards its transform like soft selection
+    void TransformPositions(Vector3D * positions, unsigned int count) const;
+    void TransformPositions(Vector3D * positions, const float * weights, unsigned int count) const;
+    
     void Frustum(float l, float r, float b, float t, float n, float f);
     void Perspective(float fovy, float aspect, float n, float f);
 };
@@ -7,6 +7,7 @@
 //
 
 #include "MemoryStream.h"
+#include <string.h>
 
 #if defined(__APPLE__)
 
@@ -15,14 +16,28 @@ MemoryReadStream::MemoryReadStream(NSData *data)
     _data = data;
     _lastReadPosition = 0;
     _version = 0;
+    _failed = false;
 }
 
 MemoryReadStream::~MemoryReadStream()
 {
 }
 
-void MemoryReadStream::readBytes(void *buffer, uint length)
+size_t MemoryReadStream::remainingLength() const
 {
+    return [_data length] - _lastReadPosition;
+}
+
+void MemoryReadStream::readBytes(void *buffer, size_t length)
+{
+    // getBytes:range: throws past the end
+    if (_failed || length > remainingLength())
+    {
+        _failed = true;
+        memset(buffer, 0, length);
+        return;
+    }
+    
     [_data getBytes:buffer range:NSMakeRange(_lastReadPosition, length)];
     _lastReadPosition += length;
 }
@@ -38,7 +53,7 @@ MemoryWriteStream::~MemoryWriteStream()
     
 }
 
-void MemoryWriteStream::writeBytes(const void *buffer, uint length)
+void MemoryWriteStream::writeBytes(const void *buffer, size_t length)
 {
     [_data appendBytes:buffer length:length];
 }
@@ -49,6 +64,7 @@ MemoryReadStream::MemoryReadStream(System::IO::MemoryStream ^stream)
 {
 	_stream = stream;
     _version = 0;
+	_failed = false;
 }
 
 MemoryReadStream::~MemoryReadStream()
@@ -56,10 +72,22 @@ MemoryReadStream::~MemoryReadStream()
 	
 }
 
-void MemoryReadStream::readBytes(void *buffer, unsigned int length)
+size_t MemoryReadStream::remainingLength() const
+{
+	return (size_t)(_stream->Length - _stream->Position);
+}
+
+void MemoryReadStream::readBytes(void *buffer, size_t length)
 {
-	array<Byte> ^bytes = gcnew array<Byte>(length);
-	_stream->Read(bytes, 0, length);
+	if (_failed || length > remainingLength())
+	{
+		_failed = true;
+		memset(buffer, 0, length);
+		return;
+	}
+	
+	array<Byte> ^bytes = gcnew array<Byte>((int)length);
+	_stream->Read(bytes, 0, (int)length);
 	pin_ptr<Byte> bytesPointer = &bytes[0];
 	memcpy(buffer, bytesPointer, length);
 }
@@ -75,12 +103,12 @@ MemoryWriteStream::~MemoryWriteStream()
     
 }
 
-void MemoryWriteStream::writeBytes(const void *buffer, unsigned int length)
+void MemoryWriteStream::writeBytes(const void *buffer, size_t length)
 {
-	array<Byte> ^bytes = gcnew array<Byte>(length);
+	array<Byte> ^bytes = gcnew array<Byte>((int)length);
 	pin_ptr<Byte> bytesPointer = &bytes[0];
 	memcpy(bytesPointer, buffer, length);
-	_stream->Write(bytes, 0, length);
+	_stream->Write(bytes, 0, (int)length);
 }
 
 #elif defined(__linux__)
@@ -90,6 +118,7 @@ MemoryReadStream::MemoryReadStream(vector<unsigned char> *bytes)
     _bytes = bytes;
     _lastReadPosition = 0;
     _version = 0;
+    _failed = false;
 }
 
 MemoryReadStream::~MemoryReadStream()
@@ -97,15 +126,29 @@ MemoryReadStream::~MemoryReadStream()
 
 }
 
-void MemoryReadStream::readBytes(void *buffer, unsigned int length)
+size_t MemoryReadStream::remainingLength() const
 {
-#warning TODO: readBytes
+    return _bytes->size() - _lastReadPosition;
+}
+
+void MemoryReadStream::readBytes(void *buffer, size_t length)
+{
+    if (_failed || length > remainingLength())
+    {
+        _failed = true;
+        memset(buffer, 0, length);
+        return;
+    }
+    
+    if (length > 0)
+        memcpy(buffer, &(*_bytes)[_lastReadPosition], length);
+    _lastReadPosition += length;
 }
 
 MemoryWriteStream::MemoryWriteStream(vector<unsigned char> *bytes)
 {
     _bytes = bytes;
-    _lastWritePosition = 0;
+    _lastWritePosition = bytes->size();
     _version = 0;
 }
 
@@ -114,9 +157,14 @@ MemoryWriteStream::~MemoryWriteStream()
 
 }
 
-void MemoryWriteStream::writeBytes(const void *buffer, unsigned int length)
+void MemoryWriteStream::writeBytes(const void *buffer, size_t length)
 {
-#warning TODO: readBytes
+    if (length == 0)
+        return;
+    
+    _bytes->resize(_lastWritePosition + length);
+    memcpy(&(*_bytes)[_lastWritePosition], buffer, length);
+    _lastWritePosition += length;
 }
 
 #endif
@@ -15,10 +15,10 @@
 #include <vcclr.h>
 using namespace System;
 using namespace System::IO;
-#elif defined(__linux__)
+#endif
+
 #include <vector>
 using namespace std;
-#endif
 
 class MemoryReadStream
 {
@@ -27,6 +27,7 @@ private:
     __unsafe_unretained NSData *_data;
     NSUInteger _lastReadPosition;
     unsigned int _version;
+    bool _failed;
 public:
     MemoryReadStream(NSData *data);
     ~MemoryReadStream();
@@ -34,21 +35,26 @@ public:
 private:
 	gcroot<System::IO::MemoryStream ^> _stream;
 	unsigned int _version;
+	bool _failed;
 public:
 	MemoryReadStream(System::IO::MemoryStream ^stream);
 	~MemoryReadStream();
 #elif defined(__linux__)
 private:
     vector<unsigned char> *_bytes;
-    unsigned int _lastReadPosition;
+    size_t _lastReadPosition;
     unsigned int _version;
+    bool _failed;
 public:
     MemoryReadStream(vector<unsigned char> *bytes);
     ~MemoryReadStream();
 #endif    
     unsigned int version() { return _version; }
     void setVersion(unsigned int value) { _version = value; }
-    void readBytes(void *buffer, unsigned int length);
+    // false after a read past the end, that and all later reads give zeros
+    bool isValid() const { return !_failed; }
+    size_t remainingLength() const;
+    void readBytes(void *buffer, size_t length);
 
     template <class T>
     T read()
@@ -57,6 +63,37 @@ public:
         readBytes(&t, sizeof(T));
         return t;
     }
+    
+    // Counts from damaged or truncated files are checked against bytes left
+    // before sizeof(T) * count is computed, so it never overflows. Values
+    // are not changed when they do not fit.
+    template <class T>
+    bool canReadArray(size_t count)
+    {
+        if (_failed || count > remainingLength() / sizeof(T))
+            _failed = true;
+        return !_failed;
+    }
+    
+    // count values of plain type in one read, like whole vertex block
+    template <class T>
+    void readArray(T *values, size_t count)
+    {
+        if (count > 0 && canReadArray<T>(count))
+            readBytes(values, sizeof(T) * count);
+    }
+    
+    // values stay empty when count does not fit, nothing is allocated
+    template <class T>
+    void readArray(vector<T> &values, size_t count)
+    {
+        values.clear();
+        if (count > 0 && canReadArray<T>(count))
+        {
+            values.resize(count);
+            readBytes(&values[0], sizeof(T) * count);
+        }
+    }
 };
 
 class MemoryWriteStream
@@ -78,7 +115,7 @@ public:
 #elif defined(__linux__)
 private:
     vector<unsigned char> *_bytes;
-    unsigned int _lastWritePosition;
+    size_t _lastWritePosition;
     unsigned int _version;
 public:
     MemoryWriteStream(vector<unsigned char> *bytes);
@@ -86,11 +123,25 @@ public:
 #endif
     unsigned int version() { return _version; }
     void setVersion(unsigned int value) { _version = value; }
-    void writeBytes(const void *buffer, unsigned int length);
+    void writeBytes(const void *buffer, size_t length);
     
     template <class T>
     void write(const T &value)
     {
         writeBytes(&value, sizeof(T));
     }
+    
+    template <class T>
+    void writeArray(const T *values, size_t count)
+    {
+        if (count > 0)
+            writeBytes(values, sizeof(T) * count);
+    }
+    
+    template <class T>
+    void writeArray(const vector<T> &values)
+    {
+        if (!values.empty())
+            writeArray(&values[0], values.size());
+    }
 };
@@ -8,6 +8,8 @@
 
 #include "Mesh2.h"
 #include "TextureCollection.h"
+#include "ParallelFor.h"
+#include <algorithm>
 
 #if defined(WIN32)
 #include <ciso646>
@@ -160,30 +162,52 @@ System::String ^Mesh2::descriptionOfMeshType(MeshType meshType)
 }
 #endif
 
-Mesh2::Mesh2()
+Mesh2::Mesh2() :
+    _vertices(&_vertexPool),
+    _triangles(&_trianglePool),
+    _texCoords(&_texCoordPool),
+    _vertexEdges(&_vertexEdgePool),
+    _texCoordEdges(&_texCoordEdgePool),
+    _edgeTablesValid(false)
 {
     _selectionMode = MeshSelectionMode::Vertices;
     
     _vboID = 0U;
+    _iboID = 0U;
     _vboGenerated = false;
     
     _isUnwrapped = false;
+    _cachedPointsUnwrapped = false;
+    _cachedTriangleIDsUnwrapped = false;
+    _boundsValid = false;
     
     _texture = NULL;
+    _referenceCount = 0U;
     
     setColor(generateRandomColor());
 }
 
-Mesh2::Mesh2(MemoryReadStream *stream, TextureCollection &textures)
+Mesh2::Mesh2(MemoryReadStream *stream, TextureCollection &textures) :
+    _vertices(&_vertexPool),
+    _triangles(&_trianglePool),
+    _texCoords(&_texCoordPool),
+    _vertexEdges(&_vertexEdgePool),
+    _texCoordEdges(&_texCoordEdgePool),
+    _edgeTablesValid(false)
 {
 	_selectionMode = MeshSelectionMode::Vertices;
     
     _vboID = 0U;
+    _iboID = 0U;
     _vboGenerated = false;
     
     _isUnwrapped = false;
+    _cachedPointsUnwrapped = false;
+    _cachedTriangleIDsUnwrapped = false;
+    _boundsValid = false;
     
     _texture = NULL;
+    _referenceCount = 0U;
     
     setColor(generateRandomColor());
     
@@ -199,7 +223,7 @@ Mesh2::Mesh2(MemoryReadStream *stream, TextureCollection &textures)
     }
     
     Vector4D color;
-
+    
     if (version >= ModelVersion::CrossPlatform)
     {
         color.x = stream->read<float>();
@@ -224,27 +248,45 @@ Mesh2::Mesh2(MemoryReadStream *stream, TextureCollection &textures)
     vector<Vector3D> texCoords;
     vector<TriQuad> triangles;
     
-    if (version >= ModelVersion::CrossPlatform)
+    // vectors were always written as three floats, only triangles differ
+    static_assert(sizeof(Vector3D) == 3 * sizeof(float), "Vector3D is read as three floats");
+    
+    // readArray allocates only counts which fit in the rest of the stream,
+    // damaged or truncated files fail the stream instead
+    stream->readArray(vertices, verticesSize);
+    stream->readArray(texCoords, texCoordsSize);
+    
+    if (version >= ModelVersion::BulkArrays)
     {
-        for (uint i = 0; i < verticesSize; i++)
-        {
-            Vector3D vertex;
-            vertex.x = stream->read<float>();
-            vertex.y = stream->read<float>();
-            vertex.z = stream->read<float>();
-            vertices.push_back(vertex);
-        }
+        vector<unsigned char> quads;
+        stream->readArray(quads, trianglesSize);
+        
+        size_t cornerCount = 0;
+        for (uint i = 0; i < quads.size(); i++)
+            cornerCount += quads[i] ? 4 : 3;
+        
+        vector<uint> indices;
+        stream->readArray(indices, cornerCount * 2);
         
-        for (uint i = 0; i < texCoordsSize; i++)
+        if (stream->isValid())
         {
-            Vector3D texCoord;
-            texCoord.x = stream->read<float>();
-            texCoord.y = stream->read<float>();
-            texCoord.z = stream->read<float>();
-            texCoords.push_back(texCoord);
+            triangles.resize(trianglesSize);
+            for (uint i = 0, k = 0; i < trianglesSize; i++)
+            {
+                TriQuad &triangle = triangles[i];
+                triangle.isQuad = quads[i] != 0;
+                uint count = triangle.isQuad ? 4 : 3;
+                for (uint j = 0; j < count; j++, k += 2)
+                {
+                    triangle.vertexIndices[j] = indices[k];
+                    triangle.texCoordIndices[j] = indices[k + 1];
+                }
+            }
         }
-        
-        for (uint i = 0; i < trianglesSize; i++)
+    }
+    else if (version >= ModelVersion::CrossPlatform)
+    {
+        for (uint i = 0; i < trianglesSize && stream->isValid(); i++)
         {
             TriQuad triangle;
             triangle.isQuad = stream->read<bool>();
@@ -257,61 +299,55 @@ Mesh2::Mesh2(MemoryReadStream *stream, TextureCollection &textures)
             triangles.push_back(triangle);
         }
     }
+    else if (version >= ModelVersion::TriQuads)
+    {
+        stream->readArray(triangles, trianglesSize);
+    }
     else
     {
-        for (uint i = 0; i < verticesSize; i++)
-        {
-            Vector3D vertex = stream->read<Vector3D>();
-            vertices.push_back(vertex);
-        }
-        
-        for (uint i = 0; i < texCoordsSize; i++)
-        {
-            Vector3D texCoord = stream->read<Vector3D>();
-            texCoords.push_back(texCoord);
-        }
+        vector<Triangle> oldTriangles;
+        stream->readArray(oldTriangles, trianglesSize);
         
-        if (version >= ModelVersion::TriQuads)
-        {
-            for (uint i = 0; i < trianglesSize; i++)
-            {
-                TriQuad triangle = stream->read<TriQuad>();
-                triangles.push_back(triangle);
-            }
-        }
-        else
+        triangles.resize(oldTriangles.size());
+        for (uint i = 0; i < oldTriangles.size(); i++)
         {
-            for (uint i = 0; i < trianglesSize; i++)
+            TriQuad &triQuad = triangles[i];
+            triQuad.isQuad = false;
+            for (uint j = 0; j < 3; j++)
             {
-                Triangle triangle = stream->read<Triangle>();
-                TriQuad triQuad;
-                triQuad.isQuad = false;
-                for (uint j = 0; j < 3; j++)
-                {
-                    triQuad.vertexIndices[j] = triangle.vertexIndices[j];
-                    triQuad.texCoordIndices[j] = triangle.texCoordIndices[j];
-                }
-                triangles.push_back(triQuad);
+                triQuad.vertexIndices[j] = oldTriangles[i].vertexIndices[j];
+                triQuad.texCoordIndices[j] = oldTriangles[i].texCoordIndices[j];
             }
         }
     }
     
+    // reader of the document reports the failure, mesh stays empty
+    if (!stream->isValid())
+    {
+        vertices.clear();
+        texCoords.clear();
+        triangles.clear();
+    }
+    
     this->fromIndexRepresentation(vertices, texCoords, triangles);
     this->setColor(color);
 }
 
 void Mesh2::encode(MemoryWriteStream *stream, TextureCollection &textures)
 {
-    if (_texture == NULL)
-        stream->write<uint>(UINT_MAX);
-    else
-        stream->write<uint>(textures.indexOfTexture(_texture));
+    if (stream->version() >= (uint)ModelVersion::TextureNames)
+    {
+        if (_texture == NULL)
+            stream->write<uint>(UINT_MAX);
+        else
+            stream->write<uint>(textures.indexOfTexture(_texture));
+    }
     
     stream->write<float>(_color.x);
     stream->write<float>(_color.y);
     stream->write<float>(_color.z);
     stream->write<float>(_color.w);
-        
+    
     vector<Vector3D> vertices;
     vector<Vector3D> texCoords;
     vector<TriQuad> triangles;
@@ -326,33 +362,44 @@ void Mesh2::encode(MemoryWriteStream *stream, TextureCollection &textures)
     stream->write<uint>(texCoordCount);
     stream->write<uint>(triangleCount);
     
-    for (uint i = 0; i < vertexCount; i++)
-    {
-        const Vector3D &v = vertices[i];
-        stream->write<float>(v.x);
-        stream->write<float>(v.y);
-        stream->write<float>(v.z);        
-    }
-
-    for (uint i = 0; i < texCoordCount; i++)
+    stream->writeArray(vertices);
+    stream->writeArray(texCoords);
+    
+    if (stream->version() < (uint)ModelVersion::BulkArrays)
     {
-        const Vector3D &v = texCoords[i];
-        stream->write<float>(v.x);
-        stream->write<float>(v.y);
-        stream->write<float>(v.z);
+        for (uint i = 0; i < triangleCount; i++)
+        {
+            const TriQuad &t = triangles[i];
+            stream->write<bool>(t.isQuad);
+            uint count = t.isQuad ? 4 : 3;
+            for (uint j = 0; j < count; j++)
+            {
+                stream->write(t.vertexIndices[j]);
+                stream->write(t.texCoordIndices[j]);
+            }
+        }
+        return;
     }
-	
-	for (uint i = 0; i < triangleCount; i++)
+    
+    // quad flags first, then vertex and texCoord index of every corner
+    vector<unsigned char> quads(triangleCount);
+    vector<uint> indices;
+    indices.reserve(triangleCount * 8);
+    
+    for (uint i = 0; i < triangleCount; i++)
     {
         const TriQuad &t = triangles[i];
-        stream->write<bool>(t.isQuad);
+        quads[i] = t.isQuad ? 1 : 0;
         uint count = t.isQuad ? 4 : 3;
         for (uint j = 0; j < count; j++)
         {
-            stream->write(t.vertexIndices[j]);
-            stream->write(t.texCoordIndices[j]);
+            indices.push_back(t.vertexIndices[j]);
+            indices.push_back(t.texCoordIndices[j]);
         }
     }
+    
+    stream->writeArray(quads);
+    stream->writeArray(indices);
 }
 
 void Mesh2::setColor(Vector4D color)
@@ -367,6 +414,62 @@ void Mesh2::setColor(Vector4D color)
 Mesh2::~Mesh2()
 {
     resetTriangleCache();
+    removeAll();
+    
+#if defined(__APPLE__) || defined(SHADERS)
+    if (_vboGenerated)
+    {
+        glDeleteBuffers(1, &_vboID);
+        glDeleteBuffers(1, &_iboID);
+    }
+#endif
+}
+
+void Mesh2::release()
+{
+    if (_referenceCount > 1)
+        _referenceCount--;
+    else
+        delete this;
+}
+
+void Mesh2::removeAll()
+{
+    _cachedVertexSelection.clear();
+    _cachedTriangleSelection.clear();
+    _cachedVertexEdgeSelection.clear();
+    _cachedTexCoordSelection.clear();
+    _cachedTexCoordEdgeSelection.clear();
+    
+    _vertices.abandonAll();
+    _triangles.abandonAll();
+    _texCoords.abandonAll();
+    _vertexEdges.abandonAll();
+    _texCoordEdges.abandonAll();
+    
+    _vertexEdgeTable.clear();
+    _texCoordEdgeTable.clear();
+    _edgeTablesValid = false;
+    _vertexGrid.invalidate();
+    _triangleBVH.invalidate();
+    
+    clearDirtyTopology();
+    
+    _vertexPool.releaseAll();
+    _trianglePool.releaseAll();
+    _texCoordPool.releaseAll();
+    _vertexEdgePool.releaseAll();
+    _texCoordEdgePool.releaseAll();
+}
+
+FPPoolStatistics Mesh2::poolStatistics() const
+{
+    FPPoolStatistics result = _vertexPool.statistics();
+    result.add(_trianglePool.statistics());
+    result.add(_texCoordPool.statistics());
+    result.add(_vertexEdgePool.statistics());
+    result.add(_texCoordEdgePool.statistics());
+    return result;
 }
 
 void Mesh2::resetAlgorithmData()
@@ -382,6 +485,10 @@ void Mesh2::setSelectionMode(MeshSelectionMode value)
 {
     resetEdgeCache();
     
+    // scripts move vertices directly and call this afterwards
+    _vertexGrid.invalidate();
+    _triangleBVH.invalidate();
+    
     _selectionMode = value;
     _cachedVertexSelection.clear();
     _cachedTriangleSelection.clear();
@@ -464,6 +571,291 @@ void Mesh2::setSelectionMode(MeshSelectionMode value)
     }
 }
 
+// Removes repeated nodes and keeps the order of their first occurrence.
+template <class TNode>
+static void removeDuplicateNodes(vector<TNode *> &nodes)
+{
+    vector<TNode *> sorted(nodes);
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+    
+    if (sorted.size() == nodes.size())
+        return;
+    
+    vector<bool> visited(sorted.size(), false);
+    uint count = 0;
+    
+    for (uint i = 0; i < nodes.size(); i++)
+    {
+        uint index = lower_bound(sorted.begin(), sorted.end(), nodes[i]) - sorted.begin();
+        if (!visited[index])
+        {
+            visited[index] = true;
+            nodes[count++] = nodes[i];
+        }
+    }
+    
+    nodes.resize(count);
+}
+
+// Edges which lost their first triangle keep the second one in slot 0,
+// as if they were created by it.
+template <class T>
+static void compactEdgeTriangles(const vector<VEdgeNode<T> *> &edges)
+{
+    for (uint i = 0; i < edges.size(); i++)
+    {
+        VEdge<T> &edge = edges[i]->data();
+        if (edge.triangle(0) == NULL)
+        {
+            edge.setTriangle(0, edge.triangle(1));
+            edge.setTriangle(1, NULL);
+        }
+    }
+}
+
+// Removed edges leave the edge table too when it is not NULL, otherwise
+// sharedEdge() could find them after their nodes are released.
+template <class T>
+static void updateDirtyEdges(const vector<VEdgeNode<T> *> &edges, FPList<VEdgeNode<T>, VEdge<T> > &list,
+                             VEdgeTable<T> *table, vector<VEdgeNode<T> *> &removed)
+{
+    for (uint i = 0; i < edges.size(); i++)
+    {
+        VEdgeNode<T> *node = edges[i];
+        VEdge<T> &edge = node->data();
+        if (edge.triangle(1) != NULL)
+            continue;
+        
+        // non-manifold edges keep only two triangles, the others still point
+        // to them and take the free slots
+        VNode<T> *vertex = edge.vertex(0);
+        if (vertex)
+        {
+            for (VertexTriangleNode *triangleNode = vertex->_triangles.begin(), *end = vertex->_triangles.end(); triangleNode != end; triangleNode = triangleNode->next())
+            {
+                TriangleNode *triangle = triangleNode->data();
+                if (!triangle->data().containsEdge(node) || edge.containsTriangle(triangle))
+                    continue;
+                
+                if (edge.triangle(0) == NULL)
+                    edge.setTriangle(0, triangle);
+                else if (edge.triangle(1) == NULL)
+                    edge.setTriangle(1, triangle);
+            }
+        }
+        
+        if (edge.triangle(0) == NULL)
+        {
+            if (table)
+                table->remove(node);
+            removed.push_back(node);
+            list.remove(node);
+        }
+    }
+}
+
+// New nodes are always added at the end of the list, so the cached
+// selection keeps list order when removed nodes are dropped and the
+// tail of the list is appended.
+template <class TNode, class TData>
+static void updateCachedSelection(vector<TNode *> &cache, vector<TNode *> &removed, const FPList<TNode, TData> &list)
+{
+    if (list.count() == 0)
+    {
+        cache.clear();
+        return;
+    }
+    
+    if (removed.size() > 0)
+    {
+        sort(removed.begin(), removed.end());
+        
+        uint count = 0;
+        for (uint i = 0; i < cache.size(); i++)
+        {
+            if (!binary_search(removed.begin(), removed.end(), cache[i]))
+                cache[count++] = cache[i];
+        }
+        cache.resize(count);
+    }
+    
+    TNode *node = list.end();
+    for (uint i = cache.size(); i < list.count(); i++)
+        node = node->previous();
+    
+    for (TNode *end = list.end(); node != end; node = node->next())
+        cache.push_back(node);
+}
+
+void Mesh2::clearDirtyTopology()
+{
+    _dirtyTriangles.clear();
+    _removedTriangles.clear();
+    _dirtyVertices.clear();
+    _dirtyTexCoords.clear();
+    _dirtyVertexEdges.clear();
+    _dirtyTexCoordEdges.clear();
+}
+
+void Mesh2::markTriangleDirty(TriangleNode *node)
+{
+    _dirtyTriangles.push_back(node);
+}
+
+void Mesh2::markTriangleSelectionDirty(TriangleNode *node)
+{
+    Triangle2 &triangle = node->data();
+    for (uint i = 0; i < triangle.count(); i++)
+    {
+        _dirtyVertices.push_back(triangle.vertex(i));
+        _dirtyTexCoords.push_back(triangle.texCoord(i));
+    }
+}
+
+void Mesh2::removeTriangleAndMarkDirty(TriangleNode *&node)
+{
+    Triangle2 &triangle = node->data();
+    for (uint i = 0; i < triangle.count(); i++)
+    {
+        if (triangle.vertexEdge(i))
+            _dirtyVertexEdges.push_back(triangle.vertexEdge(i));
+        if (triangle.texCoordEdge(i))
+            _dirtyTexCoordEdges.push_back(triangle.texCoordEdge(i));
+    }
+    
+    markTriangleSelectionDirty(node);
+    _removedTriangles.push_back(node);
+    _triangles.remove(node);
+}
+
+// Replaces makeEdges() and setSelectionMode() after local edits. Only the
+// marked triangles, their edges and vertices are rebuilt, so the cost is
+// proportional to the size of the edit. Vertices and texture coordinates
+// of removed triangles are removed when they are no longer used.
+void Mesh2::updateDirtyTopology()
+{
+    _triangleBVH.invalidate();
+    
+    removeDuplicateNodes(_dirtyTriangles);
+    
+    for (uint i = 0; i < _dirtyTriangles.size(); i++)
+    {
+        TriangleNode *node = _dirtyTriangles[i];
+        Triangle2 &triangle = node->data();
+        
+        for (uint j = 0; j < triangle.count(); j++)
+        {
+            if (triangle.vertexEdge(j))
+            {
+                triangle.vertexEdge(j)->data().removeTriangle(node);
+                _dirtyVertexEdges.push_back(triangle.vertexEdge(j));
+            }
+            
+            if (triangle.texCoordEdge(j))
+            {
+                triangle.texCoordEdge(j)->data().removeTriangle(node);
+                _dirtyTexCoordEdges.push_back(triangle.texCoordEdge(j));
+            }
+        }
+        
+        markTriangleSelectionDirty(node);
+    }
+    
+    removeDuplicateNodes(_dirtyVertexEdges);
+    removeDuplicateNodes(_dirtyTexCoordEdges);
+    
+    compactEdgeTriangles(_dirtyVertexEdges);
+    compactEdgeTriangles(_dirtyTexCoordEdges);
+    
+    for (uint i = 0; i < _dirtyTriangles.size(); i++)
+        makeEdges(_dirtyTriangles[i]);
+    
+    vector<VertexEdgeNode *> removedVertexEdges;
+    vector<TexCoordEdgeNode *> removedTexCoordEdges;
+    updateDirtyEdges(_dirtyVertexEdges, _vertexEdges, _edgeTablesValid ? &_vertexEdgeTable : NULL, removedVertexEdges);
+    updateDirtyEdges(_dirtyTexCoordEdges, _texCoordEdges, _edgeTablesValid ? &_texCoordEdgeTable : NULL, removedTexCoordEdges);
+    
+    removeDuplicateNodes(_dirtyVertices);
+    removeDuplicateNodes(_dirtyTexCoords);
+    
+    vector<VertexNode *> removedVertices;
+    vector<TexCoordNode *> removedTexCoords;
+    
+    for (uint i = 0; i < _dirtyVertices.size(); i++)
+    {
+        VertexNode *node = _dirtyVertices[i];
+        if (node == NULL)
+            continue;
+        
+        if (_vertexGrid.isValid())
+        {
+            if (node->isUsed())
+                _vertexGrid.update(node);
+            else
+                _vertexGrid.remove(node);
+        }
+        
+        if (!node->isUsed())
+        {
+            removedVertices.push_back(node);
+            _vertices.remove(node);
+        }
+        else if (_selectionMode == MeshSelectionMode::Triangles)
+        {
+            node->data().selected = node->hasSelectedTriangle();
+        }
+        else if (_selectionMode == MeshSelectionMode::Edges)
+        {
+            node->data().selected = !_isUnwrapped && node->hasSelectedEdge();
+        }
+    }
+    
+    for (uint i = 0; i < _dirtyTexCoords.size(); i++)
+    {
+        TexCoordNode *node = _dirtyTexCoords[i];
+        if (node == NULL)
+            continue;
+        
+        if (!node->isUsed())
+        {
+            removedTexCoords.push_back(node);
+            _texCoords.remove(node);
+        }
+        else if (_selectionMode == MeshSelectionMode::Triangles)
+        {
+            node->data().selected = node->hasSelectedTriangle();
+        }
+        else if (_selectionMode == MeshSelectionMode::Edges)
+        {
+            node->data().selected = _isUnwrapped && node->hasSelectedEdge();
+        }
+    }
+    
+    resetEdgeCache();
+    
+    switch (_selectionMode)
+    {
+        case MeshSelectionMode::Vertices:
+            updateCachedSelection(_cachedVertexSelection, removedVertices, _vertices);
+            updateCachedSelection(_cachedTexCoordSelection, removedTexCoords, _texCoords);
+            break;
+        case MeshSelectionMode::Triangles:
+            updateCachedSelection(_cachedTriangleSelection, _removedTriangles, _triangles);
+            break;
+        case MeshSelectionMode::Edges:
+            if (_isUnwrapped)
+                updateCachedSelection(_cachedTexCoordEdgeSelection, removedTexCoordEdges, _texCoordEdges);
+            else
+                updateCachedSelection(_cachedVertexEdgeSelection, removedVertexEdges, _vertexEdges);
+            break;
+        default:
+            break;
+    }
+    
+    clearDirtyTopology();
+}
+
 uint Mesh2::selectedCount() const
 {
     switch (_selectionMode)
@@ -551,7 +943,7 @@ void Mesh2::expandSelectionFromIndex(uint index, bool invert)
         case MeshSelectionMode::Edges:
         {
             VertexEdge &edge = _cachedVertexEdgeSelection.at(index)->data();
-
+            
             if (invert)
                 edge.selectEdgesInQuadLoop();
             else
@@ -564,12 +956,198 @@ void Mesh2::expandSelectionFromIndex(uint index, bool invert)
     }
 }
 
+bool Mesh2::intersectsFrustumAtIndex(const SelectionFrustum &frustum, uint index) const
+{
+    switch (_selectionMode)
+    {
+        case MeshSelectionMode::Vertices:
+        {
+            if (_isUnwrapped)
+            {
+                const TexCoord &texCoord = _cachedTexCoordSelection[index]->data();
+                return texCoord.visible && frustum.containsPoint(texCoord.position);
+            }
+            const Vertex2 &vertex = _cachedVertexSelection[index]->data();
+            return vertex.visible && frustum.containsPoint(vertex.position);
+        }
+        case MeshSelectionMode::Triangles:
+        {
+            const Triangle2 &triangle = _cachedTriangleSelection[index]->data();
+            if (!triangle.visible)
+                return false;
+            
+            Vector3D v[4];
+            for (uint i = 0; i < triangle.count(); i++)
+                v[i] = _isUnwrapped ? triangle.texCoord(i)->data().position : triangle.vertex(i)->data().position;
+            
+            if (frustum.intersectsTriangle(v[0], v[1], v[2]))
+                return true;
+            return triangle.isQuad() && frustum.intersectsTriangle(v[0], v[2], v[3]);
+        }
+        case MeshSelectionMode::Edges:
+        {
+            if (_isUnwrapped)
+            {
+                const TexCoordEdge &edge = _cachedTexCoordEdgeSelection[index]->data();
+                return edge.visible && frustum.intersectsSegment(edge.texCoord(0)->data().position, edge.texCoord(1)->data().position);
+            }
+            const VertexEdge &edge = _cachedVertexEdgeSelection[index]->data();
+            return edge.visible && frustum.intersectsSegment(edge.vertex(0)->data().position, edge.vertex(1)->data().position);
+        }
+        default:
+            return false;
+    }
+}
+
+// work below this size per thread is not worth starting threads for
+const uint FrustumSelectMinimumRange = 4096;
+
+// resolution limit of the occlusion depth buffer
+const uint FrustumSelectMaximumDepthSize = 1024;
+
+// positions gathered per batch for SelectionFrustum::containsPoints
+const uint FrustumSelectBatchSize = 256;
+
+static bool selectionResult(bool selected, OpenGLSelectionMode selectionMode)
+{
+    switch (selectionMode)
+    {
+        case OpenGLSelectionMode::Add:
+            return true;
+        case OpenGLSelectionMode::Subtract:
+            return false;
+        case OpenGLSelectionMode::Invert:
+            return !selected;
+        default:
+            return selected;
+    }
+}
+
+struct FrustumSelectBody
+{
+    const Mesh2 *mesh;
+    const SelectionFrustum *frustum;
+    vector<unsigned char> *hits;
+    
+    void operator()(uint first, uint last)
+    {
+        for (uint i = first; i < last; i++)
+            (*hits)[i] = mesh->intersectsFrustumAtIndex(*frustum, i) ? 1 : 0;
+    }
+};
+
+// Vertices and texture coordinates are tested in contiguous batches and
+// selected right away, each index owns its node so threads do not collide.
+template <class TNode>
+struct FrustumSelectPointsBody
+{
+    const vector<TNode *> *nodes;
+    const SelectionFrustum *frustum;
+    OpenGLSelectionMode selectionMode;
+    
+    void operator()(uint first, uint last)
+    {
+        Vector3D positions[FrustumSelectBatchSize];
+        unsigned char hits[FrustumSelectBatchSize];
+        
+        for (uint batchFirst = first; batchFirst < last; batchFirst += FrustumSelectBatchSize)
+        {
+            uint count = min(last - batchFirst, FrustumSelectBatchSize);
+            TNode * const *batch = &(*nodes)[batchFirst];
+            
+            for (uint i = 0; i < count; i++)
+                positions[i] = batch[i]->data().position;
+            
+            frustum->containsPoints(positions, count, hits);
+            
+            for (uint i = 0; i < count; i++)
+            {
+                if (hits[i] && batch[i]->data().visible)
+                    batch[i]->data().selected = selectionResult(batch[i]->data().selected, selectionMode);
+            }
+        }
+    }
+};
+
+void Mesh2::selectInFrustum(SelectionFrustum &frustum, bool useOcclusion, OpenGLSelectionMode selectionMode)
+{
+    // texture coordinates are flat, nothing can hide them
+    if (useOcclusion && !_isUnwrapped)
+    {
+        updateTriangleBVH();
+        
+        vector<TriangleNode *> candidates;
+        _triangleBVH.frustumQuery(frustum, candidates);
+        
+        vector<Vector3D> corners;
+        corners.reserve(candidates.size() * 3);
+        
+        for (uint i = 0; i < candidates.size(); i++)
+        {
+            const Triangle2 &triangle = candidates[i]->data();
+            if (!triangle.visible)
+                continue;
+            
+            corners.push_back(triangle.vertex(0)->data().position);
+            corners.push_back(triangle.vertex(1)->data().position);
+            corners.push_back(triangle.vertex(2)->data().position);
+            
+            if (triangle.isQuad())
+            {
+                corners.push_back(triangle.vertex(0)->data().position);
+                corners.push_back(triangle.vertex(2)->data().position);
+                corners.push_back(triangle.vertex(3)->data().position);
+            }
+        }
+        
+        frustum.setOccluders(corners, FrustumSelectMaximumDepthSize);
+    }
+    
+    uint count = selectedCount();
+    
+    if (_selectionMode == MeshSelectionMode::Vertices)
+    {
+        if (_isUnwrapped)
+        {
+            FrustumSelectPointsBody<TexCoordNode> body;
+            body.nodes = &_cachedTexCoordSelection;
+            body.frustum = &frustum;
+            body.selectionMode = selectionMode;
+            ParallelFor(count, FrustumSelectMinimumRange, body);
+        }
+        else
+        {
+            FrustumSelectPointsBody<VertexNode> body;
+            body.nodes = &_cachedVertexSelection;
+            body.frustum = &frustum;
+            body.selectionMode = selectionMode;
+            ParallelFor(count, FrustumSelectMinimumRange, body);
+        }
+        return;
+    }
+    
+    vector<unsigned char> hits(count, 0);
+    
+    FrustumSelectBody body;
+    body.mesh = this;
+    body.frustum = &frustum;
+    body.hits = &hits;
+    ParallelFor(count, FrustumSelectMinimumRange, body);
+    
+    // edges and triangles share vertices, so they are selected serially
+    for (uint i = 0; i < count; i++)
+    {
+        if (hits[i])
+            setSelectedAtIndex(selectionResult(isSelectedAtIndex(i), selectionMode), i);
+    }
+}
+
 void Mesh2::getSelectionCenterRotationScale(Vector3D &center, Quaternion &rotation, Vector3D &scale)
 {
     center = Vector3D();
 	rotation = Quaternion();
 	scale = Vector3D(1, 1, 1);
-    
+
 	uint selectedCount = 0;
     
     if (_isUnwrapped)
@@ -598,25 +1176,68 @@ void Mesh2::getSelectionCenterRotationScale(Vector3D &center, Quaternion &rotati
 		center /= (float)selectedCount;
 }
 
+// Gathers node positions into a small contiguous batch for the Matrix4x4
+// batch transform, batches stay in cache between gather and scatter.
+template <class TNode>
+class BatchTransform
+{
+private:
+    enum { Capacity = 256 };
+    
+    const Matrix4x4 &_matrix;
+    TNode *_nodes[Capacity];
+    Vector3D _positions[Capacity];
+    float _weights[Capacity];
+    uint _count;
+    bool _weighted;
+public:
+    BatchTransform(const Matrix4x4 &matrix, bool weighted = false) : _matrix(matrix), _count(0), _weighted(weighted) { }
+    
+    void add(TNode *node, float weight = 1.0f)
+    {
+        _nodes[_count] = node;
+        _positions[_count] = node->data().position;
+        _weights[_count] = weight;
+        
+        if (++_count == Capacity)
+            flush();
+    }
+    
+    void flush()
+    {
+        if (_weighted)
+            _matrix.TransformPositions(_positions, _weights, _count);
+        else
+            _matrix.TransformPositions(_positions, _count);
+        
+        for (uint i = 0; i < _count; i++)
+            _nodes[i]->data().position = _positions[i];
+        
+        _count = 0;
+    }
+};
+
 void Mesh2::transformAll(const Matrix4x4 &matrix)
 {
     resetTriangleCache();
     
     if (_isUnwrapped)
     {
+        BatchTransform<TexCoordNode> batch(matrix);
+        
         for (TexCoordNode *node = _texCoords.begin(), *end = _texCoords.end(); node != end; node = node->next())
-        {
-            Vector3D &v = node->data().position;
-            v = matrix.Transform(v);
-        }
+            batch.add(node);
+        
+        batch.flush();
     }
     else
     {
+        BatchTransform<VertexNode> batch(matrix);
+        
         for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
-        {
-            Vector3D &v = node->data().position;
-            v = matrix.Transform(v);
-        }
+            batch.add(node);
+        
+        batch.flush();
     }
     
     setSelectionMode(_selectionMode);
@@ -628,14 +1249,15 @@ void Mesh2::transformSelected(const Matrix4x4 &matrix)
     {
         resetTriangleCache();
         
+        BatchTransform<TexCoordNode> batch(matrix);
+        
         for (TexCoordNode *node = _texCoords.begin(), *end = _texCoords.end(); node != end; node = node->next())
         {
             if (node->data().selected)
-            {
-                Vector3D &v = node->data().position;
-                v = matrix.Transform(v);
-            }
+                batch.add(node);
         }
+        
+        batch.flush();
     }
     else
     {
@@ -644,27 +1266,41 @@ void Mesh2::transformSelected(const Matrix4x4 &matrix)
         if (_useSoftSelection)
         {
             resetTriangleCache();
+            _vertexGrid.invalidate();
+            
+            BatchTransform<VertexNode> batch(matrix, true);
             
             for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
             {
                 if (node->selectionWeight > _minimumSelectionWeight)
-                {
-                    Vector3D &v = node->data().position;
-                    v = v.Lerp(matrix.Transform(v), node->selectionWeight);
-                }
+                    batch.add(node, node->selectionWeight);
             }
+            
+            batch.flush();
         }
         else
         {
+            BatchTransform<VertexNode> batch(matrix);
+            
             for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
             {
                 if (node->data().selected)
                 {
-                    Vector3D &v = node->data().position;
-                    v = matrix.Transform(v);
+                    if (_vertexGrid.isValid())
+                        _vertexGrid.remove(node);
+                    
+                    batch.add(node);
                     affectedVertices.push_back(node);
                 }
             }
+            
+            batch.flush();
+            
+            if (_vertexGrid.isValid())
+            {
+                for (uint i = 0; i < affectedVertices.size(); i++)
+                    _vertexGrid.add(affectedVertices[i]);
+            }
         }
         
         updateTriangleAndEdgeCache(affectedVertices);
@@ -802,15 +1438,10 @@ void Mesh2::removeSelectedTriangles()
     for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
     {
         if (node->data().selected)
-            _triangles.remove(node);
+            removeTriangleAndMarkDirty(node);
     }
     
-    removeNonUsedVertices();
-    removeNonUsedTexCoords();
-    
-    makeEdges();
-    
-    setSelectionMode(_selectionMode);
+    updateDirtyTopology();
 }
 
 void Mesh2::removeSelectedEdges()
@@ -847,7 +1478,7 @@ void Mesh2::removeSelectedEdges()
     removeDegeneratedTriangles();
     removeNonUsedVertices();
     removeNonUsedTexCoords();
-
+    
     makeEdges();
     
     setSelectionMode(_selectionMode);
@@ -913,7 +1544,7 @@ void Mesh2::triangulate()
     }
     
     makeEdges();
-	
+    
     setSelectionMode(_selectionMode);
 }
 
@@ -939,16 +1570,14 @@ void Mesh2::triangulateSelectedQuads()
                     triangle[i].setTexCoord(j, quad.texCoord(index));
                 }
                 
-                _triangles.add(triangle[i]);
+                markTriangleDirty(_triangles.add(triangle[i]));
             }
             
-            _triangles.remove(node);
+            removeTriangleAndMarkDirty(node);
         }
     }
     
-    makeEdges();
-	
-    setSelectionMode(_selectionMode);
+    updateDirtyTopology();
 }
 
 void Mesh2::openSubdivision()
@@ -1166,7 +1795,7 @@ void Mesh2::makeSubdividedTriangles()
 {
     VertexNode *vertices[6];
     TexCoordNode *texCoords[6];
-    FPList<TriangleNode, Triangle2> subdivided;
+    FPList<TriangleNode, Triangle2> subdivided(&_trianglePool);
     
     for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
     {
@@ -1315,7 +1944,7 @@ void Mesh2::detachSelectedTriangles()
                 {
                     if (newVertex == NULL)
                         newVertex = _vertices.add(vertexNode->data());
-                        
+                    
                     triangleNode->data()->replaceVertex(vertexNode, newVertex);
                     vertexNode->_triangles.remove(triangleNode);
                 }
@@ -1325,7 +1954,7 @@ void Mesh2::detachSelectedTriangles()
                 _vertices.remove(vertexNode);
         }
     }
-        
+    
     makeEdges();
     
     setSelectionMode(_selectionMode);
@@ -1338,7 +1967,7 @@ void Mesh2::splitSelectedTriangles()
     VertexNode *v[9];
     TexCoordNode *t[9];
     
-    FPList<TriangleNode, Triangle2> subdivided;
+    FPList<TriangleNode, Triangle2> subdivided(&_trianglePool);
     
     for (VertexEdgeNode *node = _vertexEdges.begin(), *end = _vertexEdges.end(); node != end; node = node->next())
     {
@@ -1406,7 +2035,7 @@ void Mesh2::splitSelectedTriangles()
                 |     |     |
                 |     |     |
                 0----(4)----1
-    
+            
             */
             
             v[8] = _vertices.add((v[7]->data().position + v[5]->data().position) / 2.0f);
@@ -1428,7 +2057,7 @@ void Mesh2::splitSelectedTriangles()
               /  \  /  \
              /____\/____\
              0    *3     1
-             
+            
             */
             
             subdivided.add(makeTriangle(v, t, 0, 3, 5));
@@ -1497,7 +2126,7 @@ void Mesh2::splitSelectedEdges()
                     
                     v[2] = vertexEdge.vertex(k);
                     
-                    if (v[2]->sharedEdge(secondEdge.vertex(0)))
+                    if (sharedEdge(v[2], secondEdge.vertex(0)))
                         v[3] = secondEdge.vertex(0);
                     else
                         v[3] = secondEdge.vertex(1);
@@ -1580,7 +2209,8 @@ void Mesh2::detachSelected()
 void Mesh2::duplicateSelectedTriangles()
 {
     resetTriangleCache();
-    resetAlgorithmData();
+    
+    vector<TriangleNode *> selectedTriangles;
     
     for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
     {
@@ -1589,6 +2219,20 @@ void Mesh2::duplicateSelectedTriangles()
         if (!triQuad.selected)
             continue;
         
+        selectedTriangles.push_back(node);
+        
+        for (uint i = 0; i < triQuad.count(); i++)
+        {
+            triQuad.vertex(i)->algorithmData.clear();
+            triQuad.texCoord(i)->algorithmData.clear();
+        }
+    }
+    
+    for (uint s = 0; s < selectedTriangles.size(); s++)
+    {
+        TriangleNode *node = selectedTriangles[s];
+        Triangle2 &triQuad = node->data();
+        
         VertexNode *duplicatedVertices[4];
         TexCoordNode *duplicatedTexCoords[4];
         
@@ -1601,14 +2245,14 @@ void Mesh2::duplicateSelectedTriangles()
         }
         
         node->data().selected = false;
+        markTriangleSelectionDirty(node);
         
         TriangleNode *newTriangle = _triangles.add(Triangle2(duplicatedVertices, duplicatedTexCoords, triQuad.isQuad()));
         newTriangle->data().selected = true;
+        markTriangleDirty(newTriangle);
     }
-        
-    makeEdges();
     
-    setSelectionMode(_selectionMode);    
+    updateDirtyTopology();
 }
 
 void Mesh2::flipSelectedTriangles()
@@ -1729,7 +2373,7 @@ void Mesh2::extrudeSelectedEdges()
     
     for (uint i = 0; i < extrudedVertices.size(); i += 2)
     {
-        VertexEdgeNode *node = extrudedVertices[i]->sharedEdge(extrudedVertices[i + 1]);
+        VertexEdgeNode *node = sharedEdge(extrudedVertices[i], extrudedVertices[i + 1]);
         node->data().selected = true;
     }
     
@@ -1739,7 +2383,8 @@ void Mesh2::extrudeSelectedEdges()
 void Mesh2::extrudeSelectedTriangles()
 {
     resetTriangleCache();
-    resetAlgorithmData();
+    
+    vector<TriangleNode *> selectedTriangles;
     
     for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
     {
@@ -1748,6 +2393,17 @@ void Mesh2::extrudeSelectedTriangles()
         if (!triQuad.selected)
             continue;
         
+        selectedTriangles.push_back(node);
+        
+        for (uint i = 0; i < triQuad.count(); i++)
+            triQuad.vertex(i)->algorithmData.clear();
+    }
+    
+    for (uint s = 0; s < selectedTriangles.size(); s++)
+    {
+        TriangleNode *node = selectedTriangles[s];
+        Triangle2 &triQuad = node->data();
+        
         for (uint i = 0; i < triQuad.count(); i++)
         {
             VertexEdge &vertexEdge = node->data().vertexEdge(i)->data();
@@ -1763,20 +2419,27 @@ void Mesh2::extrudeSelectedTriangles()
                 VertexNode *extruded0 = duplicateVertex(original0);
                 VertexNode *extruded1 = duplicateVertex(original1);
                 
-                addQuad(original0, original1, extruded1, extruded0);
+                markTriangleDirty(addQuad(original0, original1, extruded1, extruded0));
             }
         }
     }
     
-    for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
+    for (uint s = 0; s < selectedTriangles.size(); s++)
     {
-        if (node->algorithmData.duplicatePair != NULL)
-            node->replaceVertexInSelectedTriangles(node->algorithmData.duplicatePair);
-    }
+        TriangleNode *node = selectedTriangles[s];
+        Triangle2 &triQuad = node->data();
         
-    makeEdges();
+        for (uint i = 0; i < triQuad.count(); i++)
+        {
+            VertexNode *original = triQuad.vertex(i);
+            if (original->algorithmData.duplicatePair != NULL)
+                original->replaceVertexInSelectedTriangles(original->algorithmData.duplicatePair);
+        }
+        
+        markTriangleDirty(node);
+    }
     
-    setSelectionMode(_selectionMode);
+    updateDirtyTopology();
 }
 
 void Mesh2::merge(Mesh2 *mesh)
@@ -8,277 +8,709 @@
 
 #include "Mesh2.h"
 #include "Texture.h"
+#include "ParallelFor.h"
+#include "RenderStatistics.h"
+#include <algorithm>
 
 void Mesh2::resetTriangleCache()
 {
     _cachedTriangleVertices.setValid(false);
+    _cachedTriangleIDs.invalidate();
+    _triangleBVH.setNeedsRefit();
+    _boundsValid = false;
     resetEdgeCache();
 }
 
 void Mesh2::resetEdgeCache()
 {
-    _cachedEdgeVertices.setValid(false);
-    _cachedEdgeTexCoords.setValid(false);
+    _cachedEdgeVertices.invalidate();
+    _cachedEdgeTexCoords.invalidate();
+    _cachedPoints.invalidate();
 }
 
-void Mesh2::fillTriangleCache()
+void Mesh2::resetSelectionCache()
 {
-    if (_cachedTriangleVertices.isValid())
-        return;
-    
-    _cachedTriangleVertices.resize(_triangles.count() * 6);
-    
-    for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
-    {
-        Triangle2 &currentTriangle = node->data();
-        currentTriangle.normalsAreValid = false;
-        currentTriangle.computeNormalsIfNeeded();
-    }
-    
-    for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
-    {
-        node->resetCacheIndices();
-        node->computeNormal();
-    }
+    // triangle vertices are shared by color, so they need a rebuild
+    _cachedTriangleVertices.setValid(false);
+    _cachedEdgeVertices.invalidateColors();
+    _cachedEdgeTexCoords.invalidateColors();
+    _cachedPoints.invalidateColors();
+}
+
+// work below this size per thread is not worth starting threads for
+const uint CacheMinimumRange = 2048;
+
+static unsigned char PackColorComponent(float value)
+{
+    return (unsigned char)(max(0.0f, min(1.0f, value)) * 255.0f + 0.5f);
+}
+
+static void PackColor(const Vector3D &color, PackedColor &packed)
+{
+    for (uint k = 0; k < 3; k++)
+        packed.coords[k] = PackColorComponent(color[k]);
+    packed.coords[3] = 0;
+}
+
+static void PackNormal(const Vector3D &normal, PackedNormal &packed)
+{
+    float length = normal.GetLength();
+    float scale = length > 0.0f ? 32767.0f / length : 0.0f;
     
-    for (TexCoordNode *node = _texCoords.begin(), *end = _texCoords.end(); node != end; node = node->next())
-    {
-        node->computeNormal();
-    }
+    for (uint k = 0; k < 3; k++)
+        packed.coords[k] = (short)floorf(max(-32767.0f, min(32767.0f, normal[k] * scale)) + 0.5f);
+    packed.coords[3] = 0;
+}
 
-    float weightedComponents[] = { 0.0f, 0.0f, 0.0f };
-    const float selectedComponents[] = { 0.7f, 0.0f, 0.0f };
-    const uint *twoTriIndices = Triangle2::twoTriIndices;
-    uint i = 0;
+// Builds shared vertices and triangle indices from the vertex side, every
+// cached vertex and index belongs to one vertex, so ranges never overlap.
+struct TriangleCacheBuilder
+{
+    const vector<VertexNode *> &vertices;
+    vector<uint> &vertexOffsets;
+    GLTriangleVertex *cachedVertices;
+    uint *cachedIndices;
+    const float *colorComponents;
+    bool useSoftSelection;
+    float minimumSelectionWeight;
+    bool isUnwrapped;
     
-    for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
+    TriangleCacheBuilder(const vector<VertexNode *> &vertices, vector<uint> &vertexOffsets) :
+        vertices(vertices), vertexOffsets(vertexOffsets), cachedVertices(NULL), cachedIndices(NULL) { }
+    
+    uint color(TriangleNode *node) const
     {
-        Triangle2 &currentTriangle = node->data();
-
-        if (!currentTriangle.visible)
-            continue;
+        const float selectedComponents[] = { 0.7f, 0.0f, 0.0f };
+        float weightedComponents[] = { 1.0f, 0.0f, 0.0f };
         
         const float *c;
-        if (_useSoftSelection)
+        if (useSoftSelection)
         {
-            if (node->selectionWeight > _minimumSelectionWeight)
+            if (node->selectionWeight > minimumSelectionWeight)
             {
-                weightedComponents[0] = 1.0f;
                 weightedComponents[1] = 1.0f - node->selectionWeight;
                 c = weightedComponents;
             }
             else
             {
-                c = _colorComponents;
+                c = colorComponents;
             }
         }
         else
         {
-            if (currentTriangle.selected)
+            if (node->data().selected)
                 c = selectedComponents;
             else
-                c = _colorComponents;
+                c = colorComponents;
         }
         
-        Vector3D fn = _isUnwrapped ? currentTriangle.texCoordNormal : currentTriangle.vertexNormal;
-        
-        uint vertexCount = currentTriangle.isQuad() ? 6 : 3;
+        return PackColorComponent(c[0]) | (PackColorComponent(c[1]) << 8) | (PackColorComponent(c[2]) << 16);
+    }
+    
+    // first pass, corners of a vertex with the same texture coordinate and
+    // color share one cached vertex, cacheIndex is local to the vertex
+    void countVertices(uint first, uint last)
+    {
+        vector<TexCoordNode *> texCoords;
+        vector<uint> colors;
         
-        for (uint j = 0; j < vertexCount; j++)
+        for (uint i = first; i < last; i++)
         {
-            uint twoTriIndex = twoTriIndices[j];
-            VertexNode *vertex = currentTriangle.vertex(twoTriIndex);
-            TexCoordNode *texCoord = currentTriangle.texCoord(twoTriIndex);
-
-            const Vector3D &v = vertex->data().position;
-            const Vector3D &t = texCoord->data().position;
-            
-            const Vector3D &sn = _isUnwrapped ? texCoord->algorithmData.normal : vertex->algorithmData.normal;;
+            VertexNode *vertex = vertices[i];
+            vertex->computeNormal();
             
-            GLTriangleVertex &cachedVertex = _cachedTriangleVertices[i];
-            vertex->setCacheIndexForTriangleNode(node, i, j < 3 ? 0 : 1);
+            texCoords.clear();
+            colors.clear();
             
-            for (uint k = 0; k < 3; k++)
+            for (VertexTriangleNode *node = vertex->_triangles.begin(), *end = vertex->_triangles.end(); node != end; node = node->next())
             {
-                cachedVertex.position.coords[k] = v[k];
-                cachedVertex.texCoord.coords[k] = t[k];
-                cachedVertex.flatNormal.coords[k] = fn[k];
-                cachedVertex.smoothNormal.coords[k] = sn[k];
-                cachedVertex.color.coords[k] = c[k];
+                TriangleNode *triangleNode = node->data();
+                node->cacheIndex = -1;
+                
+                if (triangleNode->cacheIndex < 0)
+                    continue;
+                
+                const Triangle2 &triangle = triangleNode->data();
+                TexCoordNode *texCoord = triangle.texCoord(triangle.indexOfVertex(vertex));
+                uint c = color(triangleNode);
+                
+                uint j = 0;
+                while (j < texCoords.size() && (texCoords[j] != texCoord || colors[j] != c))
+                    j++;
+                
+                if (j == texCoords.size())
+                {
+                    texCoords.push_back(texCoord);
+                    colors.push_back(c);
+                }
+                
+                node->cacheIndex = (int)j;
             }
             
-            i++;
+            vertexOffsets[i] = texCoords.size();
         }
     }
     
-    _cachedTriangleVertices.resize(i);
+    // second pass, vertexOffsets hold the first cached vertex of each vertex
+    void fillVertices(uint first, uint last)
+    {
+        const uint *twoTriIndices = Triangle2::twoTriIndices;
+        
+        for (uint i = first; i < last; i++)
+        {
+            VertexNode *vertex = vertices[i];
+            uint offset = vertexOffsets[i];
+            uint filledCount = 0;
+            
+            for (VertexTriangleNode *node = vertex->_triangles.begin(), *end = vertex->_triangles.end(); node != end; node = node->next())
+            {
+                if (node->cacheIndex < 0)
+                    continue;
+                
+                TriangleNode *triangleNode = node->data();
+                const Triangle2 &triangle = triangleNode->data();
+                uint cacheIndex = offset + (uint)node->cacheIndex;
+                node->cacheIndex = (int)cacheIndex;
+                
+                // local indices are handed out in order, so a new one is always the next
+                if (cacheIndex == offset + filledCount)
+                {
+                    TexCoordNode *texCoord = triangle.texCoord(triangle.indexOfVertex(vertex));
+                    
+                    const Vector3D &v = vertex->data().position;
+                    const Vector3D &t = texCoord->data().position;
+                    const Vector3D &sn = isUnwrapped ? texCoord->algorithmData.normal : vertex->algorithmData.normal;
+                    uint c = color(triangleNode);
+                    
+                    GLTriangleVertex &cachedVertex = cachedVertices[cacheIndex];
+                    
+                    for (uint k = 0; k < 3; k++)
+                    {
+                        cachedVertex.position.coords[k] = v[k];
+                        cachedVertex.color.coords[k] = (unsigned char)(c >> (8 * k));
+                    }
+                    cachedVertex.color.coords[3] = 255;
+                    PackNormal(sn, cachedVertex.smoothNormal);
+                    cachedVertex.texCoord.coords[0] = t.x;
+                    cachedVertex.texCoord.coords[1] = t.y;
+                    
+                    filledCount++;
+                }
+                
+                // every corner of this vertex, triangles with repeated vertices included
+                uint indexCount = triangle.isQuad() ? 6 : 3;
+                
+                for (uint j = 0; j < indexCount; j++)
+                {
+                    if (triangle.vertex(twoTriIndices[j]) == vertex)
+                        cachedIndices[triangleNode->cacheIndex + j] = cacheIndex;
+                }
+            }
+        }
+    }
+};
+
+struct CountVerticesBody
+{
+    TriangleCacheBuilder &cache;
+    CountVerticesBody(TriangleCacheBuilder &cache) : cache(cache) { }
+    void operator()(uint first, uint last) { cache.countVertices(first, last); }
+};
+
+struct FillVerticesBody
+{
+    TriangleCacheBuilder &cache;
+    FillVerticesBody(TriangleCacheBuilder &cache) : cache(cache) { }
+    void operator()(uint first, uint last) { cache.fillVertices(first, last); }
+};
+
+void Mesh2::fillTriangleCache()
+{
+    if (_cachedTriangleVertices.isValid())
+        return;
+    
+    RENDER_STATISTICS_SCOPE(RenderPhase::CacheFill);
+    
+    // every visible triangle gets its first index
+    uint indexCount = 0;
+    
+    for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
+    {
+        Triangle2 &currentTriangle = node->data();
+        currentTriangle.normalsAreValid = false;
+        currentTriangle.computeNormalsIfNeeded();
+        
+        if (currentTriangle.visible)
+        {
+            node->cacheIndex = (int)indexCount;
+            indexCount += currentTriangle.isQuad() ? 6 : 3;
+        }
+        else
+        {
+            node->cacheIndex = -1;
+        }
+    }
+    
+    for (TexCoordNode *node = _texCoords.begin(), *end = _texCoords.end(); node != end; node = node->next())
+    {
+        node->computeNormal();
+    }
+    
+    vector<VertexNode *> vertices;
+    vertices.reserve(_vertices.count());
+    for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
+        vertices.push_back(node);
+    
+    vector<uint> vertexOffsets(vertices.size());
+    
+    TriangleCacheBuilder cache(vertices, vertexOffsets);
+    cache.colorComponents = _colorComponents;
+    cache.useSoftSelection = _useSoftSelection;
+    cache.minimumSelectionWeight = _minimumSelectionWeight;
+    cache.isUnwrapped = _isUnwrapped;
+    
+    CountVerticesBody countVertices(cache);
+    ParallelFor(vertices.size(), CacheMinimumRange, countVertices);
+    
+    uint vertexCount = 0;
+    for (uint i = 0; i < vertexOffsets.size(); i++)
+    {
+        uint count = vertexOffsets[i];
+        vertexOffsets[i] = vertexCount;
+        vertexCount += count;
+    }
+    
+    _cachedTriangleVertices.resize(vertexCount);
+    _cachedTriangleIndices.resize(indexCount);
+    
+    cache.cachedVertices = _cachedTriangleVertices;
+    cache.cachedIndices = _cachedTriangleIndices;
+    
+    FillVerticesBody fillVertices(cache);
+    ParallelFor(vertices.size(), CacheMinimumRange, fillVertices);
+    
     _cachedTriangleVertices.setValid(true);
+    _cachedTriangleIndices.setValid(true);
+    _dirtyTriangleCacheIndices.clear();
+    
+    uploadTriangleCache();
+}
 
+void Mesh2::uploadTriangleCache()
+{
 #if defined(__APPLE__) || defined(SHADERS)
+    RENDER_STATISTICS_SCOPE(RenderPhase::Upload);
+    
     if (!_vboGenerated)
     {
         glGenBuffers(1, &_vboID);
+        glGenBuffers(1, &_iboID);
         _vboGenerated = true;
     }
-
+    
     glBindBuffer(GL_ARRAY_BUFFER, _vboID);
     glBufferData(GL_ARRAY_BUFFER, _cachedTriangleVertices.count() * sizeof(GLTriangleVertex), _cachedTriangleVertices, GL_DYNAMIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _iboID);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, _cachedTriangleIndices.count() * sizeof(uint), _cachedTriangleIndices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 #endif
 }
 
-void Mesh2::fillEdgeCache()
+void Mesh2::fillTriangleIDCache()
 {
-    if (_cachedEdgeVertices.isValid() && _cachedEdgeTexCoords.isValid())
+    if (_cachedTriangleIDsUnwrapped != _isUnwrapped)
+    {
+        _cachedTriangleIDs.invalidate();
+        _cachedTriangleIDsUnwrapped = _isUnwrapped;
+    }
+    
+    if (_cachedTriangleIDs.isValid())
         return;
     
-    _cachedEdgeVertices.resize(_vertexEdges.count() * 2);
-    _cachedEdgeTexCoords.resize(_texCoordEdges.count() * 2);
+    RENDER_STATISTICS_SCOPE(RenderPhase::CacheFill);
     
-    Vector3D selectedColor(0.8f, 0.0f, 0.0f);
-    Vector3D normalColor(_colorComponents[0] - 0.2f, _colorComponents[1] - 0.2f, _colorComponents[2] - 0.2f);
+    // quads are split into two triangles
+    _cachedTriangleIDs.resize(_triangles.count() * 6);
     
+    Point3D *positions = _cachedTriangleIDs.positions();
+    vector<uint> &colorIndices = _cachedTriangleIDs.colorIndices();
+    const uint quadCorners[6] = { 0, 1, 2, 0, 2, 3 };
     uint i = 0;
+    uint colorIndex = 0;
     
-    for (VertexEdgeNode *node = _vertexEdges.begin(), *end = _vertexEdges.end(); node != end; node = node->next())
+    for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
     {
-        if (!node->data().visible)
+        colorIndex++;
+        
+        const Triangle2 &triangle = node->data();
+        
+        if (!triangle.visible)
             continue;
         
-        if (_useSoftSelection)
+        uint cornerCount = triangle.isQuad() ? 6 : 3;
+        
+        for (uint j = 0; j < cornerCount; j++)
+        {
+            uint corner = quadCorners[j];
+            
+            const Vector3D &v = _isUnwrapped ? triangle.texCoord(corner)->data().position : triangle.vertex(corner)->data().position;
+            
+            for (uint k = 0; k < 3; k++)
+                positions[i].coords[k] = v[k];
+            
+            colorIndices.push_back(colorIndex);
+            i++;
+        }
+    }
+    
+    _cachedTriangleIDs.resize(i); // resize doesn't delete [] internal array, if not needed
+    _cachedTriangleIDs.setValid();
+}
+
+void Mesh2::fillEdgeCache()
+{
+    RENDER_STATISTICS_SCOPE(RenderPhase::CacheFill);
+    
+    if (!_cachedEdgeVertices.isValid())
+    {
+        _cachedEdgeVertices.resize(_vertexEdges.count() * 2);
+        
+        Point3D *positions = _cachedEdgeVertices.positions();
+        vector<uint> &colorIndices = _cachedEdgeVertices.colorIndices();
+        uint i = 0;
+        uint colorIndex = 0;
+        
+        for (VertexEdgeNode *node = _vertexEdges.begin(), *end = _vertexEdges.end(); node != end; node = node->next())
         {
-            if (node->selectionWeight > _minimumSelectionWeight)
+            colorIndex++;
+            
+            VertexNode *v0 = node->data().vertex(0);
+            VertexNode *v1 = node->data().vertex(1);
+            
+            if (!node->data().visible)
             {
-                Vector3D softSelectedColor = Vector3D(1.0f, 1.0f - node->selectionWeight, 0.0f);
-                
-                for (uint k = 0; k < 3; k++)
-                {
-                    _cachedEdgeVertices[i].color.coords[k] = softSelectedColor[k];
-                    _cachedEdgeVertices[i + 1].color.coords[k] = softSelectedColor[k];
-                }
+                v0->setCacheIndexForEdgeNode(node, -1);
+                v1->setCacheIndexForEdgeNode(node, -1);
+                continue;
             }
-            else
+            
+            v0->setCacheIndexForEdgeNode(node, i);
+            v1->setCacheIndexForEdgeNode(node, i + 1);
+            
+            for (uint k = 0; k < 3; k++)
             {
-                for (uint k = 0; k < 3; k++)
-                {
-                    _cachedEdgeVertices[i].color.coords[k] = normalColor[k];
-                    _cachedEdgeVertices[i + 1].color.coords[k] = normalColor[k];
-                }
+                positions[i].coords[k] = v0->data().position[k];
+                positions[i + 1].coords[k] = v1->data().position[k];
             }
+            
+            colorIndices.push_back(colorIndex);
+            colorIndices.push_back(colorIndex);
+            
+            i += 2;
         }
-        else
+        
+        _cachedEdgeVertices.resize(i); // resize doesn't delete [] internal array, if not needed
+        _cachedEdgeVertices.setValid();
+    }
+    
+    if (!_cachedEdgeTexCoords.isValid())
+    {
+        _cachedEdgeTexCoords.resize(_texCoordEdges.count() * 2);
+        
+        Point3D *positions = _cachedEdgeTexCoords.positions();
+        vector<uint> &colorIndices = _cachedEdgeTexCoords.colorIndices();
+        uint i = 0;
+        uint colorIndex = 0;
+        
+        for (TexCoordEdgeNode *node = _texCoordEdges.begin(), *end = _texCoordEdges.end(); node != end; node = node->next())
         {
-            if (node->data().selected)
+            colorIndex++;
+            
+            if (!node->data().visible)
+                continue;
+            
+            for (uint k = 0; k < 3; k++)
             {
-                for (uint k = 0; k < 3; k++)
-                {
-                    _cachedEdgeVertices[i].color.coords[k] = selectedColor[k];
-                    _cachedEdgeVertices[i + 1].color.coords[k] = selectedColor[k];
-                }
-            }
-            else
-            {
-                for (uint k = 0; k < 3; k++)
-                {
-                    _cachedEdgeVertices[i].color.coords[k] = normalColor[k];
-                    _cachedEdgeVertices[i + 1].color.coords[k] = normalColor[k];
-                }
+                positions[i].coords[k] = node->data().texCoord(0)->data().position[k];
+                positions[i + 1].coords[k] = node->data().texCoord(1)->data().position[k];
             }
+            
+            colorIndices.push_back(colorIndex);
+            colorIndices.push_back(colorIndex);
+            
+            i += 2;
         }
         
-        VertexNode *v0 = node->data().vertex(0);
-        VertexNode *v1 = node->data().vertex(1);
+        _cachedEdgeTexCoords.resize(i); // resize doesn't delete [] internal array, if not needed
+        _cachedEdgeTexCoords.setValid();
+    }
+    
+    Vector3D selectedColor(0.8f, 0.0f, 0.0f);
+    Vector3D normalColor(_colorComponents[0] - 0.2f, _colorComponents[1] - 0.2f, _colorComponents[2] - 0.2f);
+    
+    PackedColor selectedPacked, normalPacked;
+    PackColor(selectedColor, selectedPacked);
+    PackColor(normalColor, normalPacked);
+    
+    if (!_cachedEdgeVertices.areColorsValid())
+    {
+        _cachedEdgeVertices.resizeColors();
         
-        v0->setCacheIndexForEdgeNode(node, i);
-        v1->setCacheIndexForEdgeNode(node, i + 1);
+        PackedColor *colors = _cachedEdgeVertices.colors();
+        uint i = 0;
         
-        for (uint k = 0; k < 3; k++)
+        for (VertexEdgeNode *node = _vertexEdges.begin(), *end = _vertexEdges.end(); node != end; node = node->next())
         {
-            _cachedEdgeVertices[i].position.coords[k] = v0->data().position[k];
-            _cachedEdgeVertices[i + 1].position.coords[k] = v1->data().position[k];
+            if (!node->data().visible)
+                continue;
+            
+            if (_useSoftSelection && node->selectionWeight > _minimumSelectionWeight)
+                PackColor(Vector3D(1.0f, 1.0f - node->selectionWeight, 0.0f), colors[i]);
+            else if (!_useSoftSelection && node->data().selected)
+                colors[i] = selectedPacked;
+            else
+                colors[i] = normalPacked;
+            
+            colors[i + 1] = colors[i];
+            i += 2;
         }
         
-        i += 2;
+        _cachedEdgeVertices.setColorsValid();
     }
     
-    _cachedEdgeVertices.resize(i); // resize doesn't delete [] internal array, if not needed
-    _cachedEdgeVertices.setValid(true);
+    if (!_cachedEdgeTexCoords.areColorsValid())
+    {
+        _cachedEdgeTexCoords.resizeColors();
+        
+        PackedColor *colors = _cachedEdgeTexCoords.colors();
+        uint i = 0;
+        
+        for (TexCoordEdgeNode *node = _texCoordEdges.begin(), *end = _texCoordEdges.end(); node != end; node = node->next())
+        {
+            if (!node->data().visible)
+                continue;
+            
+            if (node->data().selected)
+                colors[i] = selectedPacked;
+            else
+                colors[i] = normalPacked;
+            
+            colors[i + 1] = colors[i];
+            i += 2;
+        }
+        
+        _cachedEdgeTexCoords.setColorsValid();
+    }
+}
+
+template <class T>
+static void FillPointPositions(FPList<VNode<T>, T> &nodes, ColoredVertexBuffer &cachedPoints)
+{
+    cachedPoints.resize(nodes.count());
     
-    i = 0;
+    Point3D *positions = cachedPoints.positions();
+    vector<uint> &colorIndices = cachedPoints.colorIndices();
+    uint i = 0;
+    uint colorIndex = 0;
     
-    for (TexCoordEdgeNode *node = _texCoordEdges.begin(), *end = _texCoordEdges.end(); node != end; node = node->next())
+    for (VNode<T> *node = nodes.begin(), *end = nodes.end(); node != end; node = node->next())
     {
+        colorIndex++;
+        
         if (!node->data().visible)
+        {
+            node->pointCacheIndex = -1;
             continue;
+        }
+        
+        node->pointCacheIndex = i;
+        
+        for (uint k = 0; k < 3; k++)
+            positions[i].coords[k] = node->data().position[k];
         
-        if (node->data().selected)
+        colorIndices.push_back(colorIndex);
+        i++;
+    }
+    
+    cachedPoints.resize(i); // resize doesn't delete [] internal array, if not needed
+    cachedPoints.setValid();
+}
+
+void Mesh2::fillPointCache()
+{
+    if (_cachedPointsUnwrapped != _isUnwrapped)
+    {
+        _cachedPoints.invalidate();
+        _cachedPointsUnwrapped = _isUnwrapped;
+    }
+    
+    RENDER_STATISTICS_SCOPE(RenderPhase::CacheFill);
+    
+    if (!_cachedPoints.isValid())
+    {
+        if (_isUnwrapped)
+            FillPointPositions(_texCoords, _cachedPoints);
+        else
+            FillPointPositions(_vertices, _cachedPoints);
+    }
+    
+    if (_cachedPoints.areColorsValid())
+        return;
+    
+    _cachedPoints.resizeColors();
+    
+    PackedColor *colors = _cachedPoints.colors();
+    uint i = 0;
+    
+    PackedColor selectedPacked, normalPacked;
+    PackColor(Vector3D(1.0f, 0.0f, 0.0f), selectedPacked);
+    PackColor(Vector3D(0.0f, 0.0f, 1.0f), normalPacked);
+    
+    if (_isUnwrapped)
+    {
+        for (TexCoordNode *node = _texCoords.begin(), *end = _texCoords.end(); node != end; node = node->next())
         {
-            for (uint k = 0; k < 3; k++)
-            {
-                _cachedEdgeTexCoords[i].color.coords[k] = selectedColor[k];
-                _cachedEdgeTexCoords[i + 1].color.coords[k] = selectedColor[k];
-            }
+            if (!node->data().visible)
+                continue;
+            
+            colors[i++] = node->data().selected ? selectedPacked : normalPacked;
         }
-        else
+    }
+    else
+    {
+        for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
         {
-            for (uint k = 0; k < 3; k++)
-            {
-                _cachedEdgeTexCoords[i].color.coords[k] = normalColor[k];
-                _cachedEdgeTexCoords[i + 1].color.coords[k] = normalColor[k];
-            }
+            if (!node->data().visible)
+                continue;
+            
+            if (_useSoftSelection && node->selectionWeight > _minimumSelectionWeight)
+                PackColor(Vector3D(1.0f, 1.0f - node->selectionWeight, 0.0f), colors[i]);
+            else if (!_useSoftSelection && node->data().selected)
+                colors[i] = selectedPacked;
+            else
+                colors[i] = normalPacked;
+            
+            i++;
         }
+    }
+    
+    _cachedPoints.setColorsValid();
+}
+
+static void expandBounds(Vector3D &minimum, Vector3D &maximum, const Vector3D &v)
+{
+    for (uint i = 0; i < 3; i++)
+    {
+        minimum[i] = min(minimum[i], v[i]);
+        maximum[i] = max(maximum[i], v[i]);
+    }
+}
+
+void Mesh2::getBounds(Vector3D &minimum, Vector3D &maximum)
+{
+    if (!_boundsValid)
+    {
+        VertexNode *node = _vertices.begin(), *end = _vertices.end();
         
-        for (uint k = 0; k < 3; k++)
+        if (node == end)
+        {
+            _boundsMinimum = Vector3D();
+            _boundsMaximum = Vector3D();
+        }
+        else
         {
-            _cachedEdgeTexCoords[i].position.coords[k] = node->data().texCoord(0)->data().position[k];
-            _cachedEdgeTexCoords[i + 1].position.coords[k] = node->data().texCoord(1)->data().position[k];
+            _boundsMinimum = node->data().position;
+            _boundsMaximum = node->data().position;
+            
+            for (node = node->next(); node != end; node = node->next())
+                expandBounds(_boundsMinimum, _boundsMaximum, node->data().position);
         }
         
-        i += 2;
+        _boundsValid = true;
     }
     
-    _cachedEdgeTexCoords.resize(i); // resize doesn't delete [] internal array, if not needed
-    _cachedEdgeTexCoords.setValid(true);
+    minimum = _boundsMinimum;
+    maximum = _boundsMaximum;
 }
 
-void Mesh2::updateVertexInTriangleCache(VertexNode *vertexNode, VertexTriangleNode *triangleNode, uint cacheIndexPosition)
+void Mesh2::updateVertexInTriangleCache(VertexNode *vertexNode, VertexTriangleNode *triangleNode)
 {
-    int cacheIndex = triangleNode->cacheIndices[cacheIndexPosition];
+    int cacheIndex = triangleNode->cacheIndex;
     if (cacheIndex < 0)
         return;
     
     const Vector3D &v = vertexNode->data().position;
-	const Vector3D &sn = vertexNode->algorithmData.normal;
-    const Vector3D &fn = triangleNode->data()->data().vertexNormal;
     
     GLTriangleVertex &cachedVertex = _cachedTriangleVertices[cacheIndex];
     
     for (uint k = 0; k < 3; k++)
     {
         cachedVertex.position.coords[k] = v[k];
-        cachedVertex.smoothNormal.coords[k] = sn[k];
-        cachedVertex.flatNormal.coords[k] = fn[k];
     }
+    
+    PackNormal(vertexNode->algorithmData.normal, cachedVertex.smoothNormal);
+    
+    _dirtyTriangleCacheIndices.push_back((uint)cacheIndex);
 }
 
-void Mesh2::updateVertexInEdgeCache(VertexNode *vertexNode, Vertex2VEdgeNode *edgeNode)
+void Mesh2::uploadDirtyTriangleCache()
 {
-    int cacheIndex = edgeNode->cacheIndex;
-    if (cacheIndex < 0)
+#if defined(__APPLE__) || defined(SHADERS)
+    RENDER_STATISTICS_SCOPE(RenderPhase::Upload);
+    
+    vector<uint> &dirty = _dirtyTriangleCacheIndices;
+    
+    if (dirty.empty() || !_cachedTriangleVertices.isValid() || !_vboGenerated)
+    {
+        dirty.clear();
         return;
+    }
     
-    const Vector3D &v = vertexNode->data().position;
+    vector<uint> ranges;
+    uint dirtyCount = MergeDirtyRanges(dirty, ranges);
     
-    GLEdgeVertex &cachedVertex = _cachedEdgeVertices[cacheIndex];
+    uint count = _cachedTriangleVertices.count();
+    GLTriangleVertex *cachedVertices = _cachedTriangleVertices;
     
-    for (uint k = 0; k < 3; k++)
+    glBindBuffer(GL_ARRAY_BUFFER, _vboID);
+    
+    if (dirtyCount > count / 2)
     {
-        cachedVertex.position.coords[k] = v[k];
+        // orphan the old storage, so the driver does not wait for draws using it
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(GLTriangleVertex), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(GLTriangleVertex), cachedVertices);
     }
+    else
+    {
+        for (uint i = 0; i < ranges.size(); i += 2)
+        {
+            uint first = ranges[i];
+            uint rangeCount = ranges[i + 1] - first;
+            glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(GLTriangleVertex), rangeCount * sizeof(GLTriangleVertex), cachedVertices + first);
+        }
+    }
+    
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+    _dirtyTriangleCacheIndices.clear();
+}
+
+void Mesh2::updateVertexInEdgeCache(VertexNode *vertexNode, Vertex2VEdgeNode *edgeNode)
+{
+    int cacheIndex = edgeNode->cacheIndex;
+    if (cacheIndex < 0)
+        return;
+    
+    _cachedEdgeVertices.updatePosition(cacheIndex, vertexNode->data().position);
 }
 
 void Mesh2::updateTriangleAndEdgeCache(vector<VertexNode *> &affectedVertices)
 {
+    _triangleBVH.setNeedsRefit();
+    _cachedTriangleIDs.invalidate();
+    
     uint count = affectedVertices.size();
     
     if (count > vertexCount() / 3)
@@ -291,6 +723,10 @@ void Mesh2::updateTriangleAndEdgeCache(vector<VertexNode *> &affectedVertices)
     {
         VertexNode *vertexNode = affectedVertices[i];
         vertexNode->addAffectedVertices(affectedVertices);
+        
+        // moved vertices only grow the box, it stays valid for culling
+        if (_boundsValid)
+            expandBounds(_boundsMinimum, _boundsMaximum, vertexNode->data().position);
     }
     
     count = affectedVertices.size();
@@ -312,9 +748,7 @@ void Mesh2::updateTriangleAndEdgeCache(vector<VertexNode *> &affectedVertices)
              triangleNode != triangleEnd;
              triangleNode = triangleNode->next())
         {
-            updateVertexInTriangleCache(vertexNode, triangleNode, 0);
-            if (triangleNode->data()->data().isQuad())
-                updateVertexInTriangleCache(vertexNode, triangleNode, 1);
+            updateVertexInTriangleCache(vertexNode, triangleNode);
         }
         
         for (Vertex2VEdgeNode
@@ -325,16 +759,18 @@ void Mesh2::updateTriangleAndEdgeCache(vector<VertexNode *> &affectedVertices)
         {
             updateVertexInEdgeCache(vertexNode, edgeNode);
         }
+        
+        if (vertexNode->pointCacheIndex >= 0 && !_cachedPointsUnwrapped)
+            _cachedPoints.updatePosition(vertexNode->pointCacheIndex, vertexNode->data().position);
     }
-#if defined(__APPLE__) || defined(SHADERS)
-    glBindBuffer(GL_ARRAY_BUFFER, _vboID);
-    glBufferData(GL_ARRAY_BUFFER, _cachedTriangleVertices.count() * sizeof(GLTriangleVertex), _cachedTriangleVertices, GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-#endif
+    
+    uploadDirtyTriangleCache();
 }
 
 void Mesh2::drawFill(FillMode fillMode, ViewMode viewMode)
 {
+    RENDER_STATISTICS_SCOPE(RenderPhase::Draw);
+    
     fillTriangleCache();
 #if defined(__APPLE__) || defined(SHADERS)
     if (viewMode == ViewMode::MixedWireSolid)
@@ -348,6 +784,7 @@ void Mesh2::drawFill(FillMode fillMode, ViewMode viewMode)
     }
     
     glBindBuffer(GL_ARRAY_BUFFER, _vboID);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _iboID);
     
     glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
@@ -358,23 +795,21 @@ void Mesh2::drawFill(FillMode fillMode, ViewMode viewMode)
     if (fillMode.colored)
     {
         glEnableClientState(GL_COLOR_ARRAY);
-        glColorPointer(3, GL_FLOAT, sizeof(GLTriangleVertex), (void *)offsetof(GLTriangleVertex, color));
+        glColorPointer(3, GL_UNSIGNED_BYTE, sizeof(GLTriangleVertex), (void *)offsetof(GLTriangleVertex, color));
     }
     
-    if (viewMode == ViewMode::SolidSmooth)
-        glNormalPointer(GL_FLOAT, sizeof(GLTriangleVertex), (void *)offsetof(GLTriangleVertex, smoothNormal));
-    else
-        glNormalPointer(GL_FLOAT, sizeof(GLTriangleVertex), (void *)offsetof(GLTriangleVertex, flatNormal));
+    // flat normals come from the shader, see flatShading uniform
+    glNormalPointer(GL_SHORT, sizeof(GLTriangleVertex), (void *)offsetof(GLTriangleVertex, smoothNormal));
     
     if (fillMode.textured && _texture != NULL)
         glTexCoordPointer(2, GL_FLOAT, sizeof(GLTriangleVertex), (void *)offsetof(GLTriangleVertex, texCoord));
     
     if (viewMode == ViewMode::Unwrap)
-        glVertexPointer(3, GL_FLOAT, sizeof(GLTriangleVertex), (void *)offsetof(GLTriangleVertex, texCoord));
+        glVertexPointer(2, GL_FLOAT, sizeof(GLTriangleVertex), (void *)offsetof(GLTriangleVertex, texCoord));
     else
         glVertexPointer(3, GL_FLOAT, sizeof(GLTriangleVertex), (void *)offsetof(GLTriangleVertex, position));
     
-    glDrawArrays(GL_TRIANGLES, 0, (int)_cachedTriangleVertices.count());
+    glDrawElements(GL_TRIANGLES, (int)_cachedTriangleIndices.count(), GL_UNSIGNED_INT, NULL);
     
     if (fillMode.colored)
         glDisableClientState(GL_COLOR_ARRAY);
@@ -385,6 +820,7 @@ void Mesh2::drawFill(FillMode fillMode, ViewMode viewMode)
     glDisableClientState(GL_NORMAL_ARRAY);
     glDisableClientState(GL_VERTEX_ARRAY);
     
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     
     if (fillMode.textured && _texture != NULL)
@@ -399,9 +835,9 @@ void Mesh2::drawFill(FillMode fillMode, ViewMode viewMode)
 	if (!fillMode.colored && !fillMode.textured)
 	{
 		glBegin(GL_TRIANGLES);
-		for (uint i = 0; i < _cachedTriangleVertices.count(); i++)
+		for (uint i = 0; i < _cachedTriangleIndices.count(); i++)
 		{
-			glVertex3fv(_cachedTriangleVertices[i].position.coords);
+			glVertex3fv(_cachedTriangleVertices[_cachedTriangleIndices[i]].position.coords);
 		}
 		glEnd();
 	}
@@ -410,12 +846,29 @@ void Mesh2::drawFill(FillMode fillMode, ViewMode viewMode)
 		glEnable(GL_LIGHTING);
 		glEnable(GL_LIGHT0);
 
+		// the cache keeps only smooth normals, flat ones are computed here
+		// for each triangle like the shader does from its derivatives
+		bool flat = viewMode != ViewMode::SolidSmooth;
+
 		glBegin(GL_TRIANGLES);
-		for (uint i = 0; i < _cachedTriangleVertices.count(); i++)
+		for (uint i = 0; i < _cachedTriangleIndices.count(); i++)
 		{
-			glColor3fv(_cachedTriangleVertices[i].color.coords);
-			glNormal3fv(_cachedTriangleVertices[i].smoothNormal.coords);
-			glVertex3fv(_cachedTriangleVertices[i].position.coords);
+			const GLTriangleVertex &cachedVertex = _cachedTriangleVertices[_cachedTriangleIndices[i]];
+			if (flat && i % 3 == 0)
+			{
+				Vector3D v0(cachedVertex.position.coords);
+				Vector3D v1(_cachedTriangleVertices[_cachedTriangleIndices[i + 1]].position.coords);
+				Vector3D v2(_cachedTriangleVertices[_cachedTriangleIndices[i + 2]].position.coords);
+				Vector3D normal = (v0 - v1).Cross(v1 - v2);
+				float length = normal.GetLength();
+				if (length > 0.0f)
+					normal *= 1.0f / length;
+				glNormal3f(normal.x, normal.y, normal.z);
+			}
+			glColor3ubv(cachedVertex.color.coords);
+			if (!flat)
+				glNormal3sv(cachedVertex.smoothNormal.coords);
+			glVertex3fv(cachedVertex.position.coords);
 		}
 		glEnd();
 
@@ -443,9 +896,9 @@ void Mesh2::draw(ViewMode viewMode, const Vector3D &scale, bool selected, bool f
         else
             glCullFace(GL_FRONT);
     }   
-	
+    
     FillMode fillMode;
-	
+
 	glPushMatrix();
 	glScalef(scale.x, scale.y, scale.z);
 	if (viewMode == ViewMode::Wireframe)
@@ -464,7 +917,7 @@ void Mesh2::draw(ViewMode viewMode, const Vector3D &scale, bool selected, bool f
         {
             glEnable(GL_POLYGON_OFFSET_FILL);
             glPolygonOffset(1.0f, 1.0f);
-
+        
         }
 #if defined(__APPLE__) || defined(SHADERS)
         if (_texture != NULL)
@@ -473,6 +926,9 @@ void Mesh2::draw(ViewMode viewMode, const Vector3D &scale, bool selected, bool f
             glUniform1i(textureLocation, 0);
         }
         shader->useProgram();
+        
+        GLint flatShadingLocation = glGetUniformLocation(shader->program, "flatShading");
+        glUniform1i(flatShadingLocation, viewMode == ViewMode::SolidSmooth ? 0 : 1);
 #endif        
         if (_selectionMode != MeshSelectionMode::Triangles)
         {
@@ -540,7 +996,7 @@ void Mesh2::drawAtIndex(uint index, bool forSelection, ViewMode viewMode)
                 selected = vertex.selected;
                 v = vertex.position;
             }
-            
+
 			if (!forSelection)
 			{
 				glPointSize(4.0f);
@@ -561,7 +1017,7 @@ void Mesh2::drawAtIndex(uint index, bool forSelection, ViewMode viewMode)
                 
                 if (!triangle.visible)
                     return;
-                
+
 				glBegin(triangle.isQuad() ? GL_QUADS : GL_TRIANGLES);
                 if (_isUnwrapped)
                 {
@@ -636,20 +1092,17 @@ void Mesh2::drawAtIndex(uint index, bool forSelection, ViewMode viewMode)
 
 void Mesh2::drawAllVertices(ViewMode viewMode, bool forSelection)
 {
+    fillPointCache();
+    
     glPointSize(4.0f);
     
     if (forSelection)
     {
-        vector<Vector3D> tempVertices;
-        vector<uint> tempColors;
-        
-        uint colorIndex = 0;
-        
         if (!_selectThrough && !_isUnwrapped)
         {
             glEnable(GL_POLYGON_OFFSET_FILL);
 			glPolygonOffset(1.0f, 1.0f);
-            ColorIndex(colorIndex);
+            ColorIndex(0);
             FillMode fillMode;
             fillMode.textured = false;
             fillMode.colored = false;
@@ -657,183 +1110,51 @@ void Mesh2::drawAllVertices(ViewMode viewMode, bool forSelection)
             glDisable(GL_POLYGON_OFFSET_FILL);
         }
         
-        if (_isUnwrapped)
-        {
-            for (TexCoordNode *node = _texCoords.begin(), *end = _texCoords.end(); node != end; node = node->next())
-            {
-                colorIndex++;
-                
-                if (!node->data().visible)
-                    continue;
-                
-                tempColors.push_back(colorIndex);
-                tempVertices.push_back(node->data().position);
-            }
-        }
-        else
-        {
-            for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
-            {
-                colorIndex++;
-                
-                if (!node->data().visible)
-                    continue;
-                
-                tempColors.push_back(colorIndex);
-                tempVertices.push_back(node->data().position);            
-            }
-        }
-        
-        glEnableClientState(GL_VERTEX_ARRAY);
-        glEnableClientState(GL_COLOR_ARRAY);
-        
-        ColorIndices(tempColors);
-        
-        float *vertexPtr = (float *)&tempVertices[0];        
-        glVertexPointer(3, GL_FLOAT, 0, vertexPtr);
-        
-        glDrawArrays(GL_POINTS, 0, tempVertices.size());
-        
-        glDisableClientState(GL_COLOR_ARRAY);
-        glDisableClientState(GL_VERTEX_ARRAY);
+        _cachedPoints.drawForSelection(GL_POINTS);
     }
     else
     {
-        vector<Vector3D> tempVertices;
-        vector<Vector3D> tempColors;
-        
-        Vector3D selectedColor(1.0f, 0.0f, 0.0f);
-        Vector3D normalColor(0.0f, 0.0f, 1.0f);
-        
-        if (_isUnwrapped)
-        {
-            for (TexCoordNode *node = _texCoords.begin(), *end = _texCoords.end(); node != end; node = node->next())
-            {
-                if (!node->data().visible)
-                    continue;
-                
-                if (node->data().selected)
-                    tempColors.push_back(selectedColor);
-                else
-                    tempColors.push_back(normalColor);
-                
-                tempVertices.push_back(node->data().position);
-            }
-        }
-        else
-        {
-            for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
-            {
-                if (!node->data().visible)
-                    continue;
-                
-                if (_useSoftSelection)
-                {
-                    if (node->selectionWeight > _minimumSelectionWeight)
-                        tempColors.push_back(Vector3D(1.0f, 1.0f - node->selectionWeight, 0.0f));
-                    else
-                        tempColors.push_back(normalColor);
-                }
-                else
-                {
-                    if (node->data().selected)
-                        tempColors.push_back(selectedColor);
-                    else
-                        tempColors.push_back(normalColor);
-
-                }
-                
-                tempVertices.push_back(node->data().position);            
-            }
-        }
-        
-        glEnableClientState(GL_VERTEX_ARRAY);
-        glEnableClientState(GL_COLOR_ARRAY);
-        
-        float *colorPtr = (float *)&tempColors[0];
-        glColorPointer(3, GL_FLOAT, 0, colorPtr);
-        
-        float *vertexPtr = (float *)&tempVertices[0];        
-        glVertexPointer(3, GL_FLOAT, 0, vertexPtr);
-        
-        glDrawArrays(GL_POINTS, 0, tempVertices.size());
-        
-        glDisableClientState(GL_COLOR_ARRAY);
-        glDisableClientState(GL_VERTEX_ARRAY);
+        _cachedPoints.draw(GL_POINTS);
     }
 }
 
 void Mesh2::glProjectSelect(int x, int y, int width, int height, const Matrix4x4 &transform, OpenGLSelectionMode selectionMode)
 {
     int viewport[4];
-    double modelview[16];
-    double projection[16];
-    double winX, winY, winZ;
-    double posX, posY, posZ;
-	
-    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
-    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    float modelview[16];
+    float projection[16];
+    
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
     glGetIntegerv(GL_VIEWPORT, viewport);
     
-    for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
-    {
-        if (!node->data().visible)
-            continue;
-
-        Vector3D position = transform.Transform(node->data().position);
-
-        posX = position.x;
-        posY = position.y;
-        posZ = position.z;
-        
-        gluProject(posX, posY, posZ, modelview, projection, viewport, &winX, &winY, &winZ);
-        
-        if (winX > x && winX < x + width &&
-            winY > y && winY < y + height)
-        {
-            switch (selectionMode) 
-            {
-                case OpenGLSelectionMode::Add:
-                    node->data().selected = true;
-                    break;
-                case OpenGLSelectionMode::Subtract:
-                    node->data().selected = false;
-                    break;
-                case OpenGLSelectionMode::Invert:
-                    node->data().selected = !node->data().selected;
-                    break;
-                default:
-                    break;
-            }
-        }
-    }
+    SelectionFrustum frustum(projection, modelview, transform, viewport, x, y, width, height);
+    selectInFrustum(frustum, !_selectThrough, selectionMode);
 }
 
-void Mesh2::drawAllTriangles(ViewMode viewMode, bool forSelection)
+void Mesh2::drawAllTriangles(bool forSelection)
 {
-    for (uint i = 0; i < _triangles.count(); i++)
-    {
-        uint colorIndex = i + 1;
-        ColorIndex(colorIndex);
-        drawAtIndex(i, forSelection, viewMode);
-    }
+    // triangles are drawn by drawFill, only selection needs their IDs
+    if (!forSelection)
+        return;
+    
+    fillTriangleIDCache();
+    _cachedTriangleIDs.drawForSelection(GL_TRIANGLES);
 }
 
 void Mesh2::drawAllEdges(ViewMode viewMode, bool forSelection)
 {
     fillEdgeCache();
     
+    ColoredVertexBuffer &cachedEdges = _isUnwrapped ? _cachedEdgeTexCoords : _cachedEdgeVertices;
+    
     if (forSelection)
     {
-        vector<uint> tempColors;
-        
-        uint colorIndex = 0;
-        
         if (!_selectThrough && !_isUnwrapped)
         {
             glEnable(GL_POLYGON_OFFSET_FILL);
 			glPolygonOffset(1.0f, 1.0f);
-            ColorIndex(colorIndex);
+            ColorIndex(0);
             FillMode fillMode;
             fillMode.textured = false;
             fillMode.colored = false;
@@ -841,88 +1162,11 @@ void Mesh2::drawAllEdges(ViewMode viewMode, bool forSelection)
             glDisable(GL_POLYGON_OFFSET_FILL);
         }
         
-        if (_isUnwrapped)
-        {
-            for (TexCoordEdgeNode *node = _texCoordEdges.begin(), *end = _texCoordEdges.end(); node != end; node = node->next())
-            {
-                if (!node->data().visible)
-                {
-                    colorIndex++;
-                    continue;
-                }
-                
-                colorIndex++;
-                tempColors.push_back(colorIndex);
-                tempColors.push_back(colorIndex);
-            }
-        }
-        else
-        {
-            for (VertexEdgeNode *node = _vertexEdges.begin(), *end = _vertexEdges.end(); node != end; node = node->next())
-            {
-                if (!node->data().visible)
-                {
-                    colorIndex++;
-                    continue;
-                }
-                
-                colorIndex++;
-                tempColors.push_back(colorIndex);
-                tempColors.push_back(colorIndex);
-            }
-        }
-        
-        glEnableClientState(GL_VERTEX_ARRAY);
-        glEnableClientState(GL_COLOR_ARRAY);
-        
-        ColorIndices(tempColors);
-        
-        if (_isUnwrapped)
-        {
-            float *vertexPtr = (float *)&_cachedEdgeTexCoords[0].position;
-            glVertexPointer(3, GL_FLOAT, sizeof(GLEdgeTexCoord), vertexPtr);
-            
-            glDrawArrays(GL_LINES, 0, (int)_cachedEdgeTexCoords.count());
-        }
-        else
-        {
-            float *vertexPtr = (float *)&_cachedEdgeVertices[0].position;
-            glVertexPointer(3, GL_FLOAT, sizeof(GLEdgeVertex), vertexPtr);
-            
-            glDrawArrays(GL_LINES, 0, (int)_cachedEdgeVertices.count());
-        }
-        
-        glDisableClientState(GL_COLOR_ARRAY);
-        glDisableClientState(GL_VERTEX_ARRAY);
+        cachedEdges.drawForSelection(GL_LINES);
     }
     else
     {
-        glEnableClientState(GL_VERTEX_ARRAY);
-        glEnableClientState(GL_COLOR_ARRAY);
-        
-        if (_isUnwrapped)
-        {
-            float *colorPtr = (float *)&_cachedEdgeTexCoords[0].color;
-            glColorPointer(3, GL_FLOAT, sizeof(GLEdgeTexCoord), colorPtr);
-            
-            float *vertexPtr = (float *)&_cachedEdgeTexCoords[0].position;
-            glVertexPointer(3, GL_FLOAT, sizeof(GLEdgeTexCoord), vertexPtr);
-            
-            glDrawArrays(GL_LINES, 0, (int)_cachedEdgeTexCoords.count());
-        }
-        else
-        {
-            float *colorPtr = (float *)&_cachedEdgeVertices[0].color;
-            glColorPointer(3, GL_FLOAT, sizeof(GLEdgeVertex), colorPtr);
-            
-            float *vertexPtr = (float *)&_cachedEdgeVertices[0].position;
-            glVertexPointer(3, GL_FLOAT, sizeof(GLEdgeVertex), vertexPtr);
-            
-            glDrawArrays(GL_LINES, 0, (int)_cachedEdgeVertices.count());
-        }
-        
-        glDisableClientState(GL_COLOR_ARRAY);
-        glDisableClientState(GL_VERTEX_ARRAY);
+        cachedEdges.draw(GL_LINES);
     }
 }
 
@@ -934,7 +1178,7 @@ void Mesh2::drawAll(ViewMode viewMode, bool forSelection)
             drawAllVertices(viewMode, forSelection);
             break;
         case MeshSelectionMode::Triangles:
-            drawAllTriangles(viewMode, forSelection);
+            drawAllTriangles(forSelection);
             break;
         case MeshSelectionMode::Edges:
             drawAllEdges(viewMode, forSelection);
@@ -950,36 +1194,24 @@ void Mesh2::uvToPixels(float &u, float &v)
 //    v = (float)_texture.height - v;
 }
 
+void Mesh2::updateTriangleBVH()
+{
+    if (!_triangleBVH.isValid())
+        _triangleBVH.build(_triangles);
+    else if (_triangleBVH.needsRefit())
+        _triangleBVH.refit();
+}
+
 TriangleNode *Mesh2::rayToUV(const Vector3D &origin, const Vector3D &direction, float &u, float &v)
 {
+    updateTriangleBVH();
+    
     Vector3D intersect = Vector3D();
-    TriangleNode *nearest = NULL;
     u = 0.0f;
     v = 0.0f;
     
-    float lastSqDistance = 0.0f;
-    float tempSqDistance = 0.0f;
+    TriangleNode *nearest = _triangleBVH.rayIntersect(origin, direction, u, v, intersect);
     
-    for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
-    {
-        float tempU = 0.0f;
-        float tempV = 0.0f;
-        Vector3D tempIntersect;
-        
-        if (node->data().rayIntersect(origin, direction, tempU, tempV, tempIntersect))
-        {
-            tempSqDistance = tempIntersect.SqDistance(origin);
-            if (nearest == NULL || lastSqDistance > tempSqDistance)
-            {
-                nearest = node;
-                u = tempU;
-                v = tempV;
-                intersect = tempIntersect;
-                lastSqDistance = tempSqDistance;
-            }            
-        }
-    }
-
     if (nearest)
     {
         nearest->data().convertBarycentricToUVs(u, v);
@@ -1085,7 +1317,7 @@ void Mesh2::unhideAll()
     
     for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
         node->data().visible = true;
-
+    
     for (TexCoordEdgeNode *node = _texCoordEdges.begin(), *end = _texCoordEdges.end(); node != end; node = node->next())
         node->data().visible = true;
     
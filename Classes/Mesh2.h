@@ -11,6 +11,10 @@
 #include "OpenGLDrawing.h"
 #include "ShaderProgram.h"
 #include "MeshHelpers.h"
+#include "VertexGrid.h"
+#include "TriangleBVH.h"
+#include "SelectionFrustum.h"
+#include "ColoredVertexBuffer.h"
 #include "Camera.h"
 #include "MemoryStream.h"
 
@@ -21,35 +25,24 @@ enum GLVertexAttribID
     GLVertexAttribID_Color
 };
 
-struct Point3D
-{
-    float coords[3];
-};
-
 struct Point2D 
 {
     float coords[2];
 };
 
-struct GLTriangleVertex
+struct PackedNormal
 {
-    Point3D position;
-    Point3D flatNormal;
-    Point3D smoothNormal;
-    Point3D color;
-    Point3D texCoord;
-};
-
-struct GLEdgeVertex
-{
-    Point3D position;
-    Point3D color;
+    short coords[4]; // normalized, last one is padding
 };
 
-struct GLEdgeTexCoord
+// Shared by corners with the same vertex, texture coordinate and color,
+// triangles index into these. Flat normals are computed in the shader.
+struct GLTriangleVertex
 {
     Point3D position;
-    Point3D color;
+    PackedNormal smoothNormal;
+    PackedColor color;
+    Point2D texCoord;
 };
 
 struct FillMode
@@ -64,6 +57,12 @@ class TextureCollection;
 class Mesh2
 {
 private:
+    VNodePool<Vertex2> _vertexPool;
+    FPPool<TriangleNode> _trianglePool;
+    VNodePool<TexCoord> _texCoordPool;
+    FPPool<VertexEdgeNode> _vertexEdgePool;
+    FPPool<TexCoordEdgeNode> _texCoordEdgePool;
+    
     FPList<VertexNode, Vertex2> _vertices;
 	FPList<TriangleNode, Triangle2> _triangles;
     FPList<TexCoordNode, TexCoord> _texCoords;
@@ -71,17 +70,41 @@ private:
     FPList<VertexEdgeNode, VertexEdge> _vertexEdges;
     FPList<TexCoordEdgeNode, TexCoordEdge> _texCoordEdges;
     
+    VEdgeTable<Vertex2> _vertexEdgeTable;
+    VEdgeTable<TexCoord> _texCoordEdgeTable;
+    bool _edgeTablesValid;
+    
+    VertexGrid _vertexGrid;
+    TriangleBVH _triangleBVH;
+    
     MeshSelectionMode _selectionMode;
-	
+    
     vector<VertexNode *> _cachedVertexSelection;
     vector<TriangleNode *> _cachedTriangleSelection;
     vector<TexCoordNode *> _cachedTexCoordSelection;
     vector<VertexEdgeNode *> _cachedVertexEdgeSelection;
     vector<TexCoordEdgeNode *> _cachedTexCoordEdgeSelection;
     
+    // elements touched by an edit, see updateDirtyTopology()
+    vector<TriangleNode *> _dirtyTriangles;
+    vector<TriangleNode *> _removedTriangles;
+    vector<VertexNode *> _dirtyVertices;
+    vector<TexCoordNode *> _dirtyTexCoords;
+    vector<VertexEdgeNode *> _dirtyVertexEdges;
+    vector<TexCoordEdgeNode *> _dirtyTexCoordEdges;
+
 	FPArrayCache<GLTriangleVertex> _cachedTriangleVertices;
-    FPArrayCache<GLEdgeVertex> _cachedEdgeVertices;
-    FPArrayCache<GLEdgeTexCoord> _cachedEdgeTexCoords;
+    FPArrayCache<uint> _cachedTriangleIndices;
+    ColoredVertexBuffer _cachedTriangleIDs; // triangle corners with their selection color index
+    bool _cachedTriangleIDsUnwrapped;
+    vector<uint> _dirtyTriangleCacheIndices;
+    ColoredVertexBuffer _cachedEdgeVertices;
+    ColoredVertexBuffer _cachedEdgeTexCoords;
+    ColoredVertexBuffer _cachedPoints; // vertices or texture coordinates when unwrapped
+    bool _cachedPointsUnwrapped;
+    Vector3D _boundsMinimum; // object space box of vertices, see getBounds()
+    Vector3D _boundsMaximum;
+    bool _boundsValid;
     
     static bool _useSoftSelection;
     static bool _selectThrough;
@@ -91,17 +114,27 @@ private:
     bool _isUnwrapped;
     
     uint _vboID;
+    uint _iboID;
     bool _vboGenerated;
-
+    
     float _colorComponents[4];
     Vector4D _color;
     Texture *_texture;
+    
+    uint _referenceCount; // items sharing this mesh, see Item::makeMeshUnique()
 private:
     void fastMergeSelectedVertices();
     void fastMergeSelectedTexCoords();
     void halfEdges();
     void repositionVertices(uint vertexCount);
     void makeSubdividedTriangles();
+    void removeAll();
+    void makeEdgeTables();
+    void clearDirtyTopology();
+    void markTriangleDirty(TriangleNode *node);
+    void markTriangleSelectionDirty(TriangleNode *node);
+    void removeTriangleAndMarkDirty(TriangleNode *&node);
+    void updateDirtyTopology();
     void uvToPixels(float &u, float &v);
     
     template <class T>
@@ -110,6 +143,9 @@ private:
     template <class T>
     FPList<VNode<T>, T> &vertices();    
     
+    template <class T>
+    VEdgeTable<T> &edgeTable();
+    
     template <class T>
     VEdgeNode<T> *findOrCreateEdge(VNode<T> *v1, VNode<T> *v2, TriangleNode * triangle);
     
@@ -122,6 +158,11 @@ public:
     
     void encode(MemoryWriteStream *stream, TextureCollection &textures);
     
+    // duplicated items share one mesh, the last item releasing it deletes it
+    void retain() { _referenceCount++; }
+    void release();
+    bool isShared() const { return _referenceCount > 1; }
+    
     Vector4D color() { return _color; }
     void setColor(Vector4D color);
     
@@ -131,6 +172,7 @@ public:
     uint vertexCount() { return _vertices.count(); }
     uint triangleCount() { return _triangles.count(); }
     uint vertexEdgeCount() { return _vertexEdges.count(); }
+    FPPoolStatistics poolStatistics() const;
     
     MeshSelectionMode selectionMode() const { return _selectionMode; };
     void setSelectionMode(MeshSelectionMode value);
@@ -141,6 +183,8 @@ public:
     bool isSelectedAtIndex(uint index) const;
     void setSelectedAtIndex(bool selected, uint index);
     void expandSelectionFromIndex(uint index, bool invert);
+    bool intersectsFrustumAtIndex(const SelectionFrustum &frustum, uint index) const;
+    void selectInFrustum(SelectionFrustum &frustum, bool useOcclusion, OpenGLSelectionMode selectionMode);
     void getSelectionCenterRotationScale(Vector3D &center, Quaternion &rotation, Vector3D &scale);
     
     static bool useSoftSelection() { return _useSoftSelection; }
@@ -203,25 +247,34 @@ public:
     
     void resetTriangleCache();
     void fillTriangleCache();
+    void fillTriangleIDCache();
     
     void resetEdgeCache();
+    void resetSelectionCache();
     void fillEdgeCache();
+    void fillPointCache();
     
-    void updateVertexInTriangleCache(VertexNode *vertexNode, VertexTriangleNode *triangleNode, uint cacheIndexPosition);
+    // cached with triangle cache, for culling whole meshes
+    void getBounds(Vector3D &minimum, Vector3D &maximum);
+    
+    void updateVertexInTriangleCache(VertexNode *vertexNode, VertexTriangleNode *triangleNode);
+    void uploadTriangleCache();
+    void uploadDirtyTriangleCache();
     void updateVertexInEdgeCache(VertexNode *vertexNode, Vertex2VEdgeNode *edgeNode);
     void updateTriangleAndEdgeCache(vector<VertexNode *> &affectedVertices);
     
     void drawFill(FillMode fillMode, ViewMode viewMode);
     void draw(ViewMode viewMode, const Vector3D &scale, bool selected, bool forSelection);
-
+    
     void drawAtIndex(uint index, bool forSelection, ViewMode viewMode);
     void drawAll(ViewMode viewMode, bool forSelection);
     
     void drawAllVertices(ViewMode viewMode, bool forSelection);
-    void drawAllTriangles(ViewMode viewMode, bool forSelection);
+    void drawAllTriangles(bool forSelection);
     void drawAllEdges(ViewMode viewMode, bool forSelection);
     
-    bool useGLProject() { return _selectThrough && _selectionMode == MeshSelectionMode::Vertices; }
+    // rectangle selection runs on the CPU, see SelectionFrustum
+    bool useGLProject() { return true; }
     void glProjectSelect(int x, int y, int width, int height, const Matrix4x4 &transform, OpenGLSelectionMode selectionMode);
     
     void hideSelected();
@@ -229,8 +282,9 @@ public:
     
     // texturing
     
+    void updateTriangleBVH();
     TriangleNode *rayToUV(const Vector3D &origin, const Vector3D &direction, float &u, float &v);
-
+    
     // make
     
     VertexNode *addVertex(const Vector3D &position);
@@ -238,8 +292,9 @@ public:
     TriangleNode *quadConnectVerticesNearPosition(const Vector3D &position, const Vector3D &eyeVector);
     void triangleVertexNodesNearPosition(const Vector3D &position, const Vector3D &eyeVector, vector<VertexNode *> &vertices);
     TriangleNode *triangleConnectVerticesNearPosition(const Vector3D &position, const Vector3D &eyeVector);
-    VertexNode *findNearestVertex(const Vector3D &position, const vector<VertexNode *> &skipVertices) const;
-
+    VertexNode *findNearestVertex(const Vector3D &position, const vector<VertexNode *> &skipVertices);
+    void findNearestVertices(const Vector3D &position, uint count, vector<VertexNode *> &vertices);
+    
     TriangleNode *addTriangle(VertexNode *v0, VertexNode *v1, VertexNode *v2);
     TriangleNode *addQuad(VertexNode *v0, VertexNode *v1, VertexNode *v2, VertexNode *v3);
     void removeTriQuad(TriangleNode *&triQuad);    
@@ -249,6 +304,9 @@ public:
     const FPList<TexCoordNode, TexCoord> &texCoords() const { return _texCoords; }
     const FPList<VertexEdgeNode, VertexEdge> &vertexEdges() const { return _vertexEdges; }
     
+    VertexEdgeNode *sharedEdge(const VertexNode *v1, const VertexNode *v2);
+    TexCoordEdgeNode *sharedEdge(const TexCoordNode *t1, const TexCoordNode *t2);
+    
     void makeEdges(TriangleNode *node);
     
     void makeTexCoords();
@@ -265,7 +323,7 @@ public:
     
     void fromIndexRepresentation(const vector<Vector3D> &vertices, const vector<Vector3D> &texCoords, const vector<TriQuad> &triangles);
     void toIndexRepresentation(vector<Vector3D> &vertices, vector<Vector3D> &texCoords, vector<TriQuad> &triangles) const;
-  
+    
     void setSelection(const vector<bool> &selection);
     void getSelection(vector<bool> &selection) const;
     
@@ -278,6 +336,12 @@ inline FPList<VertexEdgeNode, VertexEdge> &Mesh2::edges() { return this->_vertex
 template <>
 inline FPList<TexCoordEdgeNode, TexCoordEdge> &Mesh2::edges() { return this->_texCoordEdges; }
 
+template <>
+inline VEdgeTable<Vertex2> &Mesh2::edgeTable() { return this->_vertexEdgeTable; }
+
+template <>
+inline VEdgeTable<TexCoord> &Mesh2::edgeTable() { return this->_texCoordEdgeTable; }
+
 template <>
 inline FPList<VertexNode, Vertex2> &Mesh2::vertices() { return this->_vertices; }
 
@@ -287,10 +351,20 @@ inline FPList<TexCoordNode, TexCoord> &Mesh2::vertices() { return this->_texCoor
 template <class T>
 inline VEdgeNode<T> *Mesh2::findOrCreateEdge(VNode<T> *v1, VNode<T> *v2, TriangleNode * triangle)
 {
-    VEdgeNode<T> *sharedEdge = v1->sharedEdge(v2);
+    // walking the shorter edge list keeps fans around high valence vertices linear
+    VEdgeNode<T> *sharedEdge;
+    if (v1->_edges.count() <= v2->_edges.count())
+        sharedEdge = v1->sharedEdge(v2);
+    else
+        sharedEdge = v2->sharedEdge(v1);
+    
     if (sharedEdge)
     {
-        sharedEdge->data().setTriangle(1, triangle);
+        // incremental update can leave kept edges without triangles
+        if (sharedEdge->data().triangle(0) == NULL)
+            sharedEdge->data().setTriangle(0, triangle);
+        else
+            sharedEdge->data().setTriangle(1, triangle);
         return sharedEdge;
     }
     
@@ -298,6 +372,9 @@ inline VEdgeNode<T> *Mesh2::findOrCreateEdge(VNode<T> *v1, VNode<T> *v2, Triangl
     VEdgeNode<T> *node = edges<T>().add(vertices);
     
     node->data().setTriangle(0, triangle);
+    
+    if (_edgeTablesValid)
+        edgeTable<T>().insert(node);
     return node;
 }
 
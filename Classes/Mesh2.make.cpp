@@ -11,19 +11,20 @@
 
 VertexNode *Mesh2::addVertex(const Vector3D &position)
 {
-    return _vertices.add(position);
+    VertexNode *node = _vertices.add(position);
+    if (_vertexGrid.isValid())
+        _vertexGrid.add(node);
+    return node;
 }
 
 void Mesh2::quadVertexNodesNearPosition(const Vector3D &position, const Vector3D &eyeVector, vector<VertexNode *> &vertices)
 {
     Vector3D center = Vector3D();
     
+    findNearestVertices(position, 4, vertices);
+    
     for (uint i = 0; i < 4; i++)
-    {
-        VertexNode *nearestVertex = findNearestVertex(position, vertices);
-        vertices.push_back(nearestVertex);
-        center += nearestVertex->data().position;
-    }
+        center += vertices[i]->data().position;
     
     center /= 4.0f;
     
@@ -69,19 +70,15 @@ TriangleNode *Mesh2::quadConnectVerticesNearPosition(const Vector3D &position, c
     
     TriangleNode *quad = addQuad(vertices[0], vertices[1], vertices[2], vertices[3]);
     
-    makeEdges();
-    setSelectionMode(_selectionMode);
+    markTriangleDirty(quad);
+    updateDirtyTopology();
     
     return quad;
 }
 
 void Mesh2::triangleVertexNodesNearPosition(const Vector3D &position, const Vector3D &eyeVector, vector<VertexNode *> &vertices)
 {
-    for (uint i = 0; i < 3; i++)
-    {
-        VertexNode *nearestVertex = findNearestVertex(position, vertices);
-        vertices.push_back(nearestVertex);
-    }
+    findNearestVertices(position, 3, vertices);
     
     Vector3D u, v;
     u = vertices[0]->data().position - vertices[1]->data().position;
@@ -99,31 +96,28 @@ TriangleNode *Mesh2::triangleConnectVerticesNearPosition(const Vector3D &positio
     
     TriangleNode *triangle = addTriangle(vertices[0], vertices[1], vertices[2]);
     
-    makeEdges();
-    setSelectionMode(_selectionMode);
+    markTriangleDirty(triangle);
+    updateDirtyTopology();
     
     return triangle;
 }
 
-VertexNode *Mesh2::findNearestVertex(const Vector3D &position, const vector<VertexNode *> &skipVertices) const
+VertexNode *Mesh2::findNearestVertex(const Vector3D &position, const vector<VertexNode *> &skipVertices)
 {
-    VertexNode *nearest = NULL;
+    vector<VertexNode *> vertices(skipVertices);
+    findNearestVertices(position, 1, vertices);
     
-    for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
-    {
-        if (find(skipVertices.begin(), skipVertices.end(), node) != skipVertices.end())
-        {
-            continue;
-        }
-        
-        if (nearest == NULL ||
-            node->data().position.Distance(position) < nearest->data().position.Distance(position))
-        {
-            nearest = node;
-        }
-    }
+    if (vertices.size() > skipVertices.size())
+        return vertices.back();
+    return NULL;
+}
+
+void Mesh2::findNearestVertices(const Vector3D &position, uint count, vector<VertexNode *> &vertices)
+{
+    if (!_vertexGrid.isValid())
+        _vertexGrid.build(_vertices);
     
-    return nearest;
+    _vertexGrid.findNearest(position, count, vertices);
 }
 
 TriangleNode *Mesh2::addTriangle(VertexNode *v0, VertexNode *v1, VertexNode *v2)
@@ -135,6 +129,7 @@ TriangleNode *Mesh2::addTriangle(VertexNode *v0, VertexNode *v1, VertexNode *v2)
     VertexNode *vertices[3] = { v0, v1, v2 };
     TexCoordNode *texCoords[3] = { t0, t1, t2 };
     
+    _triangleBVH.invalidate();
     return _triangles.add(Triangle2(vertices, texCoords));
 }
 
@@ -148,11 +143,13 @@ TriangleNode *Mesh2::addQuad(VertexNode *v0, VertexNode *v1, VertexNode *v2, Ver
     VertexNode *vertices[4] = { v0, v1, v2, v3 };
     TexCoordNode *texCoords[4] = { t0, t1, t2, t3 };
     
+    _triangleBVH.invalidate();
   	return _triangles.add(Triangle2(vertices, texCoords, true));
 }
 
 void Mesh2::removeTriQuad(TriangleNode *&triQuad)
 {
+    _triangleBVH.invalidate();
     _triangles.remove(triQuad);
 }
 
@@ -202,29 +199,75 @@ void Mesh2::makeEdges(TriangleNode *node)
 
 void Mesh2::makeEdges()
 {
-    _vertexEdges.removeAll();
-    _texCoordEdges.removeAll();
+    _vertexEdges.abandonAll();
+    _texCoordEdges.abandonAll();
     
     for (VertexNode *node = _vertices.begin(), *end = _vertices.end(); node != end; node = node->next())
     {
-        node->removeEdges();
+        node->_edges.abandonAll();
     }
     
     for (TexCoordNode *node = _texCoords.begin(), *end = _texCoords.end(); node != end; node = node->next())
     {
-        node->removeEdges();
+        node->_edges.abandonAll();
     }
     
+    _vertexEdgePool.releaseAll();
+    _texCoordEdgePool.releaseAll();
+    _vertexPool.edgePool.releaseAll();
+    _texCoordPool.edgePool.releaseAll();
+    
+    _edgeTablesValid = false;
+    _vertexGrid.invalidate();
+    _triangleBVH.invalidate();
+    clearDirtyTopology();
+    
     for (TriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
     {
         makeEdges(node);
     }
 }
 
+void Mesh2::makeEdgeTables()
+{
+    _vertexEdgeTable.clear();
+    _vertexEdgeTable.reserve(_vertexEdges.count());
+    
+    for (VertexEdgeNode *node = _vertexEdges.begin(), *end = _vertexEdges.end(); node != end; node = node->next())
+    {
+        _vertexEdgeTable.insert(node);
+    }
+    
+    _texCoordEdgeTable.clear();
+    _texCoordEdgeTable.reserve(_texCoordEdges.count());
+    
+    for (TexCoordEdgeNode *node = _texCoordEdges.begin(), *end = _texCoordEdges.end(); node != end; node = node->next())
+    {
+        _texCoordEdgeTable.insert(node);
+    }
+    
+    _edgeTablesValid = true;
+}
+
+VertexEdgeNode *Mesh2::sharedEdge(const VertexNode *v1, const VertexNode *v2)
+{
+    if (!_edgeTablesValid)
+        makeEdgeTables();
+    
+    return _vertexEdgeTable.find(v1, v2);
+}
+
+TexCoordEdgeNode *Mesh2::sharedEdge(const TexCoordNode *t1, const TexCoordNode *t2)
+{
+    if (!_edgeTablesValid)
+        makeEdgeTables();
+    
+    return _texCoordEdgeTable.find(t1, t2);
+}
+
 void Mesh2::makePlane()
 {
-    _vertices.removeAll();
-    _triangles.removeAll();
+    removeAll();
     
     VertexNode *v0 = _vertices.add(Vector3D(-1, -1, 0));
 	VertexNode *v1 = _vertices.add(Vector3D(-1,  1, 0));
@@ -241,9 +284,7 @@ void Mesh2::makePlane()
 
 void Mesh2::makeCube()
 {
-    _vertices.removeAll();
-	_triangles.removeAll();
-    _texCoords.removeAll();
+    removeAll();
     
 	// back vertices
 	VertexNode *v0 = _vertices.add(Vector3D(-1, -1, -1));
@@ -283,8 +324,7 @@ void Mesh2::makeCube()
 
 void Mesh2::makeCylinder(uint steps)
 {
-    _vertices.removeAll();
-    _triangles.removeAll();
+    removeAll();
     
     VertexNode *node0 = _vertices.add(Vector3D(0, -1, 0)); // 0
     VertexNode *node1 = _vertices.add(Vector3D(0,  1, 0)); // 1
@@ -327,8 +367,7 @@ void Mesh2::makeCylinder(uint steps)
 
 void Mesh2::makeSphere(uint steps)
 {
-    _vertices.removeAll();
-    _triangles.removeAll();
+    removeAll();
     
     uint max = steps;
     
@@ -480,41 +519,38 @@ void Mesh2::makeIcosahedron()
 void Mesh2::fromVertices(const vector<Vector3D> &vertices)
 {
     resetTriangleCache();
-    _vertices.removeAll();
-    _texCoords.removeAll();
-    _triangles.removeAll();
+    removeAll();
     
     vector<VertexNode *> tempVertices;
     vector<VertexNode *> uniqueVertices;
+    VertexWelder welder;
     
     uint verticesSize = vertices.size();
     
+    tempVertices.reserve(verticesSize);
+    welder.reserve(verticesSize);
+    
     for (uint i = 0; i < verticesSize; i++)
     {
-        bool found = false;
+        uint j = welder.find(vertices[i]);
         
-        for (uint j = 0; j < uniqueVertices.size(); j++)
+        if (j != UINT_MAX)
         {
-            if (uniqueVertices[j]->data().position.SqDistance(vertices[i]) < FLOAT_EPS)
+            VertexNode *last = tempVertices.size() > 0 ? tempVertices[tempVertices.size() - 1] : NULL;
+            VertexNode *lastPrevious = tempVertices.size() > 1 ? tempVertices[tempVertices.size() - 2] : NULL;
+            
+            // welding into the same triangle would make it degenerated
+            if (last != uniqueVertices[j] && lastPrevious != uniqueVertices[j])
             {
-                VertexNode *last = tempVertices.size() > 0 ? tempVertices[tempVertices.size() - 1] : NULL;
-                VertexNode *lastPrevious = tempVertices.size() > 1 ? tempVertices[tempVertices.size() - 2] : NULL;
-                
-                if (last == uniqueVertices[j] || lastPrevious == uniqueVertices[j])
-                    break;
-                
                 tempVertices.push_back(uniqueVertices[j]);
-                found = true;
-                break;
-            }            
+                continue;
+            }
         }
         
-        if (!found)
-        {
-            VertexNode *newVertex = _vertices.add(vertices[i]);
-            uniqueVertices.push_back(newVertex);
-            tempVertices.push_back(newVertex);
-        }        
+        VertexNode *newVertex = _vertices.add(vertices[i]);
+        welder.add(vertices[i]);
+        uniqueVertices.push_back(newVertex);
+        tempVertices.push_back(newVertex);
     }
     
     VertexNode *triangleVertices[3];
@@ -549,9 +585,7 @@ void Mesh2::toVertices(vector<Vector3D> &vertices)
 void Mesh2::fromIndexRepresentation(const vector<Vector3D> &vertices, const vector<Vector3D> &texCoords, const vector<TriQuad> &triangles)
 {
     resetTriangleCache();
-    _vertices.removeAll();
-    _texCoords.removeAll();
-    _triangles.removeAll();
+    removeAll();
     
     vector<VertexNode *> tempVertices;
     vector<TexCoordNode *> tempTexCoords;
@@ -681,9 +715,7 @@ void Mesh2::make(MeshType meshType, uint steps)
 
 void Mesh2::fillMeshFromSelectedTriangles(Mesh2 &mesh)
 {
-    mesh._vertices.removeAll();
-    mesh._texCoords.removeAll();
-    mesh._triangles.removeAll();
+    mesh.removeAll();
 
     resetAlgorithmData();
     
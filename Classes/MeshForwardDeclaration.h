@@ -81,18 +81,10 @@ class TriangleNode;
 class VertexTriangleNode : public FPNode<VertexTriangleNode, TriangleNode *>
 {
 public:
-    int cacheIndices[2];
+    int cacheIndex; // shared vertex in the triangle cache, -1 if hidden
     
-    VertexTriangleNode() : FPNode<VertexTriangleNode, TriangleNode *>()
-    {
-        cacheIndices[0] = -1;
-        cacheIndices[1] = -1;
-    }
-    VertexTriangleNode(TriangleNode* const &data) : FPNode<VertexTriangleNode, TriangleNode *>(data)
-    {
-        cacheIndices[0] = -1;
-        cacheIndices[1] = -1;
-    }
+    VertexTriangleNode() : FPNode<VertexTriangleNode, TriangleNode *>(), cacheIndex(-1) { }
+    VertexTriangleNode(TriangleNode* const &data) : FPNode<VertexTriangleNode, TriangleNode *>(data), cacheIndex(-1) { }
     virtual ~VertexTriangleNode() { }
 };
 
@@ -8,6 +8,7 @@
  */
 
 #include "MeshHelpers.h"
+#include <algorithm>
 
 void AddTriangle(vector<TriQuad> &triangles, uint index1, uint index2, uint index3)
 {
@@ -53,3 +54,119 @@ void FlipTriangle(TriQuad &triangle)
     swap(triangle.vertexIndices[0], triangle.vertexIndices[2]);
     swap(triangle.texCoordIndices[0], triangle.texCoordIndices[2]);
 }
+
+VertexWelder::VertexWelder(float squaredEpsilon)
+{
+    _squaredEpsilon = squaredEpsilon;
+    // slightly larger cells, rounding cannot move close positions two cells apart
+    _invCellSize = 0.99f / sqrtf(squaredEpsilon);
+}
+
+void VertexWelder::cell(const Vector3D &position, int coords[3]) const
+{
+    // clamped so that far positions end up in shared border cells instead of overflowing
+    const float limit = 1.0e9f;
+    
+    for (uint i = 0; i < 3; i++)
+    {
+        float c = floorf(position[i] * _invCellSize);
+        coords[i] = (int)max(-limit, min(limit, c));
+    }
+}
+
+uint VertexWelder::bucket(int x, int y, int z) const
+{
+    uint hash = (uint)x * 73856093U ^ (uint)y * 19349663U ^ (uint)z * 83492791U;
+    return hash & (_buckets.size() - 1);
+}
+
+void VertexWelder::rehash(uint bucketCount)
+{
+    _buckets.assign(bucketCount, UINT_MAX);
+    
+    int coords[3];
+    
+    for (uint i = 0; i < _positions.size(); i++)
+    {
+        cell(_positions[i], coords);
+        uint b = bucket(coords[0], coords[1], coords[2]);
+        _next[i] = _buckets[b];
+        _buckets[b] = i;
+    }
+}
+
+void VertexWelder::clear()
+{
+    _positions.clear();
+    _next.clear();
+    _buckets.clear();
+}
+
+void VertexWelder::reserve(uint count)
+{
+    _positions.reserve(count);
+    _next.reserve(count);
+    
+    uint bucketCount = 16;
+    while (bucketCount < count)
+        bucketCount *= 2;
+    
+    if (bucketCount > _buckets.size())
+        rehash(bucketCount);
+}
+
+uint VertexWelder::find(const Vector3D &position) const
+{
+    if (_positions.empty())
+        return UINT_MAX;
+    
+    int coords[3];
+    cell(position, coords);
+    
+    uint found = UINT_MAX;
+    
+    for (int x = coords[0] - 1; x <= coords[0] + 1; x++)
+    {
+        for (int y = coords[1] - 1; y <= coords[1] + 1; y++)
+        {
+            for (int z = coords[2] - 1; z <= coords[2] + 1; z++)
+            {
+                for (uint i = _buckets[bucket(x, y, z)]; i != UINT_MAX; i = _next[i])
+                {
+                    if (i < found && _positions[i].SqDistance(position) < _squaredEpsilon)
+                        found = i;
+                }
+            }
+        }
+    }
+    
+    return found;
+}
+
+uint VertexWelder::add(const Vector3D &position)
+{
+    uint index = _positions.size();
+    _positions.push_back(position);
+    _next.push_back(UINT_MAX);
+    
+    if (_positions.size() > _buckets.size())
+    {
+        rehash(max(16U, (uint)_buckets.size() * 2U));
+        return index;
+    }
+    
+    int coords[3];
+    cell(position, coords);
+    uint b = bucket(coords[0], coords[1], coords[2]);
+    _next[index] = _buckets[b];
+    _buckets[b] = index;
+    return index;
+}
+
+uint VertexWelder::findOrAdd(const Vector3D &position)
+{
+    uint index = find(position);
+    if (index != UINT_MAX)
+        return index;
+    return add(position);
+}
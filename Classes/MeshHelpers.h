@@ -17,4 +17,33 @@
 void AddTriangle(vector<TriQuad> &triangles, uint index1, uint index2, uint index3);
 void AddTriangle(vector<TriQuad> &triangles, uint vertexIndices[3], uint texCoordIndices[3]);
 void AddQuad(vector<TriQuad> &triangles, uint index1, uint index2, uint index3, uint index4);
-void FlipTriangle(TriQuad &triangle);
\ No newline at end of file
+void FlipTriangle(TriQuad &triangle);
+
+// Welds positions closer than sqrt(squaredEpsilon) with a uniform grid
+// hashed into buckets, cells are as large as the weld distance, so only
+// the 27 neighbouring cells are searched. find() returns the lowest added
+// index within the distance, the same one a linear scan would find first.
+class VertexWelder
+{
+private:
+    float _squaredEpsilon;
+    float _invCellSize;
+    vector<Vector3D> _positions;
+    vector<uint> _next;
+    vector<uint> _buckets;
+    
+    void cell(const Vector3D &position, int coords[3]) const;
+    uint bucket(int x, int y, int z) const;
+    void rehash(uint bucketCount);
+public:
+    VertexWelder(float squaredEpsilon = FLOAT_EPS);
+    
+    uint count() const { return _positions.size(); }
+    const Vector3D &position(uint index) const { return _positions[index]; }
+    
+    void clear();
+    void reserve(uint count);
+    uint find(const Vector3D &position) const;
+    uint add(const Vector3D &position);
+    uint findOrAdd(const Vector3D &position);
+};
@@ -485,6 +485,7 @@
 	if (index > -1)
 	{
 		Item *item = items->itemAtIndex(index);
+        item->makeMeshUnique();
         item->mesh->setSelectionMode(mode);
         
 		meshController->setModel(item);
@@ -814,7 +815,11 @@
         [self allItemsActionWithName:@"Triangulate" block:^
         {
             for (uint i = 0; i < items->count(); i++)
-                items->itemAtIndex(i)->mesh->triangulate();
+            {
+                Item *item = items->itemAtIndex(i);
+                item->makeMeshUnique();
+                item->mesh->triangulate();
+            }
         }];
     }
 }
@@ -1107,6 +1112,7 @@ namespace MeshMakerCppCLI
 		if (index > -1)
 		{
 			Item *item = items->itemAtIndex(index);
+			item->makeMeshUnique();
 			item->mesh->setSelectionMode(mode);
 	        
 			meshController->setModel(item);
@@ -1161,7 +1167,7 @@ namespace MeshMakerCppCLI
 		for each (OpenGLSceneView ^view in views)
 		{
 			view->coreView()->setManipulated(manipulated);
-			view->Refresh();			
+			view->Invalidate();			
 		}
 
 		if (manipulated == itemsController)
@@ -1237,7 +1243,7 @@ namespace MeshMakerCppCLI
 		for each (OpenGLSceneView ^view in views)
 		{
 			if (view != except)
-				view->Refresh();
+				view->Invalidate();
 		}
 	}
 
@@ -1245,7 +1251,7 @@ namespace MeshMakerCppCLI
 	{
 		for each (OpenGLSceneView ^view in views)
 		{
-			view->Refresh();
+			view->Invalidate();
 		}
 	}
 
@@ -1589,7 +1595,11 @@ namespace MeshMakerCppCLI
 		else if (manipulated == itemsController)
 		{
 			for (uint i = 0; i < items->count(); i++)
-				items->itemAtIndex(i)->mesh->triangulate();
+			{
+				Item *item = items->itemAtIndex(i);
+				item->makeMeshUnique();
+				item->mesh->triangulate();
+			}
 		}
 	}
 
@@ -1637,6 +1647,12 @@ namespace MeshMakerCppCLI
 	void MyDocument::setTextureAtIndex(uint index)
 	{
 		Texture *texture = textures->textureAtIndex(index);
+
+		// texture is part of the mesh, shared mesh is copied first
+		Item *item = items->firstSelectedItem();
+		if (item != NULL)
+			item->makeMeshUnique();
+
 		Mesh2 *mesh = currentMesh();
 		if (mesh != NULL)
 		{
@@ -1657,6 +1673,7 @@ namespace MeshMakerCppCLI
 		for (uint i = 0; i < items->count(); i++)
         {
             Item *item = items->itemAtIndex(i);
+            item->makeMeshUnique();
             item->mesh->resetTriangleCache();
             item->mesh->resetAlgorithmData();
         }
@@ -1747,6 +1764,7 @@ void MyDocument::editMesh(MeshSelectionMode mode)
     if (index > -1)
     {
         Item *item = items->itemAtIndex(index);
+        item->makeMeshUnique();
         item->mesh->setSelectionMode(mode);
 
         meshController->setModel(item);
@@ -2029,7 +2047,11 @@ void MyDocument::triangulateSelected()
         this->allItemsAction("Triangulate", [this]
         {
             for (uint i = 0; i < this->items->count(); i++)
-                this->items->itemAtIndex(i)->mesh->triangulate();
+            {
+                Item *item = this->items->itemAtIndex(i);
+                item->makeMeshUnique();
+                item->mesh->triangulate();
+            }
         });
     }
 }
@@ -134,6 +134,13 @@
 
 @interface MyDocument (Archiving)
 
+- (BOOL)readFromModel3D:(NSData *)data;
+- (NSData *)dataOfModel3D;
+- (BOOL)readFromWavefrontObject:(NSData *)data;
+- (NSData *)dataOfWavefrontObject;
+- (BOOL)readFromCollada:(NSData *)data;
+- (NSData *)dataOfCollada;
+
 @end
 
 #elif defined(WIN32)
@@ -358,10 +365,12 @@ namespace MeshMakerCppCLI
 		void extrudeSelected();
 		void triangulateSelected();
 
-		void readModel3D(MemoryStream ^memoryStream);
+		bool readModel3D(MemoryStream ^memoryStream);
 		void writeModel3D(MemoryStream ^memoryStream);
-		void readWavefrontObject(String ^asciiString);
-		String ^writeWavefrontObject();
+		bool readWavefrontObject(String ^fileName);
+		bool writeWavefrontObject(String ^fileName);
+		bool readCollada(String ^fileName);
+		bool writeCollada(String ^fileName);
 
 		uint textureCount();
 		void addTexture(String ^fileName);
@@ -444,6 +453,12 @@ public:
     void detachSelected();
     void extrudeSelected();
     void triangulateSelected();
+
+    // fileName is in UTF-8
+    bool readWavefrontObject(const char *fileName);
+    bool writeWavefrontObject(const char *fileName);
+    bool readCollada(const char *fileName);
+    bool writeCollada(const char *fileName);
 };
 
 #endif
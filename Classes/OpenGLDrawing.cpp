@@ -26,7 +26,7 @@ void DrawCube(float size)
 		7, 2, 3,
 		7, 6, 2
 	};	
-	
+
 	static float vertices[8 * 3] =
 	{	
 		 1,  1,  1,
@@ -38,9 +38,9 @@ void DrawCube(float size)
 		 1, -1, -1,
 		-1, -1, -1
 	};
-	
+
 	size *= 0.5f;
-	
+
 	glPushMatrix();
 	glScalef(size, size, size);
 
@@ -48,7 +48,7 @@ void DrawCube(float size)
 	glVertexPointer(3, GL_FLOAT, 0, vertices);
 	glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, indices);
 	glDisableClientState(GL_VERTEX_ARRAY);
-	
+
 	glPopMatrix();
 }
 
@@ -59,11 +59,11 @@ void DrawSphere(float radius, int lats, int longs)
 		float lat0 = FLOAT_PI * (-0.5f + (float)(i - 1) / (float)lats);
 		float z0  = radius * sinf(lat0);
 		float zr0 =  radius * cosf(lat0);
-		
+
 		float lat1 = FLOAT_PI * (-0.5f + (float)i / (float)lats);
 		float z1 = radius * sinf(lat1);
 		float zr1 = radius * cosf(lat1);
-		
+
 		glBegin(GL_QUAD_STRIP);
 		for (int j = 0; j <= longs; j++) 
 		{
@@ -127,7 +127,7 @@ void DrawCubeArrow(float size)
 	glTranslatef(0, size, 0);
 	DrawCube(size * 0.08f);
 	glPopMatrix();
-	
+
 	glLineWidth(1.5f);
     glBegin(GL_LINES);
     glVertex3f(0, 0, 0);
@@ -162,23 +162,23 @@ void DrawPlane(Vector3D a, Vector3D b, float size)
 		a + b,
 		-a + b
 	};
-	
+
 	glBegin(GL_QUADS);
-		
+
 	for (int i = 0; i < 4; i++)
 	{
 		Vector3D v = vertices[i];
 		v *= size;
 		glVertex3f(v.x, v.y, v.z);
 	}
-	
+
 	glEnd();
 }
 
 void DrawSelectionPlane(PlaneAxis plane)
 {
 	const float size = 4000.0f;
-	
+
 	switch (plane)
 	{
 		case PlaneAxis::X:
@@ -267,7 +267,7 @@ void ColorIndices(vector<uint> &colorIndices)
     {
         RgbColor color;
         color.colorIndex = colorIndices[i];
-
+        
         colorComponents.push_back(color.components[0]);
         colorComponents.push_back(color.components[1]);
         colorComponents.push_back(color.components[2]);
@@ -281,34 +281,38 @@ void ColorIndices(vector<uint> &colorIndices)
 #endif
 }
 
+// colorIndices point to uint values in client memory or in the bound buffer
+void ColorIndexPointer(const GLvoid *colorIndices)
+{
 #if defined(RGB_SELECTION)
-const uint kMaxSelectedIndicesCount = 2000 * 2000;  // max width * max height resolution
-
-GLubyte colorBuffer[kMaxSelectedIndicesCount * 3];
+    // RgbColor keeps the low three bytes of the index
+    glColorPointer(3, GL_UNSIGNED_BYTE, sizeof(uint), colorIndices);
+#elif defined(RGBA_SELECTION)
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(uint), colorIndices);
 #endif
+}
 
-void ReadSelectedIndices(int x, int y, int width, int height, uint *selectedIndices)
+// RGBA pixels go to client memory or to the bound pixel pack buffer, four
+// bytes per pixel need no row alignment and no conversion by the driver
+void ReadSelectionPixels(int x, int y, int width, int height, GLvoid *pixels)
 {
-#if defined(RGB_SELECTION)
-    uint count = (uint)width * (uint)height;
-    
-    memset(colorBuffer, 0, count * 3);
-        
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glReadPixels(x, y, width, height, GL_RGB, GL_UNSIGNED_BYTE, colorBuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
     GetGLError();
+}
 
-    for (uint i = 0; i < count; i++)
-    {
-        RgbColor color;
-        color.components[0] = colorBuffer[i * 3 + 0];
-        color.components[1] = colorBuffer[i * 3 + 1];
-        color.components[2] = colorBuffer[i * 3 + 2];
-        
-        selectedIndices[i] = color.colorIndex;
-    }
+uint SelectionPixelMask()
+{
+#if defined(RGB_SELECTION)
+    // bytes of the pixel that RgbColor fills, alpha is not part of the index
+    RgbColor color;
+    color.colorIndex = 0xFFFFFF;
+    
+    GLubyte pixel[4] = { color.components[0], color.components[1], color.components[2], 0 };
+    uint mask;
+    memcpy(&mask, pixel, sizeof(uint));
+    return mask;
 #elif defined(RGBA_SELECTION)
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, selectedIndices);
+    return UINT_MAX;
 #endif
 }
@@ -105,4 +105,7 @@ void DrawPlane(Vector3D a, Vector3D b, float size);
 void DrawSelectionPlane(PlaneAxis plane);
 void ColorIndex(uint colorIndex);
 void ColorIndices(vector<uint> &colorIndices);
-void ReadSelectedIndices(int x, int y, int width, int height, uint *selectedIndices);
+void ColorIndexPointer(const GLvoid *colorIndices);
+void ReadSelectionPixels(int x, int y, int width, int height, GLvoid *pixels);
+// pixel & SelectionPixelMask() is the index passed to ColorIndex
+uint SelectionPixelMask();
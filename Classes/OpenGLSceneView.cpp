@@ -310,7 +310,8 @@ namespace MeshMakerCppCLI
 
 		virtual void setNeedsDisplay() 
 		{ 
-			_sceneView->Refresh();
+			// painted with the next WM_PAINT, Refresh would paint for every mouse event
+			_sceneView->Invalidate();
 		}
 
 		virtual void manipulationStarted() 
@@ -84,6 +84,12 @@ OpenGLSceneViewCore::OpenGLSceneViewCore(IOpenGLSceneViewCoreDelegate *delegate)
     
     _cameraMode = CameraMode::Perspective;
     
+    _selectionFrameSize = 0.0f;
+    
+    _pendingDragPoint = NSMakePoint(0, 0);
+    _hasPendingDrag = false;
+    _hasDrawnState = false;
+    
     _delegate = delegate;
 }
 
@@ -125,14 +131,14 @@ void OpenGLSceneViewCore::drawGrid(int size, int step)
 {
     float dark = 0.1f;
 	float light = 0.4f;
-	
+
 	glPushMatrix();
-	
+
 	if (_cameraMode == CameraMode::Front || _cameraMode == CameraMode::Back)
 		glRotatef(90.0f, 1, 0, 0);
 	else if (_cameraMode == CameraMode::Left || _cameraMode == CameraMode::Right)
 		glRotatef(90.0f, 0, 0, 1);
-	
+
 	glBegin(GL_LINES);
 	for (int x = -size; x <= size; x += step)
     {
@@ -140,7 +146,7 @@ void OpenGLSceneViewCore::drawGrid(int size, int step)
 			glColor3f(dark, dark, dark);
 		else
 			glColor3f(light, light, light);
-		
+        
         glVertex3i(x, 0, -size);
         glVertex3i(x, 0, size);
 	}
@@ -150,14 +156,14 @@ void OpenGLSceneViewCore::drawGrid(int size, int step)
 			glColor3f(dark, dark, dark);
 		else
 			glColor3f(light, light, light);
-		
+
 		glVertex3i(-size, 0, z);
         glVertex3i(size, 0, z);
     }
 	glEnd();
-	
+
 	glPopMatrix();
-    
+
 //    glPushMatrix();
 //    glMultMatrixf(_camera->GetRotationQuaternion().Conjugate().ToMatrix());
 //    
@@ -179,7 +185,7 @@ NSRect OpenGLSceneViewCore::currentRect()
 	float maxX = Max(_lastPoint.x, _currentPoint.x);
 	float minY = Min(_lastPoint.y, _currentPoint.y);
 	float maxY = Max(_lastPoint.y, _currentPoint.y);
-	
+
 	return NSMakeRect(minX, minY, maxX - minX, maxY - minY);
 }
 
@@ -217,15 +223,15 @@ void OpenGLSceneViewCore::applyProjection()
 {
     NSRect bounds = _delegate->bounds();
     float w_h = bounds.size.width / bounds.size.height;
-    
+
 	if (_cameraMode != CameraMode::Perspective)
 	{
 		float x = _camera->GetZoom() * w_h;
 		float y = _camera->GetZoom();
-		
+
 		x /= 2.0f;
 		y /= 2.0f;
-		
+
 		glOrtho(-x, x, -y, y, -maxDistance, maxDistance);
 	}
 	else
@@ -234,69 +240,87 @@ void OpenGLSceneViewCore::applyProjection()
 	}
 }
 
-const uint kMaxSelectedIndicesCount = 2000 * 2000;  // max width * max height resolution
-
-uint selectedIndices[kMaxSelectedIndicesCount];
-
-bool *OpenGLSceneViewCore::select(int x, int y, int width, int height, IOpenGLSelecting *selecting)
+// With reuseFrame the whole view is rendered and read once, later picks
+// with the same owner and camera only decode their rectangle from it.
+bool *OpenGLSceneViewCore::select(int x, int y, int width, int height, IOpenGLSelecting *selecting, bool reuseFrame)
 {
     IOpenGLSelectingOptional *optional = dynamic_cast<IOpenGLSelectingOptional *>(selecting);
     uint count = selecting->selectableCount();
     
-	glClearColor(0, 0, 0, 0);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (width <= 0 || height <= 0)
+        return NULL;
     
     setupViewportAndCamera();
     
-    glDisable(GL_LIGHTING);
-    glDisable(GL_TEXTURE_2D);
-    glDisable(GL_BLEND);
-
-    if (optional != NULL)
-    {
-        optional->drawAllForSelection();
-    }
-    else
+    if (!reuseFrame || !_selectionFrame.contains(selecting, count, x, y, width, height))
     {
-        for (uint i = 0; i < count; i++)
+        // only the rectangle is read, so only it is drawn and items outside
+        // of it are culled, see Item::isInViewFrustum
+        if (!reuseFrame)
+        {
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(x, y, width, height);
+        }
+        
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        
+        glDisable(GL_LIGHTING);
+        glDisable(GL_TEXTURE_2D);
+        glDisable(GL_BLEND);
+        
+        if (optional != NULL)
         {
-            uint colorIndex = i + 1;
-            ColorIndex(colorIndex);
-            selecting->drawForSelectionAtIndex(i);
+            optional->drawAllForSelection();
+        }
+        else
+        {
+            for (uint i = 0; i < count; i++)
+            {
+                uint colorIndex = i + 1;
+                ColorIndex(colorIndex);
+                selecting->drawForSelectionAtIndex(i);
+            }
         }
+        
+        glDisable(GL_SCISSOR_TEST);
+        
+        NSRect bounds = _delegate->bounds();
+        int viewWidth = (int)bounds.size.width;
+        int viewHeight = (int)bounds.size.height;
+        
+        // picks outside of the view are not cached
+        if (reuseFrame && x >= 0 && y >= 0 && x + width <= viewWidth && y + height <= viewHeight)
+            _selectionFrame.read(selecting, count, 0, 0, viewWidth, viewHeight);
+        else
+            _selectionFrame.read(selecting, count, x, y, width, height);
     }
     
-	glFinish();
-    
     uint selectedIndicesCount = (uint)width * (uint)height;
+    _selectedIndices.resize(selectedIndicesCount);
+    _selectionFrame.decode(x, y, width, height, &_selectedIndices[0]);
     
-    if (selectedIndicesCount >= kMaxSelectedIndicesCount)
-        return NULL;
+    // only reused frames stay valid, others depend on more than the camera
+    if (!reuseFrame)
+        _selectionFrame.invalidate();
+    
+    bool *selected = new bool[count];
+    for (uint i = 0; i < count; i++)
+        selected[i] = false;
     
-    if (selectedIndicesCount > 0)
+    for (uint i = 0; i < selectedIndicesCount; i++)
     {
-        ReadSelectedIndices(x, y, width, height, selectedIndices);
-        
-        bool *selected = new bool[count];
-        for (uint i = 0; i < count; i++)
-            selected[i] = false;
-        
-        for (uint i = 0; i < selectedIndicesCount; i++)
+        uint selectedIndex = _selectedIndices[i];
+        if (selectedIndex > 0)
         {
-            uint selectedIndex = selectedIndices[i];
-            if (selectedIndex > 0)
-            {
-                if (selectedIndex - 1 < count)
-                    selected[selectedIndex - 1] = true;
-//                else
-//                    NSLog(@"selectedIndex: %x", selectedIndex);
-            }
+            if (selectedIndex - 1 < count)
+                selected[selectedIndex - 1] = true;
+//            else
+//                NSLog(@"selectedIndex: %x", selectedIndex);
         }
-        
-        return selected;
     }
-
-    return NULL;
+    
+    return selected;
 }
 
 void OpenGLSceneViewCore::select(NSPoint point, IOpenGLSelecting *selecting, OpenGLSelectionMode selectionMode)
@@ -313,7 +337,26 @@ void OpenGLSceneViewCore::select(NSPoint point, IOpenGLSelecting *selecting, Ope
     
     _delegate->makeCurrentContext();
     
-	bool *selected = select(point.x - 5, point.y - 5, 10, 10, selecting);
+    // hover picks of the manipulator repeat with the same frame until the
+    // camera or the manipulator changes
+    bool reuseFrame = false;
+    Manipulator *manipulator = dynamic_cast<Manipulator *>(selecting);
+    
+    if (manipulator != NULL)
+    {
+        if (!(manipulator->position == _selectionFramePosition) ||
+            !(manipulator->rotation == _selectionFrameRotation) ||
+            manipulator->size != _selectionFrameSize)
+        {
+            _selectionFrame.invalidate();
+            _selectionFramePosition = manipulator->position;
+            _selectionFrameRotation = manipulator->rotation;
+            _selectionFrameSize = manipulator->size;
+        }
+        reuseFrame = true;
+    }
+
+	bool *selected = select(point.x - 5, point.y - 5, 10, 10, selecting, reuseFrame);
     if (selected != NULL)
     {
         for (uint i = 0; i < count; i++)
@@ -418,23 +461,23 @@ Vector3D OpenGLSceneViewCore::positionInSpaceByPoint(NSPoint point)
     double posX = 0.0, posY = 0.0, posZ = 0.0;
     
     _delegate->makeCurrentContext();
-	
+    
     glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
     glGetDoublev(GL_PROJECTION_MATRIX, projection);
     glGetIntegerv(GL_VIEWPORT, viewport);
-	
+    
     winX = point.x;
     winY = point.y;
     glReadPixels((int)winX, (int)winY, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &winZ);
     gluUnProject(winX, winY, winZ, modelview, projection, viewport, &posX, &posY, &posZ);
-	
+
 	return Vector3D((float)posX, (float)posY, (float)posZ);
 }
 
 void OpenGLSceneViewCore::drawSelectionPlane(int index)
 {
     Vector3D position = _manipulated->selectionCenter();
-	
+
 	glPushMatrix();
 	glTranslatef(position.x, position.y, position.z);
 	DrawSelectionPlane((PlaneAxis)((int)PlaneAxis::X + index));
@@ -444,7 +487,7 @@ void OpenGLSceneViewCore::drawSelectionPlane(int index)
 Vector3D OpenGLSceneViewCore::positionFromAxisPoint(Axis axis, NSPoint point)
 {
 	DrawPlane(_camera->GetAxisX(), _camera->GetAxisY(), planeSize);
-	
+
 	Vector3D position = positionInSpaceByPoint(point);
 	Vector3D result = _manipulated->selectionCenter();
 	result[(int)axis] = position[(int)axis];
@@ -454,7 +497,7 @@ Vector3D OpenGLSceneViewCore::positionFromAxisPoint(Axis axis, NSPoint point)
 Vector3D OpenGLSceneViewCore::positionFromRotatedAxisPoint(Axis axis, NSPoint point, Quaternion rotation)
 {
     DrawPlane(_camera->GetAxisX(), _camera->GetAxisY(), planeSize);
-	
+
 	Vector3D position = positionInSpaceByPoint(point);
 	Vector3D result = _manipulated->selectionCenter();
 	position = rotation.Conjugate().ToMatrix().Transform(position);
@@ -479,7 +522,7 @@ Vector3D OpenGLSceneViewCore::addVertexPositionFromPoint(NSPoint point)
     glLoadMatrixf(_camera->GetViewMatrix());
     
     Vector3D position = _manipulated->selectionCenter();
-	
+
 	glPushMatrix();
 	glTranslatef(position.x, position.y, position.z);
     glMultMatrixf(_camera->GetRotationQuaternion().Conjugate().ToMatrix());
@@ -496,15 +539,15 @@ Vector3D OpenGLSceneViewCore::translationFromPoint(NSPoint point)
 	_delegate->makeCurrentContext();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glLoadMatrixf(_camera->GetViewMatrix());
-	
+
 	Vector3D position = _manipulated->selectionCenter();
 	uint selectedIndex = _currentManipulator->selectedIndex;
-	
+
 	if (selectedIndex <= (uint)Axis::Z)
         return positionFromAxisPoint((Axis)selectedIndex, point);
 	if (selectedIndex >= (uint)PlaneAxis::X && selectedIndex <= (uint)PlaneAxis::Z)
         return positionFromPlaneAxis((PlaneAxis)selectedIndex, point);
-	
+
 	return position;
 }
 
@@ -513,12 +556,12 @@ Vector3D OpenGLSceneViewCore::scaleFromPoint(NSPoint point, Vector3D &lastPositi
 	_delegate->makeCurrentContext();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glLoadMatrixf(_camera->GetViewMatrix());
-	
+
 	Vector3D position = _manipulated->selectionCenter();
 	uint selectedIndex = _currentManipulator->selectedIndex;
-	
+
 	Vector3D scale = Vector3D();
-	
+
 	if (selectedIndex < UINT_MAX)
 	{
 		ManipulatorWidget &selectedWidget = _currentManipulator->widgetAtIndex(selectedIndex);
@@ -535,11 +578,11 @@ Vector3D OpenGLSceneViewCore::scaleFromPoint(NSPoint point, Vector3D &lastPositi
             scale.y = scale.x;
             scale.z = scale.x;
 		}
-		
+
 		lastPosition = position;
 		scale *= 2.0f;
 	}
-    
+
 	return scale;
 }
 
@@ -548,16 +591,16 @@ Quaternion OpenGLSceneViewCore::rotationFromPoint(NSPoint point, Vector3D &lastP
 	_delegate->makeCurrentContext();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glLoadMatrixf(_camera->GetViewMatrix());
-	
+
 	Quaternion quaternion;
 	Vector3D position;
 	float angle;
-	
+
 	uint selectedIndex = _currentManipulator->selectedIndex;
-	
+
 	position = this->positionFromPlaneAxis((PlaneAxis)(selectedIndex + 3), point);
 	position -= _manipulated->selectionCenter();
-	
+
 	switch ((Axis)selectedIndex)
     {
 		case Axis::X:
@@ -575,7 +618,7 @@ Quaternion OpenGLSceneViewCore::rotationFromPoint(NSPoint point, Vector3D &lastP
         default:
             break;
 	}
-	
+
 	lastPosition = position;
 	return quaternion;
 }
@@ -592,7 +635,7 @@ void OpenGLSceneViewCore::setupViewportAndCamera()
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
     applyProjection();
-	
+
 	glMatrixMode(GL_MODELVIEW);
 	glLoadMatrixf(_camera->GetViewMatrix());
 }
@@ -702,7 +745,7 @@ void OpenGLSceneViewCore::drawCurrentManipulator()
     if (_manipulated != NULL && _manipulated->selectedCount() > 0)
 	{
         _currentManipulator->position = _manipulated->selectionCenter();
-        
+
 		if (_cameraMode == CameraMode::Perspective)
         {
             Vector3D manipulatorPosition = _manipulated->selectionCenter();
@@ -743,11 +786,101 @@ void OpenGLSceneViewCore::drawSelectionRect()
 	}
 }
 
+static bool samePoint(NSPoint a, NSPoint b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+static bool sameState(const OpenGLSceneViewState &a, const OpenGLSceneViewState &b)
+{
+    if (a.cameraRadians != b.cameraRadians || a.cameraZoom != b.cameraZoom || a.cameraCenter != b.cameraCenter)
+        return false;
+    if (a.cameraMode != b.cameraMode || a.highlightCameraMode != b.highlightCameraMode)
+        return false;
+    if (a.manipulator != b.manipulator || a.manipulatorIndex != b.manipulatorIndex)
+        return false;
+    if (a.isSelecting != b.isSelecting)
+        return false;
+    if (a.isSelecting && (!samePoint(a.selectionStart, b.selectionStart) || !samePoint(a.selectionEnd, b.selectionEnd)))
+        return false;
+    if (a.vertexHints.size() != b.vertexHints.size())
+        return false;
+    
+    for (uint i = 0; i < a.vertexHints.size(); i++)
+    {
+        if (a.vertexHints[i] != b.vertexHints[i])
+            return false;
+    }
+    
+    return true;
+}
+
+OpenGLSceneViewState OpenGLSceneViewCore::currentState()
+{
+    OpenGLSceneViewState state;
+    state.cameraRadians = _camera->GetRadians();
+    state.cameraZoom = _camera->GetZoom();
+    state.cameraCenter = _camera->GetCenter();
+    state.cameraMode = _cameraMode;
+    state.manipulator = _currentManipulator;
+    state.manipulatorIndex = _currentManipulator->selectedIndex;
+    state.highlightCameraMode = _highlightCameraMode;
+    state.isSelecting = _isSelecting;
+    state.selectionStart = _lastPoint;
+    state.selectionEnd = _currentPoint;
+    state.vertexHints = _vertexHints;
+    return state;
+}
+
+// Scene changes are redrawn by the document on all views, core view itself
+// changes only the camera and highlights.
+void OpenGLSceneViewCore::setNeedsDisplayIfChanged()
+{
+    if (_hasPendingDrag || !_hasDrawnState || !sameState(currentState(), _drawnState))
+        _delegate->setNeedsDisplay();
+}
+
+void OpenGLSceneViewCore::applyPendingDrag()
+{
+    if (!_hasPendingDrag)
+        return;
+    
+    _hasPendingDrag = false;
+    
+    if (!_isManipulating || _manipulated == NULL)
+        return;
+    
+    // helpers below unproject the point with the matrices of this view
+    _delegate->makeCurrentContext();
+    setupViewportAndCamera();
+    
+    if (_currentManipulator == _translationManipulator)
+    {
+        Vector3D move = translationFromPoint(_pendingDragPoint);
+        move -= _selectionOffset;
+        move -= _manipulated->selectionCenter();
+        _manipulated->moveSelectedByOffset(move);
+    }
+    else if (_currentManipulator == _rotationManipulator)
+    {
+        Quaternion rotation = rotationFromPoint(_pendingDragPoint, _selectionOffset);
+        _manipulated->rotateSelectedByOffset(rotation);
+    }
+    else if (_currentManipulator == _scaleManipulator)
+    {
+        Vector3D scale = scaleFromPoint(_pendingDragPoint, _selectionOffset);
+        _manipulated->scaleSelectedByOffset(scale);
+    }
+}
+
 void OpenGLSceneViewCore::draw()
 {
 #if defined(__APPLE__) || defined(SHADERS)
     ShaderProgram::resetProgram();
 #endif
+    // mesh caches are updated once for all drag events since the last frame
+    applyPendingDrag();
+
 	float clearColor = 0.6f;
 	glClearColor(clearColor, clearColor, clearColor, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -757,7 +890,7 @@ void OpenGLSceneViewCore::draw()
 	setupViewportAndCamera();
     drawGrid(10, 2);
     drawManipulatedAndDisplatedForSelection(false);
-    
+
 	glDisable(GL_TEXTURE_2D);
 	glDisable(GL_DEPTH_TEST);
 	glEnable(GL_BLEND);
@@ -785,8 +918,11 @@ void OpenGLSceneViewCore::draw()
     
     drawOrthoDefaultManipulator();
     drawSelectionRect();
-	
+    
     glEnable(GL_DEPTH_TEST);
+    
+    _drawnState = currentState();
+    _hasDrawnState = true;
 }
 
 void OpenGLSceneViewCore::mouseDown(NSPoint point, bool alt)
@@ -799,7 +935,7 @@ void OpenGLSceneViewCore::mouseDown(NSPoint point, bool alt)
 		_isManipulating = _isSelecting = false;
 		return;
 	}
-    
+
 	if (_highlightCameraMode)
 	{
 		switch (_cameraMode)
@@ -855,7 +991,7 @@ void OpenGLSceneViewCore::mouseDown(NSPoint point, bool alt)
             scaleFromPoint(_lastPoint, _selectionOffset);
 			_isManipulating = true;
 		}
-
+        
         if (_isManipulating)
             _delegate->manipulationStarted();
 	}
@@ -879,38 +1015,41 @@ void OpenGLSceneViewCore::mouseMoved(NSPoint point)
             if (_currentManipulator != _defaultManipulator)
             {
                 select(_currentPoint, _currentManipulator, OpenGLSelectionMode::Add);
-                _delegate->setNeedsDisplay();
+                setNeedsDisplayIfChanged();
             }
 		}
 	}
-	
+
 	if (_currentManipulator->selectedIndex == UINT_MAX)
 	{
 		if (NSPointInRect(_currentPoint, orthoManipulatorRect()))
 			_highlightCameraMode = true;
-        _delegate->setNeedsDisplay();
+        setNeedsDisplayIfChanged();
 	}
     
     if (_delegate->vertexToolEnabled())
     {
         Vector3D position = addVertexPositionFromPoint(point);
         _delegate->vertexAddOrConnectHint(position, _camera, _vertexHints);
-        _delegate->setNeedsDisplay();
+        setNeedsDisplayIfChanged();
     }
 }
 
 void OpenGLSceneViewCore::mouseExited()
 {
     _highlightCameraMode = false;
-    _delegate->setNeedsDisplay();
+    setNeedsDisplayIfChanged();
 }
 
 void OpenGLSceneViewCore::mouseUp(NSPoint point, bool alt, bool cmd, bool ctrl, bool shift, int clickCount)
 {
     _isPainting = false;
-    
+
 	_currentPoint = point;
-	
+    
+    // the last drag has to be in the undo state of the manipulation
+    applyPendingDrag();
+
 	if (_isManipulating)
 	{
         _delegate->manipulationEnded();
@@ -924,14 +1063,14 @@ void OpenGLSceneViewCore::mouseUp(NSPoint point, bool alt, bool cmd, bool ctrl,
 		if (_manipulated != NULL)
 		{
 			OpenGLSelectionMode selectionMode = OpenGLSelectionMode::Add;
-	        
+
 			if (cmd)
 				selectionMode = OpenGLSelectionMode::Invert;
 			else if (shift)
 				selectionMode = OpenGLSelectionMode::Add;
 			else
 				_manipulated->changeSelection(false);
-			
+
 			NSRect rect = currentRect();
 			if (clickCount <= 1 && rect.size.width > 5.0f && rect.size.height > 5.0f)
 			{
@@ -946,13 +1085,13 @@ void OpenGLSceneViewCore::mouseUp(NSPoint point, bool alt, bool cmd, bool ctrl,
 					else
 						selectionMode = OpenGLSelectionMode::Expand;
 				}
-	            
+
 				select(_currentPoint, _manipulated, selectionMode);
 			}
-			
+
 			_delegate->selectionChanged();
 		}
-
+        
         _delegate->setNeedsDisplay();
 	}
 }
@@ -962,7 +1101,7 @@ void OpenGLSceneViewCore::mouseDragged(NSPoint point, bool alt, bool cmd)
     _currentPoint = point;
 	float deltaX = _currentPoint.x - _lastPoint.x;
 	float deltaY = _currentPoint.y - _lastPoint.y;
-    
+
 	if (alt && cmd)
 	{
         NSRect bounds = _delegate->bounds();
@@ -973,7 +1112,7 @@ void OpenGLSceneViewCore::mouseDragged(NSPoint point, bool alt, bool cmd)
         sensitivity *= _camera->GetZoom() * 1.12f;
 		_camera->LeftRight(-deltaX * sensitivity);
 		_camera->UpDown(deltaY * sensitivity);
-		
+
 		_lastPoint = _currentPoint;
         _delegate->setNeedsDisplay();
 	}
@@ -996,30 +1135,15 @@ void OpenGLSceneViewCore::mouseDragged(NSPoint point, bool alt, bool cmd)
     else if (_isManipulating)
 	{
 		_lastPoint = _currentPoint;
-		if (_currentManipulator == _translationManipulator)
-		{
-			Vector3D move = translationFromPoint(_currentPoint);
-			move -= _selectionOffset;
-			move -= _manipulated->selectionCenter();
-            _manipulated->moveSelectedByOffset(move);
-            _delegate->setNeedsDisplay();
-		}
-		else if (_currentManipulator == _rotationManipulator)
-		{
-			Quaternion rotation = rotationFromPoint(_currentPoint, _selectionOffset);
-            _manipulated->rotateSelectedByOffset(rotation);
-            _delegate->setNeedsDisplay();
-		}
-		else if (_currentManipulator == _scaleManipulator)
-		{
-			Vector3D scale = scaleFromPoint(_currentPoint, _selectionOffset);
-            _manipulated->scaleSelectedByOffset(scale);
-			_delegate->setNeedsDisplay();
-		}
+        // several drags can arrive before the next frame, transforming
+        // for each of them would update mesh caches for nothing
+        _pendingDragPoint = _currentPoint;
+        _hasPendingDrag = true;
+        _delegate->setNeedsDisplay();
 	}
 	else if (_isSelecting)
 	{
-        _delegate->setNeedsDisplay();
+        setNeedsDisplayIfChanged();
 	}
 }
 
@@ -1033,7 +1157,7 @@ void OpenGLSceneViewCore::otherMouseDragged(NSPoint point, bool alt)
     _currentPoint = point;
 	float deltaX = _currentPoint.x - _lastPoint.x;
 	float deltaY = _currentPoint.y - _lastPoint.y;
-	
+
 	if (alt)
 	{
 		NSRect bounds = _delegate->bounds();
@@ -1043,7 +1167,7 @@ void OpenGLSceneViewCore::otherMouseDragged(NSPoint point, bool alt)
 		sensitivity = 1.0f / sensitivity;
 		_camera->LeftRight(-deltaX * _camera->GetZoom() * sensitivity);
 		_camera->UpDown(deltaY * _camera->GetZoom() * sensitivity);
-		
+
 		_lastPoint = _currentPoint;
         _delegate->setNeedsDisplay();
 	}
@@ -1058,13 +1182,13 @@ void OpenGLSceneViewCore::rightMouseDragged(NSPoint point, bool alt)
 {
     _currentPoint = point;
 	float deltaY = _currentPoint.y - _lastPoint.y;
-	
+
 	if (alt)
 	{
 		float sensitivity = _camera->GetZoom() * 0.02f;
-		
+
 		_camera->Zoom(-deltaY * sensitivity);
-		
+
 		_lastPoint = _currentPoint;
         _delegate->setNeedsDisplay();
 	}
@@ -26,12 +26,13 @@
 #include "Mesh2.h"
 #include "ItemCollection.h"
 #include "Drawing2D.h"
+#include "SelectionFrame.h"
 
 class IOpenGLSceneViewCoreDelegate
 {
 public:
     virtual ~IOpenGLSceneViewCoreDelegate() { }
-
+    
     virtual NSRect bounds() = 0;
     virtual void setNeedsDisplay() = 0;
     virtual void manipulationStarted() = 0;
@@ -44,13 +45,31 @@ public:
     virtual void makeCurrentContext() = 0;
 };
 
+// Everything a frame of a scene view shows besides the scene itself. Core
+// view redraws only when it differs from the state of the last frame, so mouse
+// moves which do not change any highlight do not redraw the view.
+struct OpenGLSceneViewState
+{
+    Vector2D cameraRadians;
+    float cameraZoom;
+    Vector3D cameraCenter;
+    CameraMode cameraMode;
+    Manipulator *manipulator;
+    uint manipulatorIndex;
+    bool highlightCameraMode;
+    bool isSelecting;
+    NSPoint selectionStart;
+    NSPoint selectionEnd;
+    vector<Vector3D> vertexHints;
+};
+
 class OpenGLSceneViewCore
 {
 public:
     IOpenGLSceneViewCoreDelegate *_delegate;
     IOpenGLManipulating *_displayed;
     IOpenGLManipulating *_manipulated;
-    
+
 	Vector3D _selectionOffset;
 	Camera *_camera;
 	Vector2D _perspectiveRadians;
@@ -68,6 +87,20 @@ public:
 	CameraMode _cameraMode;
     vector<Vector3D> _vertexHints;
     
+    SelectionFrame _selectionFrame;
+    vector<uint> _selectedIndices;
+    // manipulator state the selection frame was rendered with
+    Vector3D _selectionFramePosition;
+    Quaternion _selectionFrameRotation;
+    float _selectionFrameSize;
+    
+    // drags are applied once per frame, only the last point is kept
+    NSPoint _pendingDragPoint;
+    bool _hasPendingDrag;
+    
+    OpenGLSceneViewState _drawnState;
+    bool _hasDrawnState;
+    
     static bool _alwaysSelectThrough;    
 public:
     OpenGLSceneViewCore(IOpenGLSceneViewCoreDelegate *delegate);
@@ -84,7 +117,7 @@ public:
     void beginOrtho();
     void endOrtho();
     void applyProjection();
-    bool *select(int x, int y, int width, int height, IOpenGLSelecting *selecting);
+    bool *select(int x, int y, int width, int height, IOpenGLSelecting *selecting, bool reuseFrame = false);
     void select(NSPoint point, IOpenGLSelecting *selecting, OpenGLSelectionMode selectionMode);
     void select(NSRect rect, IOpenGLSelecting *selecting, OpenGLSelectionMode selectionMode, bool selectThrough);
     Vector3D positionInSpaceByPoint(NSPoint point);
@@ -106,6 +139,9 @@ public:
     void drawOrthoDefaultManipulator();
     void drawCurrentManipulator();
     void drawSelectionRect();
+    OpenGLSceneViewState currentState();
+    void setNeedsDisplayIfChanged();
+    void applyPendingDrag();
     void draw();
     void mouseDown(NSPoint point, bool alt);
     void mouseMoved(NSPoint point);
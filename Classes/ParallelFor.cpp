@@ -0,0 +1,135 @@
+//
+//  ParallelFor.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "ParallelFor.h"
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#include <unistd.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <vector>
+
+using namespace std;
+
+struct ParallelForJob
+{
+    ParallelForFunction function;
+    void *context;
+    uint count;
+    uint rangeSize;
+    
+    void run(uint range) const
+    {
+        uint first = range * rangeSize;
+        uint last = first + rangeSize;
+        if (last > count)
+            last = count;
+        if (first < last)
+            function(context, first, last);
+    }
+};
+
+#if defined(__APPLE__)
+
+static void ParallelForDispatch(void *context, size_t range)
+{
+    ParallelForJob *job = (ParallelForJob *)context;
+    job->run((uint)range);
+}
+
+#elif defined(__linux__)
+
+struct ParallelForThread
+{
+    pthread_t thread;
+    const ParallelForJob *job;
+    uint range;
+};
+
+static void *ParallelForThreadMain(void *context)
+{
+    ParallelForThread *thread = (ParallelForThread *)context;
+    thread->job->run(thread->range);
+    return NULL;
+}
+
+#endif
+
+uint ParallelForThreadCount()
+{
+#if defined(__APPLE__) || defined(__linux__)
+    static uint threadCount = 0;
+    if (threadCount == 0)
+    {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = processors > 1 ? (uint)processors : 1U;
+    }
+    return threadCount;
+#else
+    // native threads calling back into /clr code are not worth the trouble
+    return 1U;
+#endif
+}
+
+void ParallelFor(uint count, uint minimumRange, ParallelForFunction function, void *context)
+{
+    if (count == 0)
+        return;
+    
+    if (minimumRange == 0)
+        minimumRange = 1;
+    
+    uint rangeCount = count / minimumRange;
+    uint threadCount = ParallelForThreadCount();
+    if (rangeCount > threadCount)
+        rangeCount = threadCount;
+    
+    if (rangeCount <= 1)
+    {
+        function(context, 0, count);
+        return;
+    }
+    
+    ParallelForJob job;
+    job.function = function;
+    job.context = context;
+    job.count = count;
+    job.rangeSize = (count + rangeCount - 1) / rangeCount;
+
+#if defined(__APPLE__)
+    dispatch_apply_f(rangeCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), &job, ParallelForDispatch);
+#elif defined(__linux__)
+    // the caller takes the first range, failed threads run their range here
+    vector<ParallelForThread> threads(rangeCount);
+    vector<bool> started(rangeCount, false);
+    
+    for (uint i = 1; i < rangeCount; i++)
+    {
+        threads[i].job = &job;
+        threads[i].range = i;
+        started[i] = pthread_create(&threads[i].thread, NULL, ParallelForThreadMain, &threads[i]) == 0;
+    }
+    
+    job.run(0);
+    
+    for (uint i = 1; i < rangeCount; i++)
+    {
+        if (started[i])
+            pthread_join(threads[i].thread, NULL);
+        else
+            job.run(i);
+    }
+#else
+    for (uint i = 0; i < rangeCount; i++)
+        job.run(i);
+#endif
+}
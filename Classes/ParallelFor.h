@@ -0,0 +1,36 @@
+//
+//  ParallelFor.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "Enums.h"
+
+typedef void (*ParallelForFunction)(void *context, uint first, uint last);
+
+// Number of worker threads ParallelFor splits work into.
+uint ParallelForThreadCount();
+
+// Calls function for disjoint ranges [first, last) covering [0, count) and
+// returns after all of them finished. Ranges run on worker threads when
+// count is at least minimumRange, so function must not write to anything
+// shared by other ranges. Managed builds run everything on the caller.
+void ParallelFor(uint count, uint minimumRange, ParallelForFunction function, void *context);
+
+template <class TBody>
+void ParallelForBodyFunction(void *context, uint first, uint last)
+{
+    TBody *body = (TBody *)context;
+    (*body)(first, last);
+}
+
+// body is an object with void operator()(uint first, uint last)
+template <class TBody>
+void ParallelFor(uint count, uint minimumRange, TBody &body)
+{
+    ParallelFor(count, minimumRange, ParallelForBodyFunction<TBody>, &body);
+}
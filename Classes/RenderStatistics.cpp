@@ -0,0 +1,78 @@
+//
+//  RenderStatistics.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "RenderStatistics.h"
+#include <stddef.h>
+
+#if defined(__APPLE__)
+#include <mach/mach_time.h>
+#elif defined(WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static double phaseTotals[RenderPhaseCount] = { 0.0, 0.0, 0.0 };
+
+double RenderStatistics::seconds()
+{
+#if defined(__APPLE__)
+    static mach_timebase_info_data_t timebase = { 0, 0 };
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom * 1.0e-9;
+#elif defined(WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1.0e-9;
+#endif
+}
+
+void RenderStatistics::reset()
+{
+    for (uint i = 0; i < RenderPhaseCount; i++)
+        phaseTotals[i] = 0.0;
+}
+
+void RenderStatistics::add(RenderPhase phase, double seconds)
+{
+    phaseTotals[(uint)phase] += seconds;
+}
+
+double RenderStatistics::total(RenderPhase phase)
+{
+    return phaseTotals[(uint)phase];
+}
+
+RenderStatisticsScope *RenderStatisticsScope::_current = NULL;
+
+RenderStatisticsScope::RenderStatisticsScope(RenderPhase phase)
+{
+    _phase = phase;
+    _start = RenderStatistics::seconds();
+    _parent = _current;
+    _current = this;
+    
+    if (_parent != NULL)
+        RenderStatistics::add(_parent->_phase, _start - _parent->_start);
+}
+
+RenderStatisticsScope::~RenderStatisticsScope()
+{
+    double end = RenderStatistics::seconds();
+    RenderStatistics::add(_phase, end - _start);
+    _current = _parent;
+    
+    if (_parent != NULL)
+        _parent->_start = end;
+}
@@ -0,0 +1,55 @@
+//
+//  RenderStatistics.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "Enums.h"
+
+EnumClass RenderPhase
+{
+    CacheFill = 0,
+    Upload,
+    Draw
+};
+
+const uint RenderPhaseCount = 3;
+
+// CPU time spent in phases of mesh drawing, summed until reset. Drawing code
+// reports to it only when RENDER_STATISTICS is defined, like in the
+// MeshMakerBenchmark project, other builds do not time anything.
+class RenderStatistics
+{
+public:
+    // monotonic clock in seconds
+    static double seconds();
+    
+    static void reset();
+    static void add(RenderPhase phase, double seconds);
+    static double total(RenderPhase phase);
+};
+
+// Times its lifetime into the phase. A nested scope pauses the enclosing
+// one, so a cache fill inside of a draw counts only as a cache fill.
+class RenderStatisticsScope
+{
+private:
+    static RenderStatisticsScope *_current;
+    
+    RenderStatisticsScope *_parent;
+    RenderPhase _phase;
+    double _start;
+public:
+    RenderStatisticsScope(RenderPhase phase);
+    ~RenderStatisticsScope();
+};
+
+#if defined(RENDER_STATISTICS)
+#define RENDER_STATISTICS_SCOPE(phase) RenderStatisticsScope renderStatisticsScope(phase)
+#else
+#define RENDER_STATISTICS_SCOPE(phase)
+#endif
@@ -419,6 +419,7 @@
         for (uint i = 0; i < items->count(); i++)
         {
             Item *item = items->itemAtIndex(i);
+            item->makeMeshUnique();
             item->mesh->resetTriangleCache();
             item->mesh->resetAlgorithmData();
         }
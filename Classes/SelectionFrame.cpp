@@ -0,0 +1,139 @@
+//
+//  SelectionFrame.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "SelectionFrame.h"
+#include <cstring>
+
+SelectionFrame::SelectionFrame()
+{
+    _pboID = 0U;
+    _pboGenerated = false;
+    _mapped = false;
+    
+    _x = _y = _width = _height = 0;
+    _valid = false;
+    
+    _owner = NULL;
+    _ownerCount = 0;
+    _cullFace = false;
+}
+
+SelectionFrame::~SelectionFrame()
+{
+#if defined(__APPLE__) || defined(SHADERS)
+    if (_pboGenerated)
+        glDeleteBuffers(1, &_pboID);
+#endif
+}
+
+bool SelectionFrame::contains(const void *owner, uint ownerCount, int x, int y, int width, int height) const
+{
+    if (!_valid || owner != _owner || ownerCount != _ownerCount)
+        return false;
+    
+    if (x < _x || y < _y || x + width > _x + _width || y + height > _y + _height)
+        return false;
+    
+    if ((glIsEnabled(GL_CULL_FACE) == GL_TRUE) != _cullFace)
+        return false;
+    
+    float modelview[16];
+    float projection[16];
+    int viewport[4];
+    
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    glGetFloatv(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    
+    return memcmp(modelview, _modelview, sizeof(modelview)) == 0 &&
+           memcmp(projection, _projection, sizeof(projection)) == 0 &&
+           memcmp(viewport, _viewport, sizeof(viewport)) == 0;
+}
+
+void SelectionFrame::read(const void *owner, uint ownerCount, int x, int y, int width, int height)
+{
+    _owner = owner;
+    _ownerCount = ownerCount;
+    _cullFace = glIsEnabled(GL_CULL_FACE) == GL_TRUE;
+    
+    glGetFloatv(GL_MODELVIEW_MATRIX, _modelview);
+    glGetFloatv(GL_PROJECTION_MATRIX, _projection);
+    glGetIntegerv(GL_VIEWPORT, _viewport);
+    
+    _x = x;
+    _y = y;
+    _width = max(width, 0);
+    _height = max(height, 0);
+    _valid = true;
+    
+    uint count = (uint)_width * (uint)_height;
+    _pixels.resize(count);
+    
+    if (count == 0)
+    {
+        _mapped = true;
+        return;
+    }
+
+#if defined(__APPLE__) || defined(SHADERS)
+    if (!_pboGenerated)
+    {
+        glGenBuffers(1, &_pboID);
+        _pboGenerated = true;
+    }
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pboID);
+    glBufferData(GL_PIXEL_PACK_BUFFER, count * sizeof(uint), NULL, GL_STREAM_READ);
+    ReadSelectionPixels(_x, _y, _width, _height, NULL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    
+    _mapped = false;
+#else
+    ReadSelectionPixels(_x, _y, _width, _height, &_pixels[0]);
+    _mapped = true;
+#endif
+}
+
+void SelectionFrame::map()
+{
+#if defined(__APPLE__) || defined(SHADERS)
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _pboID);
+    
+    // waits for the read of this frame, not for the whole pipeline like glFinish
+    const GLvoid *pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (pixels != NULL)
+    {
+        memcpy(&_pixels[0], pixels, _pixels.size() * sizeof(uint));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+    {
+        memset(&_pixels[0], 0, _pixels.size() * sizeof(uint));
+    }
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+#endif
+    _mapped = true;
+}
+
+void SelectionFrame::decode(int x, int y, int width, int height, uint *indices)
+{
+    if (!_mapped)
+        map();
+    
+    uint mask = SelectionPixelMask();
+    
+    for (int row = 0; row < height; row++)
+    {
+        const uint *source = &_pixels[(row + y - _y) * _width + x - _x];
+        uint *destination = indices + row * width;
+        
+        for (int column = 0; column < width; column++)
+            destination[column] = source[column] & mask;
+    }
+}
@@ -0,0 +1,55 @@
+//
+//  SelectionFrame.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "OpenGLDrawing.h"
+
+// Color indices of the last selection pass. Pixels are read to a pixel
+// buffer object, which is mapped when the first pick decodes them. Mapping
+// waits for that read, but not for the whole pipeline like glFinish. The
+// frame remembers what it was rendered with, so later picks inside it can
+// skip rendering and reading.
+class SelectionFrame
+{
+private:
+    uint _pboID;
+    bool _pboGenerated;
+    bool _mapped;
+    
+    vector<uint> _pixels;
+    int _x, _y, _width, _height;
+    bool _valid;
+    
+    const void *_owner;
+    uint _ownerCount;
+    bool _cullFace;
+    float _modelview[16];
+    float _projection[16];
+    int _viewport[4];
+    
+    void map();
+    
+    SelectionFrame(const SelectionFrame &);
+    SelectionFrame &operator=(const SelectionFrame &);
+public:
+    SelectionFrame();
+    ~SelectionFrame();
+    
+    void invalidate() { _valid = false; }
+    
+    // true when current GL matrices, viewport and culling match the frame
+    // of the same owner and the rectangle lies inside of it
+    bool contains(const void *owner, uint ownerCount, int x, int y, int width, int height) const;
+    
+    // call right after the selection pass while its matrices are loaded
+    void read(const void *owner, uint ownerCount, int x, int y, int width, int height);
+    
+    // color indices of the rectangle, which has to be inside the frame
+    void decode(int x, int y, int width, int height, uint *indices);
+};
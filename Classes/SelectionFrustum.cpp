@@ -0,0 +1,517 @@
+//
+//  SelectionFrustum.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "SelectionFrustum.h"
+#include "ParallelFor.h"
+#include <algorithm>
+
+// SSE kernels are not used in managed code of the C++/CLI build
+#if !defined(_MANAGED) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define SELECTION_SSE
+#include <xmmintrin.h>
+#endif
+
+// a triangle clipped by six planes has at most nine vertices
+const uint ClippedPolygonMaximumCount = 12;
+
+// depth rows per thread, rasterizing fewer is not worth starting threads for
+const uint DepthMinimumRange = 32;
+
+// longer segments are sampled at this many points at most
+const uint SegmentMaximumSamples = 4096;
+
+// constant part of the occluder offset, like units in glPolygonOffset
+const float DepthBias = 1.0e-5f;
+
+static void multiplyMatrices(const float *a, const float *b, float *result)
+{
+    for (uint column = 0; column < 4; column++)
+    {
+        for (uint row = 0; row < 4; row++)
+        {
+            float sum = 0.0f;
+            for (uint k = 0; k < 4; k++)
+                sum += a[row + k * 4] * b[k + column * 4];
+            result[row + column * 4] = sum;
+        }
+    }
+}
+
+static float planeDistance(const float *plane, const Vector3D &v)
+{
+    return plane[0] * v.x + plane[1] * v.y + plane[2] * v.z + plane[3];
+}
+
+#if defined(SELECTION_SSE)
+
+// four packed Vector3D positions to separate x, y, z registers
+static inline void loadPositions(const float *p, __m128 &x, __m128 &y, __m128 &z)
+{
+    __m128 a = _mm_loadu_ps(p);
+    __m128 b = _mm_loadu_ps(p + 4);
+    __m128 c = _mm_loadu_ps(p + 8);
+    
+    __m128 x2y2x3y3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    __m128 y0z0y1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    
+    x = _mm_shuffle_ps(a, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm_shuffle_ps(y0z0y1z1, c, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+#endif
+
+static float edgeFunction(const SelectionFrustum::ScreenVertex &a, const SelectionFrustum::ScreenVertex &b, float x, float y)
+{
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+// Calls visitor(pixel, depth) for depth buffer pixels in rows [firstRow, lastRow)
+// with centers inside the triangle, stops as soon as visitor returns true.
+template <class TVisitor>
+static bool rasterizeTriangle(const SelectionFrustum::ScreenTriangle &triangle, uint width, uint firstRow, uint lastRow, TVisitor &visitor)
+{
+    const SelectionFrustum::ScreenVertex &a = triangle.vertices[0];
+    const SelectionFrustum::ScreenVertex &b = triangle.vertices[1];
+    const SelectionFrustum::ScreenVertex &c = triangle.vertices[2];
+    
+    float area = edgeFunction(a, b, c.x, c.y);
+    if (fabsf(area) < FLOAT_EPS)
+        return false;
+    
+    float minimumX = min(a.x, min(b.x, c.x));
+    float maximumX = max(a.x, max(b.x, c.x));
+    float minimumY = min(a.y, min(b.y, c.y));
+    float maximumY = max(a.y, max(b.y, c.y));
+    
+    if (maximumX < 0.0f || maximumY < (float)firstRow || minimumX >= (float)width || minimumY >= (float)lastRow)
+        return false;
+    
+    uint firstX = (uint)max(0.0f, floorf(minimumX));
+    uint lastX = (uint)min((float)width, ceilf(maximumX));
+    uint firstY = max(firstRow, (uint)max(0.0f, floorf(minimumY)));
+    uint lastY = min(lastRow, (uint)ceilf(maximumY));
+    
+    float invArea = 1.0f / area;
+    
+    for (uint y = firstY; y < lastY; y++)
+    {
+        float centerY = (float)y + 0.5f;
+        
+        for (uint x = firstX; x < lastX; x++)
+        {
+            float centerX = (float)x + 0.5f;
+            
+            float w0 = edgeFunction(b, c, centerX, centerY) * invArea;
+            float w1 = edgeFunction(c, a, centerX, centerY) * invArea;
+            float w2 = edgeFunction(a, b, centerX, centerY) * invArea;
+            
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                continue;
+            
+            if (visitor(y * width + x, w0 * a.depth + w1 * b.depth + w2 * c.depth))
+                return true;
+        }
+    }
+    
+    return false;
+}
+
+// keeps the nearest occluder depth, pushed back by the depth slope
+struct WriteDepth
+{
+    float *depths;
+    float offset;
+    
+    bool operator()(uint pixel, float depth)
+    {
+        depths[pixel] = min(depths[pixel], depth + offset);
+        return false;
+    }
+};
+
+struct TestDepth
+{
+    const float *depths;
+    
+    bool operator()(uint pixel, float depth)
+    {
+        return depth <= depths[pixel];
+    }
+};
+
+struct FillDepthsBody
+{
+    SelectionFrustum *frustum;
+    const vector<SelectionFrustum::ScreenTriangle> *triangles;
+    
+    void operator()(uint first, uint last)
+    {
+        frustum->fillDepths(*triangles, first, last);
+    }
+};
+
+SelectionFrustum::SelectionFrustum(const float *projection, const float *modelview, const Matrix4x4 &transform,
+                                   const int viewport[4], int x, int y, int width, int height)
+{
+    float projectionModelview[16];
+    multiplyMatrices(projection, modelview, projectionModelview);
+    multiplyMatrices(projectionModelview, transform.m, _matrix);
+    
+    for (uint i = 0; i < 4; i++)
+        _viewport[i] = (float)viewport[i];
+    
+    _rect[0] = (float)x;
+    _rect[1] = (float)y;
+    _rect[2] = (float)max(width, 0);
+    _rect[3] = (float)max(height, 0);
+    
+    _depthWidth = 0;
+    _depthHeight = 0;
+    
+    // rectangle in normalized device coordinates
+    float minimumX = 2.0f * (_rect[0] - _viewport[0]) / _viewport[2] - 1.0f;
+    float maximumX = 2.0f * (_rect[0] + _rect[2] - _viewport[0]) / _viewport[2] - 1.0f;
+    float minimumY = 2.0f * (_rect[1] - _viewport[1]) / _viewport[3] - 1.0f;
+    float maximumY = 2.0f * (_rect[1] + _rect[3] - _viewport[1]) / _viewport[3] - 1.0f;
+    
+    // clip coordinates are rows of the matrix, so every plane is a combination of them
+    const float weights[6][4] =
+    {
+        {  1.0f,  0.0f,  0.0f, -minimumX },
+        { -1.0f,  0.0f,  0.0f,  maximumX },
+        {  0.0f,  1.0f,  0.0f, -minimumY },
+        {  0.0f, -1.0f,  0.0f,  maximumY },
+        {  0.0f,  0.0f,  1.0f,  1.0f },
+        {  0.0f,  0.0f, -1.0f,  1.0f },
+    };
+    
+    for (uint i = 0; i < 6; i++)
+    {
+        for (uint column = 0; column < 4; column++)
+        {
+            float sum = 0.0f;
+            for (uint row = 0; row < 4; row++)
+                sum += weights[i][row] * _matrix[row + column * 4];
+            _planes[i][column] = sum;
+        }
+    }
+}
+
+uint SelectionFrustum::clip(const Vector3D *polygon, uint count, Vector3D *clipped) const
+{
+    Vector3D buffer[ClippedPolygonMaximumCount];
+    const Vector3D *input = polygon;
+    Vector3D *output = clipped;
+    
+    for (uint i = 0; i < count; i++)
+        output[i] = input[i];
+    
+    for (uint p = 0; p < 6 && count > 0; p++)
+    {
+        // alternate between buffers, so the result ends up in clipped
+        input = output;
+        output = (input == clipped) ? buffer : clipped;
+        
+        uint outputCount = 0;
+        
+        for (uint i = 0; i < count; i++)
+        {
+            const Vector3D &current = input[i];
+            const Vector3D &next = input[(i + 1) % count];
+            
+            float currentDistance = planeDistance(_planes[p], current);
+            float nextDistance = planeDistance(_planes[p], next);
+            
+            if (currentDistance >= 0.0f)
+                output[outputCount++] = current;
+            
+            if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+            {
+                float t = currentDistance / (currentDistance - nextDistance);
+                output[outputCount++] = current + (next - current) * t;
+            }
+        }
+        
+        count = outputCount;
+    }
+    
+    if (output != clipped)
+    {
+        for (uint i = 0; i < count; i++)
+            clipped[i] = output[i];
+    }
+    
+    return count;
+}
+
+SelectionFrustum::ScreenVertex SelectionFrustum::project(const Vector3D &v) const
+{
+    const float *m = _matrix;
+    
+    float x = v.x * m[0] + v.y * m[4] + v.z * m[8] + m[12];
+    float y = v.x * m[1] + v.y * m[5] + v.z * m[9] + m[13];
+    float z = v.x * m[2] + v.y * m[6] + v.z * m[10] + m[14];
+    float w = v.x * m[3] + v.y * m[7] + v.z * m[11] + m[15];
+    
+    float invW = 1.0f / max(w, FLOAT_EPS);
+    
+    // window coordinates relative to the rectangle, scaled to depth buffer pixels
+    ScreenVertex result;
+    result.x = (_viewport[0] + (x * invW + 1.0f) * 0.5f * _viewport[2] - _rect[0]) * (float)_depthWidth / _rect[2];
+    result.y = (_viewport[1] + (y * invW + 1.0f) * 0.5f * _viewport[3] - _rect[1]) * (float)_depthHeight / _rect[3];
+    result.depth = z * invW;
+    return result;
+}
+
+bool SelectionFrustum::isVisible(const ScreenVertex &v) const
+{
+    // vertices on the rectangle border still belong to the border pixels
+    uint x = (uint)max(0.0f, min((float)_depthWidth - 1.0f, floorf(v.x)));
+    uint y = (uint)max(0.0f, min((float)_depthHeight - 1.0f, floorf(v.y)));
+    return v.depth <= _depths[y * _depthWidth + x];
+}
+
+void SelectionFrustum::setOccluders(const vector<Vector3D> &corners, uint maximumSize)
+{
+    _depthWidth = min((uint)_rect[2], maximumSize);
+    _depthHeight = min((uint)_rect[3], maximumSize);
+    _depths.clear();
+    
+    if (_depthWidth == 0 || _depthHeight == 0)
+        return;
+    
+    _depths.assign(_depthWidth * _depthHeight, FLT_MAX);
+    
+    vector<ScreenTriangle> triangles;
+    triangles.reserve(corners.size() / 3);
+    
+    for (uint i = 0; i + 2 < corners.size(); i += 3)
+    {
+        Vector3D clipped[ClippedPolygonMaximumCount];
+        uint count = clip(&corners[i], 3, clipped);
+        
+        if (count < 3)
+            continue;
+        
+        ScreenVertex first = project(clipped[0]);
+        ScreenVertex previous = project(clipped[1]);
+        
+        for (uint j = 2; j < count; j++)
+        {
+            ScreenTriangle triangle;
+            triangle.vertices[0] = first;
+            triangle.vertices[1] = previous;
+            triangle.vertices[2] = project(clipped[j]);
+            previous = triangle.vertices[2];
+            triangles.push_back(triangle);
+        }
+    }
+    
+    FillDepthsBody body;
+    body.frustum = this;
+    body.triangles = &triangles;
+    ParallelFor(_depthHeight, DepthMinimumRange, body);
+}
+
+void SelectionFrustum::fillDepths(const vector<ScreenTriangle> &triangles, uint firstRow, uint lastRow)
+{
+    WriteDepth writer;
+    writer.depths = &_depths[0];
+    
+    for (uint i = 0; i < triangles.size(); i++)
+    {
+        const ScreenTriangle &triangle = triangles[i];
+        const ScreenVertex &a = triangle.vertices[0];
+        const ScreenVertex &b = triangle.vertices[1];
+        const ScreenVertex &c = triangle.vertices[2];
+        
+        float area = edgeFunction(a, b, c.x, c.y);
+        if (fabsf(area) < FLOAT_EPS)
+            continue;
+        
+        // depth slope of one pixel, like factor in glPolygonOffset
+        float slopeX = ((b.depth - a.depth) * (c.y - a.y) - (c.depth - a.depth) * (b.y - a.y)) / area;
+        float slopeY = ((c.depth - a.depth) * (b.x - a.x) - (b.depth - a.depth) * (c.x - a.x)) / area;
+        writer.offset = max(fabsf(slopeX), fabsf(slopeY)) + DepthBias;
+        
+        rasterizeTriangle(triangle, _depthWidth, firstRow, lastRow, writer);
+    }
+}
+
+bool SelectionFrustum::intersectsBox(const Vector3D &minimum, const Vector3D &maximum) const
+{
+    for (uint p = 0; p < 6; p++)
+    {
+        const float *plane = _planes[p];
+        
+        // corner furthest along the plane normal
+        Vector3D corner(plane[0] >= 0.0f ? maximum.x : minimum.x,
+                        plane[1] >= 0.0f ? maximum.y : minimum.y,
+                        plane[2] >= 0.0f ? maximum.z : minimum.z);
+        
+        if (planeDistance(plane, corner) < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+bool SelectionFrustum::containsPoint(const Vector3D &v) const
+{
+    for (uint p = 0; p < 6; p++)
+    {
+        if (planeDistance(_planes[p], v) < 0.0f)
+            return false;
+    }
+    
+    if (_depths.empty())
+        return true;
+    
+    return isVisible(project(v));
+}
+
+void SelectionFrustum::containsPoints(const Vector3D *points, uint count, unsigned char *results) const
+{
+    uint i = 0;
+
+#if defined(SELECTION_SSE)
+    __m128 zero = _mm_setzero_ps();
+    
+    // Vector3D is three packed floats, so four points are twelve floats
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z;
+        loadPositions(&points[i].x, x, y, z);
+        
+        int inside = 0xF;
+        
+        for (uint p = 0; p < 6 && inside != 0; p++)
+        {
+            const float *plane = _planes[p];
+            __m128 distance = _mm_mul_ps(x, _mm_set1_ps(plane[0]));
+            distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(plane[1])));
+            distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane[2])));
+            distance = _mm_add_ps(distance, _mm_set1_ps(plane[3]));
+            inside &= _mm_movemask_ps(_mm_cmpge_ps(distance, zero));
+        }
+        
+        for (uint j = 0; j < 4; j++)
+            results[i + j] = (unsigned char)((inside >> j) & 1);
+    }
+#endif
+    
+    for (; i < count; i++)
+    {
+        results[i] = 1;
+        
+        for (uint p = 0; p < 6; p++)
+        {
+            if (planeDistance(_planes[p], points[i]) < 0.0f)
+            {
+                results[i] = 0;
+                break;
+            }
+        }
+    }
+    
+    if (_depths.empty())
+        return;
+    
+    // only points inside the frustum are projected to the depth buffer
+    for (i = 0; i < count; i++)
+    {
+        if (results[i])
+            results[i] = isVisible(project(points[i])) ? 1 : 0;
+    }
+}
+
+bool SelectionFrustum::intersectsSegment(const Vector3D &a, const Vector3D &b) const
+{
+    float first = 0.0f;
+    float last = 1.0f;
+    
+    for (uint p = 0; p < 6; p++)
+    {
+        float aDistance = planeDistance(_planes[p], a);
+        float bDistance = planeDistance(_planes[p], b);
+        
+        if (aDistance < 0.0f && bDistance < 0.0f)
+            return false;
+        
+        if (aDistance < 0.0f)
+            first = max(first, aDistance / (aDistance - bDistance));
+        else if (bDistance < 0.0f)
+            last = min(last, aDistance / (aDistance - bDistance));
+        
+        if (first > last)
+            return false;
+    }
+    
+    if (_depths.empty())
+        return true;
+    
+    ScreenVertex start = project(a + (b - a) * first);
+    ScreenVertex end = project(a + (b - a) * last);
+    
+    // one sample per depth pixel along the longer axis
+    float length = max(fabsf(end.x - start.x), fabsf(end.y - start.y));
+    uint samples = min(SegmentMaximumSamples, (uint)ceilf(length) + 1);
+    
+    for (uint i = 0; i <= samples; i++)
+    {
+        float t = (float)i / (float)samples;
+        
+        ScreenVertex sample;
+        sample.x = start.x + (end.x - start.x) * t;
+        sample.y = start.y + (end.y - start.y) * t;
+        sample.depth = start.depth + (end.depth - start.depth) * t;
+        
+        if (isVisible(sample))
+            return true;
+    }
+    
+    return false;
+}
+
+bool SelectionFrustum::intersectsTriangle(const Vector3D &a, const Vector3D &b, const Vector3D &c) const
+{
+    Vector3D corners[3] = { a, b, c };
+    Vector3D clipped[ClippedPolygonMaximumCount];
+    uint count = clip(corners, 3, clipped);
+    
+    if (count == 0)
+        return false;
+    
+    if (_depths.empty())
+        return true;
+    
+    TestDepth tester;
+    tester.depths = &_depths[0];
+    
+    ScreenVertex first = project(clipped[0]);
+    
+    // triangles smaller than a pixel may not cover any pixel center
+    if (isVisible(first))
+        return true;
+    
+    ScreenVertex previous = project(clipped[1 % count]);
+    
+    for (uint j = 2; j < count; j++)
+    {
+        ScreenTriangle triangle;
+        triangle.vertices[0] = first;
+        triangle.vertices[1] = previous;
+        triangle.vertices[2] = project(clipped[j]);
+        previous = triangle.vertices[2];
+        
+        if (rasterizeTriangle(triangle, _depthWidth, 0, _depthHeight, tester))
+            return true;
+    }
+    
+    return false;
+}
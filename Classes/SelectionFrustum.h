@@ -0,0 +1,70 @@
+//
+//  SelectionFrustum.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "MathDeclaration.h"
+#include "Enums.h"
+#include <vector>
+
+using namespace std;
+
+// Rectangle selection without OpenGL. The rectangle in window coordinates
+// and the matrices OpenGL would use give six planes in object space, points
+// are tested against them and edges and triangles are clipped by them.
+// Optional depth buffer over the rectangle hides elements behind occluding
+// triangles, the same way as the filled mesh in the selection pass. All
+// tests are const and can run on worker threads.
+class SelectionFrustum
+{
+public:
+    struct ScreenVertex
+    {
+        float x, y, depth;
+    };
+    
+    struct ScreenTriangle
+    {
+        ScreenVertex vertices[3];
+    };
+private:
+    float _matrix[16];
+    float _planes[6][4];
+    float _viewport[4];
+    float _rect[4];
+    
+    vector<float> _depths;
+    uint _depthWidth;
+    uint _depthHeight;
+    
+    uint clip(const Vector3D *polygon, uint count, Vector3D *clipped) const;
+    ScreenVertex project(const Vector3D &v) const;
+    bool isVisible(const ScreenVertex &v) const;
+public:
+    // projection and modelview are column major like glGetFloatv returns
+    // them, transform is the model matrix of the selected mesh
+    SelectionFrustum(const float *projection, const float *modelview, const Matrix4x4 &transform,
+                     const int viewport[4], int x, int y, int width, int height);
+    
+    bool hasDepthBuffer() const { return !_depths.empty(); }
+    
+    // corners of occluding triangles, three per triangle, the resolution
+    // of the depth buffer is limited to maximumSize on both axes
+    void setOccluders(const vector<Vector3D> &corners, uint maximumSize);
+    
+    bool intersectsBox(const Vector3D &minimum, const Vector3D &maximum) const;
+    bool containsPoint(const Vector3D &v) const;
+    // same as containsPoint for many points, writes 1 or 0 to results,
+    // tests four points at once against the planes with SSE
+    void containsPoints(const Vector3D *points, uint count, unsigned char *results) const;
+    bool intersectsSegment(const Vector3D &a, const Vector3D &b) const;
+    bool intersectsTriangle(const Vector3D &a, const Vector3D &b, const Vector3D &c) const;
+    
+    // rasterizes rows [firstRow, lastRow) of all triangles, used by setOccluders
+    void fillDepths(const vector<ScreenTriangle> &triangles, uint firstRow, uint lastRow);
+};
@@ -0,0 +1,317 @@
+//
+//  TextHelpers.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "TextHelpers.h"
+#include <limits.h>
+#include <math.h>
+#include <vector>
+
+#if defined(WIN32)
+#include <windows.h>
+#endif
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static double powerOfTen(int exponent)
+{
+    // powers up to 22 are exact in double
+    static const double powers[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    
+    if (exponent >= 0 && exponent <= 22)
+        return powers[exponent];
+    return pow(10.0, (double)exponent);
+}
+
+static double scaleByPowerOfTen(double value, int exponent)
+{
+    if (exponent < 0)
+        return value / powerOfTen(-exponent);
+    if (exponent > 0)
+        return value * powerOfTen(exponent);
+    return value;
+}
+
+bool ParseFloat(const char *&p, const char *end, float &value)
+{
+    const char *s = p;
+    bool negative = false;
+    
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        negative = *s == '-';
+        s++;
+    }
+    
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    
+    for (; s < end && isDigit(*s); s++)
+    {
+        hasDigits = true;
+        if (mantissa < 100000000000000000ULL)
+            mantissa = mantissa * 10 + (unsigned long long)(*s - '0');
+        else
+            exponent++;
+    }
+    
+    if (s < end && *s == '.')
+    {
+        for (s++; s < end && isDigit(*s); s++)
+        {
+            hasDigits = true;
+            if (mantissa < 100000000000000000ULL)
+            {
+                mantissa = mantissa * 10 + (unsigned long long)(*s - '0');
+                exponent--;
+            }
+        }
+    }
+    
+    if (!hasDigits)
+        return false;
+    
+    if (s < end && (*s == 'e' || *s == 'E'))
+    {
+        const char *e = s + 1;
+        bool negativeExponent = false;
+        
+        if (e < end && (*e == '-' || *e == '+'))
+        {
+            negativeExponent = *e == '-';
+            e++;
+        }
+        
+        if (e < end && isDigit(*e))
+        {
+            int writtenExponent = 0;
+            for (; e < end && isDigit(*e); e++)
+            {
+                if (writtenExponent < 1000)
+                    writtenExponent = writtenExponent * 10 + (*e - '0');
+            }
+            exponent += negativeExponent ? -writtenExponent : writtenExponent;
+            s = e;
+        }
+    }
+    
+    double result = scaleByPowerOfTen((double)mantissa, exponent);
+    
+    value = (float)(negative ? -result : result);
+    p = s;
+    return true;
+}
+
+bool ParseInt(const char *&p, const char *end, int &value)
+{
+    const char *s = p;
+    bool negative = false;
+    
+    if (s < end && (*s == '-' || *s == '+'))
+    {
+        negative = *s == '-';
+        s++;
+    }
+    
+    if (s >= end || !isDigit(*s))
+        return false;
+    
+    long long result = 0;
+    for (; s < end && isDigit(*s); s++)
+    {
+        if (result <= INT_MAX)
+            result = result * 10 + (*s - '0');
+    }
+    
+    if (result > INT_MAX)
+        result = INT_MAX;
+    
+    value = negative ? -(int)result : (int)result;
+    p = s;
+    return true;
+}
+
+void AppendUInt(string &text, uint value)
+{
+    char digits[10];
+    uint count = 0;
+    
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    while (value != 0);
+    
+    while (count > 0)
+        text += digits[--count];
+}
+
+void AppendFloat(string &text, float value)
+{
+    if (value != value)
+    {
+        text += "nan";
+        return;
+    }
+    
+    if (value == 0.0f)
+    {
+        text += '0';
+        return;
+    }
+    
+    if (value < 0.0f)
+    {
+        text += '-';
+        value = -value;
+    }
+    
+    if (value > 3.402823466e+38f)
+    {
+        text += "inf";
+        return;
+    }
+    
+    double magnitude = (double)value;
+    int firstDigitExponent = (int)floor(log10(magnitude));
+    
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    
+    // one more digit covers log10 rounded up below a power of ten
+    for (int digitCount = 1; digitCount <= 10; digitCount++)
+    {
+        exponent = firstDigitExponent - digitCount + 1;
+        mantissa = (unsigned long long)(scaleByPowerOfTen(magnitude, -exponent) + 0.5);
+        
+        if ((float)scaleByPowerOfTen((double)mantissa, exponent) == value)
+            break;
+    }
+    
+    while (mantissa % 10 == 0)
+    {
+        mantissa /= 10;
+        exponent++;
+    }
+    
+    char digits[20];
+    int digitCount = 0;
+    
+    for (unsigned long long m = mantissa; m != 0; m /= 10)
+        digits[digitCount++] = (char)('0' + m % 10);
+    
+    // digits are reversed, the first one has the highest exponent
+    int integerDigitCount = digitCount + exponent;
+    
+    if (integerDigitCount > 9 || integerDigitCount < -4)
+    {
+        // 1.5e-7
+        text += digits[digitCount - 1];
+        if (digitCount > 1)
+        {
+            text += '.';
+            for (int i = digitCount - 2; i >= 0; i--)
+                text += digits[i];
+        }
+        text += 'e';
+        int writtenExponent = integerDigitCount - 1;
+        if (writtenExponent < 0)
+        {
+            text += '-';
+            writtenExponent = -writtenExponent;
+        }
+        AppendUInt(text, (uint)writtenExponent);
+    }
+    else if (integerDigitCount <= 0)
+    {
+        // 0.00125
+        text += "0.";
+        for (int i = integerDigitCount; i < 0; i++)
+            text += '0';
+        for (int i = digitCount - 1; i >= 0; i--)
+            text += digits[i];
+    }
+    else
+    {
+        // 125, 12.5, 12500
+        for (int i = digitCount - 1, position = 0; i >= 0 || position < integerDigitCount; i--, position++)
+        {
+            if (position == integerDigitCount)
+                text += '.';
+            text += i >= 0 ? digits[i] : '0';
+        }
+    }
+}
+
+TextOutput::TextOutput(string &text)
+{
+    _text = &text;
+    _file = NULL;
+    _failed = false;
+}
+
+TextOutput::TextOutput(const char *fileName)
+{
+    _text = NULL;
+    _file = NULL;
+    _failed = true;
+
+#if defined(WIN32)
+    int wideLength = MultiByteToWideChar(CP_UTF8, 0, fileName, -1, NULL, 0);
+    if (wideLength <= 0)
+        return;
+    
+    vector<wchar_t> wideFileName(wideLength);
+    MultiByteToWideChar(CP_UTF8, 0, fileName, -1, &wideFileName[0], wideLength);
+    _file = _wfopen(&wideFileName[0], L"wb");
+#else
+    _file = fopen(fileName, "wb");
+#endif
+    
+    _failed = _file == NULL;
+}
+
+TextOutput::~TextOutput()
+{
+    close();
+}
+
+void TextOutput::append(const string &text)
+{
+    if (_text != NULL)
+        _text->append(text);
+    else if (!_failed && fwrite(text.data(), 1, text.size(), _file) != text.size())
+        _failed = true;
+}
+
+void TextOutput::append(const char *text)
+{
+    if (_text != NULL)
+        _text->append(text);
+    else if (!_failed && fputs(text, _file) == EOF)
+        _failed = true;
+}
+
+bool TextOutput::close()
+{
+    if (_file != NULL)
+    {
+        if (fclose(_file) != 0)
+            _failed = true;
+        _file = NULL;
+    }
+    return !_failed;
+}
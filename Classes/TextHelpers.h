@@ -0,0 +1,56 @@
+//
+//  TextHelpers.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "Enums.h"
+#include <stdio.h>
+#include <string>
+
+using namespace std;
+
+// Numbers in Wavefront Object and Collada text, read and written without
+// locale dependent streams or printf, so a decimal comma never sneaks in.
+
+// Decimal number like -1.38018e-3, digits beyond double precision are
+// dropped. On success p points after the number.
+bool ParseFloat(const char *&p, const char *end, float &value);
+// optional sign and decimal digits, clamped to int range
+bool ParseInt(const char *&p, const char *end, int &value);
+
+void AppendUInt(string &text, uint value);
+// Shortest decimal digits which parse back to the same float. Tries one
+// digit after another, floats never need more than nine significant digits.
+void AppendFloat(string &text, float value);
+
+// Text appended to a string or streamed into a file. Writers format parts
+// of a document on worker threads and append them here in order.
+class TextOutput
+{
+private:
+    string *_text;
+    FILE *_file;
+    bool _failed;
+    
+    TextOutput(const TextOutput &);
+    TextOutput &operator =(const TextOutput &);
+public:
+    TextOutput(string &text);
+    // creates the file, fileName is in UTF-8
+    TextOutput(const char *fileName);
+    ~TextOutput();
+    
+    // false after the file could not be created or written
+    bool isValid() const { return !_failed; }
+    
+    void append(const string &text);
+    void append(const char *text);
+    
+    // closes the file, false when anything failed
+    bool close();
+};
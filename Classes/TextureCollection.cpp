@@ -51,9 +51,12 @@ TextureCollection::TextureCollection(MemoryReadStream *stream)
         for (uint i = 0; i < textureCount; i++)
         {
             uint charCount = stream->read<uint>();
+            if (!stream->canReadArray<char>(charCount))
+                break;
+            
             char *utf8String = (char *)malloc(charCount + 1);
             memset(utf8String, 0, charCount + 1);
-            stream->readBytes(utf8String, charCount);
+            stream->readArray(utf8String, charCount);
 #if defined(__APPLE__)
             NSString *name = [NSString stringWithUTF8String:utf8String];
 #elif defined(WIN32)
@@ -57,6 +57,8 @@ public:
     void removeVertex(TexCoordNode *texCoord) { removeTexCoord(texCoord); }
     void removeEdge(VertexEdgeNode *edge) { removeVertexEdge(edge); }
     void removeEdge(TexCoordEdgeNode *edge) { removeTexCoordEdge(edge); }
+    bool containsEdge(const VertexEdgeNode *edge) const { return containsVertexEdge(edge); }
+    bool containsEdge(const TexCoordEdgeNode *edge) const { return containsTexCoordEdge(edge); }
     
     TexCoordNode *vertexNotInEdge(const TexCoordEdge *edge) const { return texCoordNotInEdge(edge); }
     
@@ -91,9 +93,10 @@ class TriangleNode : public FPNode<TriangleNode, Triangle2>
 {
 public:
     float selectionWeight;
+    int cacheIndex; // first index in the triangle cache, -1 if hidden
     
-    TriangleNode() : FPNode<TriangleNode, Triangle2>() { }
-    TriangleNode(const Triangle2 &triangle) : FPNode<TriangleNode, Triangle2>(triangle)
+    TriangleNode() : FPNode<TriangleNode, Triangle2>(), cacheIndex(-1) { }
+    TriangleNode(const Triangle2 &triangle) : FPNode<TriangleNode, Triangle2>(triangle), cacheIndex(-1)
     {
         addToVertices();
         addToTexCoords();
@@ -0,0 +1,408 @@
+//
+//  TriangleBVH.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "TriangleBVH.h"
+#include "SelectionFrustum.h"
+#include <algorithm>
+#include <float.h>
+
+const uint BVHBinCount = 12;
+const uint BVHMaxLeafCount = 4;
+
+static void expandBounds(Vector3D &minimum, Vector3D &maximum, const Vector3D &otherMinimum, const Vector3D &otherMaximum)
+{
+    for (uint i = 0; i < 3; i++)
+    {
+        minimum[i] = min(minimum[i], otherMinimum[i]);
+        maximum[i] = max(maximum[i], otherMaximum[i]);
+    }
+}
+
+static float surfaceArea(const Vector3D &minimum, const Vector3D &maximum)
+{
+    Vector3D d = maximum - minimum;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+// entry distance along the ray or -1 when the box is missed
+static float rayBoxEntry(const Vector3D &origin, const Vector3D &invDirection, const Vector3D &minimum, const Vector3D &maximum)
+{
+    float tNear = 0.0f;
+    float tFar = FLT_MAX;
+    
+    for (uint i = 0; i < 3; i++)
+    {
+        float t1 = (minimum[i] - origin[i]) * invDirection[i];
+        float t2 = (maximum[i] - origin[i]) * invDirection[i];
+        
+        if (t1 > t2)
+            swap(t1, t2);
+        
+        // NaN from a zero direction on the slab plane keeps the previous range
+        if (t1 > tNear)
+            tNear = t1;
+        if (t2 < tFar)
+            tFar = t2;
+        
+        if (tNear > tFar)
+            return -1.0f;
+    }
+    
+    return tNear;
+}
+
+TriangleBVH::TriangleBVH()
+{
+    _isValid = false;
+    _needsRefit = false;
+}
+
+void TriangleBVH::invalidate()
+{
+    _nodes.clear();
+    _triangles.clear();
+    _isValid = false;
+    _needsRefit = false;
+}
+
+void TriangleBVH::triangleBounds(TriangleNode *node, Vector3D &minimum, Vector3D &maximum) const
+{
+    const Triangle2 &triangle = node->data();
+    
+    minimum = triangle.vertex(0)->data().position;
+    maximum = minimum;
+    
+    for (uint i = 1; i < triangle.count(); i++)
+    {
+        const Vector3D &v = triangle.vertex(i)->data().position;
+        expandBounds(minimum, maximum, v, v);
+    }
+}
+
+void TriangleBVH::build(const FPList<TriangleNode, Triangle2> &triangles)
+{
+    invalidate();
+    
+    uint count = triangles.count();
+    
+    _triangles.reserve(count);
+    
+    vector<Vector3D> minimums(count);
+    vector<Vector3D> maximums(count);
+    vector<Vector3D> centers(count);
+    
+    for (TriangleNode *node = triangles.begin(), *end = triangles.end(); node != end; node = node->next())
+    {
+        uint i = _triangles.size();
+        _triangles.push_back(node);
+        triangleBounds(node, minimums[i], maximums[i]);
+        centers[i] = (minimums[i] + maximums[i]) * 0.5f;
+    }
+    
+    if (count > 0)
+    {
+        _nodes.reserve(2 * (count / BVHMaxLeafCount + 1));
+        buildNode(minimums, maximums, centers, 0, count);
+    }
+    
+    _isValid = true;
+}
+
+uint TriangleBVH::buildNode(vector<Vector3D> &minimums, vector<Vector3D> &maximums, vector<Vector3D> &centers, uint first, uint count)
+{
+    uint index = _nodes.size();
+    _nodes.push_back(Node());
+    
+    Vector3D minimum = minimums[first];
+    Vector3D maximum = maximums[first];
+    Vector3D centerMinimum = centers[first];
+    Vector3D centerMaximum = centers[first];
+    
+    for (uint i = first + 1; i < first + count; i++)
+    {
+        expandBounds(minimum, maximum, minimums[i], maximums[i]);
+        expandBounds(centerMinimum, centerMaximum, centers[i], centers[i]);
+    }
+    
+    _nodes[index].minimum = minimum;
+    _nodes[index].maximum = maximum;
+    
+    // binned SAH split along the widest axis of the centers
+    Vector3D centerExtent = centerMaximum - centerMinimum;
+    uint axis = 0;
+    if (centerExtent.y > centerExtent[axis])
+        axis = 1;
+    if (centerExtent.z > centerExtent[axis])
+        axis = 2;
+    
+    uint split = 0;
+    
+    if (count > BVHMaxLeafCount && centerExtent[axis] > 0.0f)
+    {
+        uint binCounts[BVHBinCount] = { 0 };
+        Vector3D binMinimums[BVHBinCount];
+        Vector3D binMaximums[BVHBinCount];
+        
+        float binScale = (float)BVHBinCount / centerExtent[axis];
+        
+        for (uint i = first; i < first + count; i++)
+        {
+            uint bin = min(BVHBinCount - 1, (uint)((centers[i][axis] - centerMinimum[axis]) * binScale));
+            
+            if (binCounts[bin] == 0)
+            {
+                binMinimums[bin] = minimums[i];
+                binMaximums[bin] = maximums[i];
+            }
+            else
+            {
+                expandBounds(binMinimums[bin], binMaximums[bin], minimums[i], maximums[i]);
+            }
+            binCounts[bin]++;
+        }
+        
+        // sweep from the right, then from the left to evaluate every plane
+        float rightAreas[BVHBinCount];
+        uint rightCounts[BVHBinCount];
+        Vector3D sweepMinimum, sweepMaximum;
+        uint sweepCount = 0;
+        
+        for (uint b = BVHBinCount - 1; b > 0; b--)
+        {
+            if (binCounts[b] > 0)
+            {
+                if (sweepCount == 0)
+                {
+                    sweepMinimum = binMinimums[b];
+                    sweepMaximum = binMaximums[b];
+                }
+                else
+                {
+                    expandBounds(sweepMinimum, sweepMaximum, binMinimums[b], binMaximums[b]);
+                }
+                sweepCount += binCounts[b];
+            }
+            rightAreas[b] = sweepCount > 0 ? surfaceArea(sweepMinimum, sweepMaximum) : 0.0f;
+            rightCounts[b] = sweepCount;
+        }
+        
+        float bestCost = (float)count * surfaceArea(minimum, maximum);
+        uint bestBin = 0;
+        sweepCount = 0;
+        
+        for (uint b = 0; b < BVHBinCount - 1; b++)
+        {
+            if (binCounts[b] > 0)
+            {
+                if (sweepCount == 0)
+                {
+                    sweepMinimum = binMinimums[b];
+                    sweepMaximum = binMaximums[b];
+                }
+                else
+                {
+                    expandBounds(sweepMinimum, sweepMaximum, binMinimums[b], binMaximums[b]);
+                }
+                sweepCount += binCounts[b];
+            }
+            
+            if (sweepCount == 0 || rightCounts[b + 1] == 0)
+                continue;
+            
+            float cost = (float)sweepCount * surfaceArea(sweepMinimum, sweepMaximum) +
+                         (float)rightCounts[b + 1] * rightAreas[b + 1];
+            
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestBin = b + 1;
+            }
+        }
+        
+        // splitting is not worth it by SAH, but large leaves are slow to test
+        if (bestBin == 0 && count > BVHMaxLeafCount * 4)
+            bestBin = BVHBinCount / 2;
+        
+        if (bestBin > 0)
+        {
+            // partition triangles with bin < bestBin to the left
+            uint left = first;
+            uint right = first + count;
+            
+            while (left < right)
+            {
+                uint bin = min(BVHBinCount - 1, (uint)((centers[left][axis] - centerMinimum[axis]) * binScale));
+                if (bin < bestBin)
+                {
+                    left++;
+                }
+                else
+                {
+                    right--;
+                    swap(_triangles[left], _triangles[right]);
+                    swap(minimums[left], minimums[right]);
+                    swap(maximums[left], maximums[right]);
+                    swap(centers[left], centers[right]);
+                }
+            }
+            
+            split = left - first;
+        }
+    }
+    
+    if (split == 0 || split == count)
+    {
+        _nodes[index].offset = first;
+        _nodes[index].count = count;
+        return index;
+    }
+    
+    buildNode(minimums, maximums, centers, first, split);
+    uint right = buildNode(minimums, maximums, centers, first + split, count - split);
+    
+    _nodes[index].offset = right;
+    _nodes[index].count = 0;
+    return index;
+}
+
+void TriangleBVH::refit()
+{
+    for (uint i = _nodes.size(); i-- > 0;)
+    {
+        Node &node = _nodes[i];
+        
+        if (node.count > 0)
+        {
+            triangleBounds(_triangles[node.offset], node.minimum, node.maximum);
+            
+            for (uint j = node.offset + 1; j < node.offset + node.count; j++)
+            {
+                Vector3D minimum, maximum;
+                triangleBounds(_triangles[j], minimum, maximum);
+                expandBounds(node.minimum, node.maximum, minimum, maximum);
+            }
+        }
+        else
+        {
+            const Node &left = _nodes[i + 1];
+            const Node &right = _nodes[node.offset];
+            
+            node.minimum = left.minimum;
+            node.maximum = left.maximum;
+            expandBounds(node.minimum, node.maximum, right.minimum, right.maximum);
+        }
+    }
+    
+    _needsRefit = false;
+}
+
+TriangleNode *TriangleBVH::rayIntersect(const Vector3D &origin, const Vector3D &direction, float &u, float &v, Vector3D &intersect) const
+{
+    if (_nodes.empty())
+        return NULL;
+    
+    TriangleNode *nearest = NULL;
+    float nearestSqDistance = 0.0f;
+    
+    Vector3D invDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    float directionSqLength = direction.GetLengthSq();
+    
+    vector<uint> stack;
+    stack.reserve(64);
+    
+    if (rayBoxEntry(origin, invDirection, _nodes[0].minimum, _nodes[0].maximum) >= 0.0f)
+        stack.push_back(0);
+    
+    while (!stack.empty())
+    {
+        uint index = stack.back();
+        stack.pop_back();
+        const Node &node = _nodes[index];
+        
+        if (node.count > 0)
+        {
+            for (uint i = node.offset; i < node.offset + node.count; i++)
+            {
+                float tempU = 0.0f;
+                float tempV = 0.0f;
+                Vector3D tempIntersect;
+                
+                if (_triangles[i]->data().rayIntersect(origin, direction, tempU, tempV, tempIntersect))
+                {
+                    float tempSqDistance = tempIntersect.SqDistance(origin);
+                    if (nearest == NULL || nearestSqDistance > tempSqDistance)
+                    {
+                        nearest = _triangles[i];
+                        u = tempU;
+                        v = tempV;
+                        intersect = tempIntersect;
+                        nearestSqDistance = tempSqDistance;
+                    }
+                }
+            }
+            continue;
+        }
+        
+        uint children[2] = { index + 1, node.offset };
+        float entries[2];
+        
+        for (uint i = 0; i < 2; i++)
+        {
+            const Node &child = _nodes[children[i]];
+            entries[i] = rayBoxEntry(origin, invDirection, child.minimum, child.maximum);
+            
+            // boxes entered behind the nearest hit cannot contain a nearer one
+            if (nearest != NULL && entries[i] * entries[i] * directionSqLength > nearestSqDistance)
+                entries[i] = -1.0f;
+        }
+        
+        // push the farther child first, so the nearer one is visited first
+        if (entries[0] >= 0.0f && entries[1] >= 0.0f && entries[0] < entries[1])
+        {
+            swap(children[0], children[1]);
+            swap(entries[0], entries[1]);
+        }
+        
+        for (uint i = 0; i < 2; i++)
+        {
+            if (entries[i] >= 0.0f)
+                stack.push_back(children[i]);
+        }
+    }
+    
+    return nearest;
+}
+
+void TriangleBVH::frustumQuery(const SelectionFrustum &frustum, vector<TriangleNode *> &triangles) const
+{
+    if (_nodes.empty())
+        return;
+    
+    vector<uint> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    
+    while (!stack.empty())
+    {
+        uint index = stack.back();
+        stack.pop_back();
+        const Node &node = _nodes[index];
+        
+        if (!frustum.intersectsBox(node.minimum, node.maximum))
+            continue;
+        
+        if (node.count > 0)
+        {
+            triangles.insert(triangles.end(), _triangles.begin() + node.offset, _triangles.begin() + node.offset + node.count);
+            continue;
+        }
+        
+        stack.push_back(node.offset);
+        stack.push_back(index + 1);
+    }
+}
@@ -0,0 +1,55 @@
+//
+//  TriangleBVH.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "MeshHelpers.h"
+
+class SelectionFrustum;
+
+// Bounding volume hierarchy over triangles and quads built with binned SAH.
+// Nodes are stored depth first in one array, left child follows its parent
+// and inner nodes keep the index of the right child. Moved vertices only
+// need refit(), added or removed triangles need a new build().
+class TriangleBVH
+{
+private:
+    struct Node
+    {
+        Vector3D minimum;
+        Vector3D maximum;
+        uint offset;
+        uint count;
+    };
+    
+    vector<Node> _nodes;
+    vector<TriangleNode *> _triangles;
+    bool _isValid;
+    bool _needsRefit;
+    
+    uint buildNode(vector<Vector3D> &minimums, vector<Vector3D> &maximums, vector<Vector3D> &centers, uint first, uint count);
+    void triangleBounds(TriangleNode *node, Vector3D &minimum, Vector3D &maximum) const;
+public:
+    TriangleBVH();
+    
+    bool isValid() const { return _isValid; }
+    bool needsRefit() const { return _needsRefit; }
+    uint nodeCount() const { return _nodes.size(); }
+    
+    void invalidate();
+    void setNeedsRefit() { _needsRefit = true; }
+    
+    void build(const FPList<TriangleNode, Triangle2> &triangles);
+    void refit();
+    
+    // nearest triangle hit by the ray, same test as Triangle2::rayIntersect
+    TriangleNode *rayIntersect(const Vector3D &origin, const Vector3D &direction, float &u, float &v, Vector3D &intersect) const;
+    
+    // triangles in leaves with bounds intersecting the frustum, some of them may be outside
+    void frustumQuery(const SelectionFrustum &frustum, vector<TriangleNode *> &triangles) const;
+};
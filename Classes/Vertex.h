@@ -38,16 +38,19 @@ public:
             memset(this, 0, sizeof(AlgorithmData));
         }
     };
-    
+
 public:
     FPList<VertexTriangleNode, TriangleNode *> _triangles;
     FPList<VertexVEdgeNode<T>, VEdgeNode<T> *> _edges;
 public:
     float selectionWeight;
     AlgorithmData algorithmData;
+    int pointCacheIndex; // point in the vertex point cache, -1 if hidden
     
-    VNode() : FPNode<VNode<T>, T>() { }
-    VNode(const T &vertex) : FPNode<VNode<T>, T>(vertex) { } 
+    VNode() : FPNode<VNode<T>, T>(), pointCacheIndex(-1) { }
+    VNode(const T &vertex) : FPNode<VNode<T>, T>(vertex), pointCacheIndex(-1) { } 
+    VNode(FPPool<VertexTriangleNode> *trianglePool, FPPool<VertexVEdgeNode<T> > *edgePool) :
+        FPNode<VNode<T>, T>(), _triangles(trianglePool), _edges(edgePool), pointCacheIndex(-1) { }
     virtual ~VNode() 
     { 
         removeFromTriangles();
@@ -55,6 +58,27 @@ public:
     }
     
     bool isUsed() const { return _triangles.count() > 0; }
+    
+    bool hasSelectedTriangle() const
+    {
+        for (VertexTriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
+        {
+            if (node->data()->data().selected)
+                return true;
+        }
+        return false;
+    }
+    
+    bool hasSelectedEdge() const
+    {
+        for (VertexVEdgeNode<T> *node = _edges.begin(), *end = _edges.end(); node != end; node = node->next())
+        {
+            if (node->data()->data().selected)
+                return true;
+        }
+        return false;
+    }
+    
     void addTriangle(TriangleNode *triangle) { _triangles.add(triangle); }
     void removeTriangle(TriangleNode *triangle)
     {
@@ -171,24 +195,11 @@ public:
     {
         for (VertexTriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
         {
-            node->cacheIndices[0] = -1;
-            node->cacheIndices[1] = -1;
+            node->cacheIndex = -1;
         }
     }
     
-    void setCacheIndexForTriangleNode(TriangleNode *triangleNode, uint cacheIndex, uint cacheIndexPosition)
-    {
-        for (VertexTriangleNode *node = _triangles.begin(), *end = _triangles.end(); node != end; node = node->next())
-        {
-            if (node->data() == triangleNode)
-            {
-                node->cacheIndices[cacheIndexPosition] = cacheIndex;
-                break;
-            }
-        }
-    }
-    
-    void setCacheIndexForEdgeNode(VEdgeNode<T> *edgeNode, uint cacheIndex)
+    void setCacheIndexForEdgeNode(VEdgeNode<T> *edgeNode, int cacheIndex)
     {
         for (VertexVEdgeNode<T> *node = _edges.begin(), *end = _edges.end(); node != end; node = node->next())
         {
@@ -250,7 +261,7 @@ public:
     void softSelect(const vector<float> &weights)
     {
         selectionWeight = weights[0];
-
+        
         vector<VertexNode *> currentStepNodes;
         currentStepNodes.push_back(this);
         
@@ -281,3 +292,34 @@ public:
         }
     }
 };
+
+template <class T>
+class VNodePool : public FPPool<VNode<T> >
+{
+public:
+    FPPool<VertexTriangleNode> trianglePool;
+    FPPool<VertexVEdgeNode<T> > edgePool;
+    
+    VNodePool() : FPPool<VNode<T> >() { }
+    virtual ~VNodePool() { }
+    
+    virtual VNode<T> *create()
+    {
+        return new (this->allocate()) VNode<T>(&trianglePool, &edgePool);
+    }
+    
+    virtual void releaseAll()
+    {
+        FPPool<VNode<T> >::releaseAll();
+        trianglePool.releaseAll();
+        edgePool.releaseAll();
+    }
+    
+    virtual FPPoolStatistics statistics() const
+    {
+        FPPoolStatistics result = FPPool<VNode<T> >::statistics();
+        result.add(trianglePool.statistics());
+        result.add(edgePool.statistics());
+        return result;
+    }
+};
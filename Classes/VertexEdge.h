@@ -331,3 +331,153 @@ public:
         }
     }
 };
+
+// Open addressing hash table of edges keyed by their unordered vertex pair.
+// Entries are not updated when edge vertices change, edges have to be
+// removed before they are modified and inserted again afterwards.
+template <class T>
+class VEdgeTable
+{
+private:
+    struct Entry
+    {
+        const VNode<T> *first;
+        const VNode<T> *second;
+        VEdgeNode<T> *edge;
+    };
+    
+    vector<Entry> _entries;
+    uint _count;
+    
+    static void orderVertices(const VNode<T> *&v1, const VNode<T> *&v2)
+    {
+        if (v2 < v1)
+            swap(v1, v2);
+    }
+    
+    uint slot(const VNode<T> *first, const VNode<T> *second) const
+    {
+        size_t hash = (size_t)first / sizeof(void *);
+        hash = hash * 0x9E3779B1U + (size_t)second / sizeof(void *);
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6BU;
+        hash ^= hash >> 13;
+        return (uint)hash & (_entries.size() - 1);
+    }
+    
+    uint findSlot(const VNode<T> *first, const VNode<T> *second) const
+    {
+        uint mask = _entries.size() - 1;
+        uint i = slot(first, second);
+        
+        while (_entries[i].edge != NULL)
+        {
+            if (_entries[i].first == first && _entries[i].second == second)
+                return i;
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+    
+    void rehash(uint capacity)
+    {
+        vector<Entry> oldEntries;
+        oldEntries.swap(_entries);
+        
+        Entry empty = { NULL, NULL, NULL };
+        _entries.resize(capacity, empty);
+        
+        for (uint i = 0; i < oldEntries.size(); i++)
+        {
+            const Entry &entry = oldEntries[i];
+            if (entry.edge != NULL)
+                _entries[findSlot(entry.first, entry.second)] = entry;
+        }
+    }
+public:
+    VEdgeTable() : _count(0U) { }
+    
+    uint count() const { return _count; }
+    
+    void clear()
+    {
+        Entry empty = { NULL, NULL, NULL };
+        fill(_entries.begin(), _entries.end(), empty);
+        _count = 0U;
+    }
+    
+    void reserve(uint count)
+    {
+        uint capacity = 16U;
+        while (capacity < count * 2U)
+            capacity *= 2U;
+        
+        if (capacity > _entries.size())
+            rehash(capacity);
+    }
+    
+    VEdgeNode<T> *find(const VNode<T> *v1, const VNode<T> *v2) const
+    {
+        if (_count == 0U)
+            return NULL;
+        
+        orderVertices(v1, v2);
+        return _entries[findSlot(v1, v2)].edge;
+    }
+    
+    void insert(VEdgeNode<T> *edge)
+    {
+        if ((_count + 1U) * 2U > _entries.size())
+            reserve(_count + 1U);
+        
+        const VNode<T> *v1 = edge->data().vertex(0);
+        const VNode<T> *v2 = edge->data().vertex(1);
+        orderVertices(v1, v2);
+        
+        Entry &entry = _entries[findSlot(v1, v2)];
+        if (entry.edge == NULL)
+            _count++;
+        
+        entry.first = v1;
+        entry.second = v2;
+        entry.edge = edge;
+    }
+    
+    void remove(VEdgeNode<T> *edge)
+    {
+        if (_count == 0U)
+            return;
+        
+        const VNode<T> *v1 = edge->data().vertex(0);
+        const VNode<T> *v2 = edge->data().vertex(1);
+        orderVertices(v1, v2);
+        
+        uint mask = _entries.size() - 1;
+        uint i = findSlot(v1, v2);
+        if (_entries[i].edge != edge)
+            return;
+        
+        // backward shift deletion keeps probe sequences intact without tombstones
+        uint j = i;
+        while (true)
+        {
+            _entries[i].edge = NULL;
+            
+            uint home;
+            do
+            {
+                j = (j + 1) & mask;
+                if (_entries[j].edge == NULL)
+                {
+                    _count--;
+                    return;
+                }
+                home = slot(_entries[j].first, _entries[j].second);
+            }
+            while (i <= j ? (i < home && home <= j) : (i < home || home <= j));
+            
+            _entries[i] = _entries[j];
+            i = j;
+        }
+    }
+};
@@ -0,0 +1,347 @@
+//
+//  VertexGrid.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "VertexGrid.h"
+#include <algorithm>
+#include <stdlib.h>
+
+VertexGrid::VertexGrid()
+{
+    _freeEntries = UINT_MAX;
+    _count = 0U;
+    _cellSize = 1.0f;
+    _invCellSize = 1.0f;
+    _isValid = false;
+    
+    for (uint i = 0; i < 3; i++)
+    {
+        _minCell[i] = 0;
+        _maxCell[i] = 0;
+    }
+}
+
+void VertexGrid::cell(const Vector3D &position, int coords[3]) const
+{
+    // clamped so that shell searches around far positions cannot overflow
+    const float limit = 268435456.0f;
+    
+    for (uint i = 0; i < 3; i++)
+    {
+        float c = floorf(position[i] * _invCellSize);
+        coords[i] = (int)max(-limit, min(limit, c));
+    }
+}
+
+uint VertexGrid::bucket(const int coords[3]) const
+{
+    uint hash = (uint)coords[0] * 73856093U ^ (uint)coords[1] * 19349663U ^ (uint)coords[2] * 83492791U;
+    return hash & (_buckets.size() - 1);
+}
+
+void VertexGrid::rehash(uint bucketCount)
+{
+    _buckets.assign(bucketCount, UINT_MAX);
+    
+    for (uint i = 0; i < _entries.size(); i++)
+    {
+        Entry &entry = _entries[i];
+        if (entry.node == NULL)
+            continue;
+        
+        uint b = bucket(entry.cell);
+        entry.next = _buckets[b];
+        _buckets[b] = i;
+    }
+}
+
+uint VertexGrid::findEntry(VertexNode *node, const int coords[3]) const
+{
+    for (uint i = _buckets[bucket(coords)]; i != UINT_MAX; i = _entries[i].next)
+    {
+        if (_entries[i].node == node)
+            return i;
+    }
+    return UINT_MAX;
+}
+
+void VertexGrid::addEntry(VertexNode *node, const int coords[3])
+{
+    uint index;
+    
+    if (_freeEntries != UINT_MAX)
+    {
+        index = _freeEntries;
+        _freeEntries = _entries[index].next;
+    }
+    else
+    {
+        index = _entries.size();
+        _entries.push_back(Entry());
+    }
+    
+    Entry &entry = _entries[index];
+    entry.node = node;
+    
+    for (uint i = 0; i < 3; i++)
+    {
+        entry.cell[i] = coords[i];
+        
+        if (_count == 0U)
+        {
+            _minCell[i] = coords[i];
+            _maxCell[i] = coords[i];
+        }
+        else
+        {
+            _minCell[i] = min(_minCell[i], coords[i]);
+            _maxCell[i] = max(_maxCell[i], coords[i]);
+        }
+    }
+    
+    _count++;
+    
+    if (_count > _buckets.size())
+    {
+        rehash(max(16U, (uint)_buckets.size() * 2U));
+    }
+    else
+    {
+        uint b = bucket(coords);
+        entry.next = _buckets[b];
+        _buckets[b] = index;
+    }
+}
+
+void VertexGrid::invalidate()
+{
+    _entries.clear();
+    _buckets.clear();
+    _freeEntries = UINT_MAX;
+    _count = 0U;
+    _isValid = false;
+}
+
+void VertexGrid::build(const FPList<VertexNode, Vertex2> &vertices)
+{
+    invalidate();
+    
+    Vector3D minimum, maximum;
+    uint count = 0U;
+    
+    for (VertexNode *node = vertices.begin(), *end = vertices.end(); node != end; node = node->next())
+    {
+        const Vector3D &v = node->data().position;
+        
+        if (count == 0U)
+        {
+            minimum = v;
+            maximum = v;
+        }
+        else
+        {
+            for (uint i = 0; i < 3; i++)
+            {
+                minimum[i] = min(minimum[i], v[i]);
+                maximum[i] = max(maximum[i], v[i]);
+            }
+        }
+        
+        count++;
+    }
+    
+    // vertices mostly lie on a surface, so this keeps a few vertices per cell
+    Vector3D extent = maximum - minimum;
+    float largestExtent = max(extent.x, max(extent.y, extent.z));
+    
+    if (count > 0U && largestExtent > 0.0f)
+        _cellSize = 2.0f * largestExtent / sqrtf((float)count);
+    else
+        _cellSize = 1.0f;
+    
+    _invCellSize = 1.0f / _cellSize;
+    
+    uint bucketCount = 16U;
+    while (bucketCount < count)
+        bucketCount *= 2U;
+    
+    _entries.reserve(count);
+    _buckets.assign(bucketCount, UINT_MAX);
+    
+    for (VertexNode *node = vertices.begin(), *end = vertices.end(); node != end; node = node->next())
+        add(node);
+    
+    _isValid = true;
+}
+
+void VertexGrid::add(VertexNode *node)
+{
+    int coords[3];
+    cell(node->data().position, coords);
+    addEntry(node, coords);
+}
+
+void VertexGrid::remove(VertexNode *node)
+{
+    if (_count == 0U)
+        return;
+    
+    int coords[3];
+    cell(node->data().position, coords);
+    
+    uint b = bucket(coords);
+    uint previous = UINT_MAX;
+    
+    for (uint i = _buckets[b]; i != UINT_MAX; previous = i, i = _entries[i].next)
+    {
+        Entry &entry = _entries[i];
+        if (entry.node != node)
+            continue;
+        
+        if (previous == UINT_MAX)
+            _buckets[b] = entry.next;
+        else
+            _entries[previous].next = entry.next;
+        
+        entry.node = NULL;
+        entry.next = _freeEntries;
+        _freeEntries = i;
+        _count--;
+        return;
+    }
+    
+    // vertex was moved without being removed first
+    invalidate();
+}
+
+void VertexGrid::update(VertexNode *node)
+{
+    int coords[3];
+    cell(node->data().position, coords);
+    
+    if (_count == 0U || findEntry(node, coords) == UINT_MAX)
+        addEntry(node, coords);
+}
+
+// keeps the count nearest candidates sorted by squared distance
+struct NearestVertices
+{
+    Vector3D position;
+    uint count;
+    const vector<VertexNode *> &skipVertices;
+    vector<VertexNode *> nodes;
+    vector<float> distances;
+    
+    NearestVertices(const Vector3D &position, uint count, const vector<VertexNode *> &skipVertices) :
+        position(position), count(count), skipVertices(skipVertices) { }
+    
+    bool isFull() const { return nodes.size() == count; }
+    float farthest() const { return distances.back(); }
+    
+    void test(VertexNode *node)
+    {
+        float distance = node->data().position.SqDistance(position);
+        if (isFull() && distance >= farthest())
+            return;
+        
+        if (find(skipVertices.begin(), skipVertices.end(), node) != skipVertices.end())
+            return;
+        
+        uint index = lower_bound(distances.begin(), distances.end(), distance) - distances.begin();
+        distances.insert(distances.begin() + index, distance);
+        nodes.insert(nodes.begin() + index, node);
+        
+        if (nodes.size() > count)
+        {
+            distances.pop_back();
+            nodes.pop_back();
+        }
+    }
+};
+
+void VertexGrid::findNearest(const Vector3D &position, uint count, vector<VertexNode *> &nearest) const
+{
+    if (_count == 0U || count == 0U)
+        return;
+    
+    NearestVertices result(position, count, nearest);
+    
+    int q[3];
+    cell(position, q);
+    
+    // shells of cells around q, limited to cells that can contain vertices
+    int firstShell = 0;
+    int lastShell = 0;
+    
+    for (uint i = 0; i < 3; i++)
+    {
+        firstShell = max(firstShell, max(_minCell[i] - q[i], q[i] - _maxCell[i]));
+        lastShell = max(lastShell, max(q[i] - _minCell[i], _maxCell[i] - q[i]));
+    }
+    
+    uint visitedCells = 0U;
+    
+    for (int r = firstShell; r <= lastShell; r++)
+    {
+        // vertices in shell r and further are at least r - 1 cells away
+        if (result.isFull() && r > 0)
+        {
+            float bound = (float)(r - 1) * _cellSize;
+            if (result.farthest() <= bound * bound)
+                break;
+        }
+        
+        // far from the surface most cells are empty, scanning all entries is cheaper
+        if (visitedCells > _count)
+        {
+            result.nodes.clear();
+            result.distances.clear();
+            
+            for (uint i = 0; i < _entries.size(); i++)
+            {
+                if (_entries[i].node != NULL)
+                    result.test(_entries[i].node);
+            }
+            break;
+        }
+        
+        int lo[3], hi[3];
+        for (uint i = 0; i < 3; i++)
+        {
+            lo[i] = max(q[i] - r, _minCell[i]);
+            hi[i] = min(q[i] + r, _maxCell[i]);
+        }
+        
+        for (int x = lo[0]; x <= hi[0]; x++)
+        {
+            for (int y = lo[1]; y <= hi[1]; y++)
+            {
+                // inner columns only cross the shell at its two z faces
+                bool isShellFace = abs(x - q[0]) == r || abs(y - q[1]) == r;
+                int zStep = isShellFace ? 1 : 2 * r;
+                
+                for (int z = isShellFace ? lo[2] : q[2] - r; z <= hi[2]; z += zStep)
+                {
+                    if (z < lo[2])
+                        continue;
+                    
+                    int coords[3] = { x, y, z };
+                    visitedCells++;
+                    
+                    for (uint i = _buckets[bucket(coords)]; i != UINT_MAX; i = _entries[i].next)
+                    {
+                        const Entry &entry = _entries[i];
+                        if (entry.cell[0] == coords[0] && entry.cell[1] == coords[1] && entry.cell[2] == coords[2])
+                            result.test(entry.node);
+                    }
+                }
+            }
+        }
+    }
+    
+    nearest.insert(nearest.end(), result.nodes.begin(), result.nodes.end());
+}
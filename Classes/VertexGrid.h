@@ -0,0 +1,60 @@
+//
+//  VertexGrid.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "MeshHelpers.h"
+
+// Uniform grid over vertex positions for nearest vertex queries. Cells are
+// hashed into buckets, so the grid does not need bounds and vertices can be
+// added anywhere. Entries are looked up by the cell of the current vertex
+// position, vertices have to be removed before they are moved and added
+// again afterwards.
+class VertexGrid
+{
+private:
+    struct Entry
+    {
+        VertexNode *node;
+        int cell[3];
+        uint next;
+    };
+    
+    vector<Entry> _entries;
+    vector<uint> _buckets;
+    uint _freeEntries;
+    uint _count;
+    
+    float _cellSize;
+    float _invCellSize;
+    int _minCell[3];
+    int _maxCell[3];
+    bool _isValid;
+    
+    void cell(const Vector3D &position, int coords[3]) const;
+    uint bucket(const int coords[3]) const;
+    void rehash(uint bucketCount);
+    uint findEntry(VertexNode *node, const int coords[3]) const;
+    void addEntry(VertexNode *node, const int coords[3]);
+public:
+    VertexGrid();
+    
+    bool isValid() const { return _isValid; }
+    uint count() const { return _count; }
+    
+    void invalidate();
+    void build(const FPList<VertexNode, Vertex2> &vertices);
+    
+    void add(VertexNode *node);
+    void remove(VertexNode *node);
+    void update(VertexNode *node);
+    
+    // appends up to count vertices nearest to position, nearest first,
+    // vertices already in nearest are skipped
+    void findNearest(const Vector3D &position, uint count, vector<VertexNode *> &nearest) const;
+};
@@ -0,0 +1,666 @@
+//
+//  WavefrontObject.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "WavefrontObject.h"
+#include "MappedFile.h"
+#include "ParallelFor.h"
+#include "TextHelpers.h"
+#include <string.h>
+#include <limits.h>
+
+// smaller files are parsed on the calling thread
+const size_t WavefrontMinimumChunkLength = 1 << 20;
+
+// lines of one item formatted together on a worker thread
+const uint WavefrontMinimumPartLines = 1 << 14;
+
+const uint RelativeVertexShift = 0;
+const uint RelativeTexCoordShift = 4;
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char *skipSpaces(const char *p, const char *end)
+{
+    while (p < end && isSpace(*p))
+        p++;
+    return p;
+}
+
+struct WavefrontCorner
+{
+    uint vertexIndex;
+    uint texCoordIndex;
+    // relative indices are counted from the start of the chunk
+    bool relativeVertex;
+    bool relativeTexCoord;
+};
+
+// One line aligned part of the text, parsed independently of the others.
+struct WavefrontChunk
+{
+    const char *begin;
+    const char *end;
+    
+    vector<Vector3D> vertices;
+    vector<Vector3D> texCoords;
+    vector<TriQuad> triangles;
+    // bits of corners with relative indices, one byte for every triangle
+    vector<unsigned char> relativeCorners;
+    vector<uint> groups;
+    
+    uint vertexOffset;
+    uint texCoordOffset;
+    uint triangleOffset;
+    bool valid;
+    
+    vector<WavefrontCorner> corners;
+    
+    void parse();
+    void parseFace(const char *p, const char *lineEnd);
+    void addTriangle(uint first, uint second, uint third, uint fourth, bool isQuad);
+};
+
+void WavefrontChunk::parse()
+{
+    const char *p = begin;
+    
+    while (p < end)
+    {
+        const char *lineEnd = (const char *)memchr(p, '\n', end - p);
+        if (lineEnd == NULL)
+            lineEnd = end;
+        
+        p = skipSpaces(p, lineEnd);
+        
+        const char *keyword = p;
+        while (p < lineEnd && !isSpace(*p))
+            p++;
+        
+        size_t keywordLength = p - keyword;
+        
+        if (keywordLength == 1 && keyword[0] == 'v')
+        {
+            // v -5.79346 -1.38018 42.63113
+            Vector3D v;
+            for (uint i = 0; i < 3; i++)
+            {
+                p = skipSpaces(p, lineEnd);
+                if (!ParseFloat(p, lineEnd, v[i]))
+                    break;
+            }
+            
+            swap(v.y, v.z);
+            v.z = -v.z;
+            
+            vertices.push_back(v);
+        }
+        else if (keywordLength == 2 && keyword[0] == 'v' && keyword[1] == 't')
+        {
+            // vt 0.12528 -0.64560
+            Vector3D vt;
+            for (uint i = 0; i < 2; i++)
+            {
+                p = skipSpaces(p, lineEnd);
+                if (!ParseFloat(p, lineEnd, vt[i]))
+                    break;
+            }
+            
+            texCoords.push_back(vt);
+        }
+        else if (keywordLength == 1 && keyword[0] == 'f')
+        {
+            parseFace(p, lineEnd);
+        }
+        else if (keywordLength == 1 && keyword[0] == 'g')
+        {
+            // g group_name
+            groups.push_back(triangles.size());
+        }
+        
+        p = lineEnd + 1;
+    }
+}
+
+void WavefrontChunk::parseFace(const char *p, const char *lineEnd)
+{
+    // f  v1 v2 v3 v4 ...
+    // f  v1/vt1 v2/vt2 v3/vt3 ...
+    // f  v1/vt1/vn1 v2/vt2/vn2 v3/vt3/vn3 ...
+    // f  v1//vn1 v2//vn2 v3//vn3 ...
+    
+    corners.clear();
+    
+    while (true)
+    {
+        p = skipSpaces(p, lineEnd);
+        
+        int vertexIndex = 0;
+        if (!ParseInt(p, lineEnd, vertexIndex))
+            break;
+        
+        int texCoordIndex = 0;
+        if (p < lineEnd && *p == '/')
+        {
+            p++;
+            ParseInt(p, lineEnd, texCoordIndex);
+            
+            // normals are computed by Mesh2
+            int normalIndex = 0;
+            if (p < lineEnd && *p == '/')
+            {
+                p++;
+                ParseInt(p, lineEnd, normalIndex);
+            }
+        }
+        
+        // indices start from 1, negative ones count back from the last vertex
+        WavefrontCorner corner;
+        corner.relativeVertex = vertexIndex < 0;
+        corner.vertexIndex = vertexIndex < 0 ? (uint)((int)vertices.size() + vertexIndex) : (vertexIndex == 0 ? 0 : (uint)vertexIndex - 1);
+        corner.relativeTexCoord = texCoordIndex < 0;
+        corner.texCoordIndex = texCoordIndex < 0 ? (uint)((int)texCoords.size() + texCoordIndex) : (texCoordIndex == 0 ? 0 : (uint)texCoordIndex - 1);
+        corners.push_back(corner);
+    }
+    
+    uint count = corners.size();
+    if (count < 3)
+        return;
+    
+    uint i = 1;
+    for (; i + 2 < count; i += 2)
+        addTriangle(0, i, i + 1, i + 2, true);
+    
+    if (i + 1 < count)
+        addTriangle(0, i, i + 1, 0, false);
+}
+
+void WavefrontChunk::addTriangle(uint first, uint second, uint third, uint fourth, bool isQuad)
+{
+    // reversed order is the same as Mesh2::flipAllTriangles
+    uint order[4] = { third, second, first, fourth };
+    
+    TriQuad triQuad;
+    unsigned char relative = 0;
+    
+    for (uint i = 0; i < 4; i++)
+    {
+        const WavefrontCorner &corner = corners[order[i]];
+        triQuad.vertexIndices[i] = corner.vertexIndex;
+        triQuad.texCoordIndices[i] = corner.texCoordIndex;
+        
+        if (corner.relativeVertex)
+            relative |= 1 << (RelativeVertexShift + i);
+        if (corner.relativeTexCoord)
+            relative |= 1 << (RelativeTexCoordShift + i);
+    }
+    
+    triQuad.isQuad = isQuad;
+    triangles.push_back(triQuad);
+    relativeCorners.push_back(relative);
+}
+
+struct ParseChunksBody
+{
+    vector<WavefrontChunk> &chunks;
+    ParseChunksBody(vector<WavefrontChunk> &chunks) : chunks(chunks) { }
+    void operator()(uint first, uint last)
+    {
+        for (uint i = first; i < last; i++)
+            chunks[i].parse();
+    }
+};
+
+// Copies chunks into one object and turns relative indices into absolute.
+struct StitchChunksBody
+{
+    vector<WavefrontChunk> &chunks;
+    WavefrontObject &object;
+    uint texCoordCount;
+    
+    StitchChunksBody(vector<WavefrontChunk> &chunks, WavefrontObject &object, uint texCoordCount)
+        : chunks(chunks), object(object), texCoordCount(texCoordCount) { }
+    
+    void operator()(uint first, uint last)
+    {
+        for (uint i = first; i < last; i++)
+            stitch(chunks[i]);
+    }
+    
+    void stitch(WavefrontChunk &chunk)
+    {
+        chunk.valid = true;
+        
+        copy(chunk.vertices.begin(), chunk.vertices.end(), object.vertices.begin() + chunk.vertexOffset);
+        copy(chunk.texCoords.begin(), chunk.texCoords.end(), object.texCoords.begin() + chunk.texCoordOffset);
+        
+        uint vertexCount = object.vertices.size();
+        
+        for (uint i = 0; i < chunk.triangles.size(); i++)
+        {
+            TriQuad triQuad = chunk.triangles[i];
+            unsigned char relative = chunk.relativeCorners[i];
+            uint count = triQuad.isQuad ? 4 : 3;
+            
+            for (uint j = 0; j < count; j++)
+            {
+                // unsigned wrap around gives the right index also for
+                // relative indices pointing into previous chunks
+                if (relative & (1 << (RelativeVertexShift + j)))
+                    triQuad.vertexIndices[j] += chunk.vertexOffset;
+                if (relative & (1 << (RelativeTexCoordShift + j)))
+                    triQuad.texCoordIndices[j] += chunk.texCoordOffset;
+                
+                if (triQuad.vertexIndices[j] >= vertexCount || triQuad.texCoordIndices[j] >= texCoordCount)
+                    chunk.valid = false;
+            }
+            
+            object.triangles[chunk.triangleOffset + i] = triQuad;
+        }
+        
+        // chunks keep only what the next steps need
+        vector<Vector3D>().swap(chunk.vertices);
+        vector<Vector3D>().swap(chunk.texCoords);
+        vector<TriQuad>().swap(chunk.triangles);
+        vector<unsigned char>().swap(chunk.relativeCorners);
+    }
+};
+
+bool WavefrontObject::readFile(const char *fileName)
+{
+    MappedFile file(fileName);
+    if (!file.isOpen())
+        return false;
+    
+    return read(file.data(), file.length());
+}
+
+bool WavefrontObject::read(const char *text, size_t length, uint chunkCount)
+{
+    vertices.clear();
+    texCoords.clear();
+    triangles.clear();
+    groups.clear();
+    
+    if (chunkCount == 0)
+    {
+        size_t lengthChunkCount = length / WavefrontMinimumChunkLength;
+        chunkCount = lengthChunkCount < ParallelForThreadCount() ? (uint)lengthChunkCount : ParallelForThreadCount();
+        if (chunkCount < 1)
+            chunkCount = 1;
+    }
+    
+    vector<WavefrontChunk> chunks(chunkCount);
+    
+    const char *end = text + length;
+    const char *begin = text;
+    
+    for (uint i = 0; i < chunkCount; i++)
+    {
+        const char *chunkEnd = i + 1 < chunkCount ? text + length / chunkCount * (i + 1) : end;
+        if (chunkEnd < begin)
+            chunkEnd = begin;
+        
+        // chunks end after a whole line
+        if (chunkEnd < end)
+        {
+            const char *lineEnd = (const char *)memchr(chunkEnd, '\n', end - chunkEnd);
+            chunkEnd = lineEnd != NULL ? lineEnd + 1 : end;
+        }
+        
+        chunks[i].begin = begin;
+        chunks[i].end = chunkEnd;
+        begin = chunkEnd;
+    }
+    
+    ParseChunksBody parseChunks(chunks);
+    ParallelFor(chunks.size(), 1, parseChunks);
+    
+    uint vertexCount = 0;
+    uint texCoordCount = 0;
+    uint triangleCount = 0;
+    
+    for (uint i = 0; i < chunks.size(); i++)
+    {
+        WavefrontChunk &chunk = chunks[i];
+        chunk.vertexOffset = vertexCount;
+        chunk.texCoordOffset = texCoordCount;
+        chunk.triangleOffset = triangleCount;
+        
+        for (uint j = 0; j < chunk.groups.size(); j++)
+            groups.push_back(chunk.groups[j] + triangleCount);
+        
+        vertexCount += chunk.vertices.size();
+        texCoordCount += chunk.texCoords.size();
+        triangleCount += chunk.triangles.size();
+    }
+    
+    vertices.resize(vertexCount);
+    texCoords.resize(texCoordCount);
+    triangles.resize(triangleCount);
+    
+    // without vt triangles use vertices as texture coordinates
+    StitchChunksBody stitchChunks(chunks, *this, texCoordCount > 0 ? texCoordCount : vertexCount);
+    ParallelFor(chunks.size(), 1, stitchChunks);
+    
+    for (uint i = 0; i < chunks.size(); i++)
+    {
+        if (!chunks[i].valid)
+            return false;
+    }
+    
+    return true;
+}
+
+ItemCollection *WavefrontObject::makeItems() const
+{
+    const vector<Vector3D> &meshTexCoords = texCoords.empty() ? vertices : texCoords;
+    
+    ItemCollection *items = new ItemCollection();
+    
+    if (groups.empty())
+    {
+        Mesh2 *mesh = new Mesh2();
+        mesh->fromIndexRepresentation(vertices, meshTexCoords, triangles);
+        mesh->setSelectionMode(MeshSelectionMode::Triangles);
+        
+        Item *item = new Item(mesh);
+        item->setPositionToGeometricCenter();
+        items->addItem(item);
+        return items;
+    }
+    
+    // indices in the group mesh, UINT_MAX when not used by the group yet
+    vector<uint> vertexMap(vertices.size(), UINT_MAX);
+    vector<uint> texCoordMap(meshTexCoords.size(), UINT_MAX);
+    
+    vector<Vector3D> groupVertices;
+    vector<Vector3D> groupTexCoords;
+    vector<TriQuad> groupTriangles;
+    
+    for (uint i = 0; i < groups.size(); i++)
+    {
+        uint first = groups[i];
+        uint last = i + 1 < groups.size() ? groups[i + 1] : triangles.size();
+        if (first >= last)
+            continue;
+        
+        groupVertices.clear();
+        groupTexCoords.clear();
+        groupTriangles.clear();
+        
+        for (uint j = first; j < last; j++)
+        {
+            TriQuad triQuad = triangles[j];
+            uint count = triQuad.isQuad ? 4 : 3;
+            
+            for (uint k = 0; k < count; k++)
+            {
+                uint &vertexIndex = vertexMap[triQuad.vertexIndices[k]];
+                if (vertexIndex == UINT_MAX)
+                {
+                    vertexIndex = groupVertices.size();
+                    groupVertices.push_back(vertices[triQuad.vertexIndices[k]]);
+                }
+                
+                uint &texCoordIndex = texCoordMap[triQuad.texCoordIndices[k]];
+                if (texCoordIndex == UINT_MAX)
+                {
+                    texCoordIndex = groupTexCoords.size();
+                    groupTexCoords.push_back(meshTexCoords[triQuad.texCoordIndices[k]]);
+                }
+                
+                triQuad.vertexIndices[k] = vertexIndex;
+                triQuad.texCoordIndices[k] = texCoordIndex;
+            }
+            
+            groupTriangles.push_back(triQuad);
+        }
+        
+        // maps are reset only where this group wrote into them
+        for (uint j = first; j < last; j++)
+        {
+            const TriQuad &triQuad = triangles[j];
+            uint count = triQuad.isQuad ? 4 : 3;
+            
+            for (uint k = 0; k < count; k++)
+            {
+                vertexMap[triQuad.vertexIndices[k]] = UINT_MAX;
+                texCoordMap[triQuad.texCoordIndices[k]] = UINT_MAX;
+            }
+        }
+        
+        Item *item = new Item(new Mesh2());
+        item->mesh->fromIndexRepresentation(groupVertices, groupTexCoords, groupTriangles);
+        item->setPositionToGeometricCenter();
+        items->addItem(item);
+    }
+    
+    return items;
+}
+
+enum WavefrontPartKind
+{
+    WavefrontPartVertices,
+    WavefrontPartTexCoords,
+    WavefrontPartTriangles
+};
+
+// Range of lines of one item, formatted on its own.
+struct WavefrontPart
+{
+    WavefrontPartKind kind;
+    uint first;
+    uint last;
+    string text;
+};
+
+struct FormatPartsBody
+{
+    vector<WavefrontPart> &parts;
+    vector<Vector3D> &vertices;
+    const vector<Vector3D> &texCoords;
+    const vector<TriQuad> &triangles;
+    const Matrix4x4 &transform;
+    uint vertexIndexOffset;
+    uint texCoordIndexOffset;
+    
+    FormatPartsBody(vector<WavefrontPart> &parts, vector<Vector3D> &vertices, const vector<Vector3D> &texCoords,
+                    const vector<TriQuad> &triangles, const Matrix4x4 &transform)
+        : parts(parts), vertices(vertices), texCoords(texCoords), triangles(triangles), transform(transform) { }
+    
+    void operator()(uint first, uint last)
+    {
+        for (uint i = first; i < last; i++)
+        {
+            WavefrontPart &part = parts[i];
+            
+            switch (part.kind)
+            {
+                case WavefrontPartVertices:
+                    formatVertices(part);
+                    break;
+                case WavefrontPartTexCoords:
+                    formatTexCoords(part);
+                    break;
+                case WavefrontPartTriangles:
+                    formatTriangles(part);
+                    break;
+            }
+        }
+    }
+    
+    void formatVertices(WavefrontPart &part)
+    {
+        part.text.reserve((part.last - part.first) * 40);
+        
+        // ranges of parts do not overlap, so vertices are transformed in place
+        transform.TransformPositions(&vertices[part.first], part.last - part.first);
+        
+        for (uint i = part.first; i < part.last; i++)
+        {
+            // v -5.79346 -1.38018 42.63113
+            const Vector3D &v = vertices[i];
+            part.text += "v ";
+            AppendFloat(part.text, v.x);
+            part.text += ' ';
+            AppendFloat(part.text, -v.z);
+            part.text += ' ';
+            AppendFloat(part.text, v.y);
+            part.text += '\n';
+        }
+    }
+    
+    void formatTexCoords(WavefrontPart &part)
+    {
+        part.text.reserve((part.last - part.first) * 28);
+        
+        for (uint i = part.first; i < part.last; i++)
+        {
+            // vt 0.12528 -0.64560
+            part.text += "vt ";
+            AppendFloat(part.text, texCoords[i].x);
+            part.text += ' ';
+            AppendFloat(part.text, texCoords[i].y);
+            part.text += " \n";
+        }
+    }
+    
+    void formatTriangles(WavefrontPart &part)
+    {
+        part.text.reserve((part.last - part.first) * 48);
+        
+        for (uint i = part.first; i < part.last; i++)
+        {
+            // f  v1/vt1 v2/vt2 v3/vt3 ...
+            const TriQuad &triQuad = triangles[i];
+            uint count = triQuad.isQuad ? 4 : 3;
+            
+            // reversed order is the same as Mesh2::flipAllTriangles
+            uint order[4] = { 2, 1, 0, 3 };
+            
+            part.text += "f ";
+            for (uint j = 0; j < count; j++)
+            {
+                AppendUInt(part.text, triQuad.vertexIndices[order[j]] + vertexIndexOffset);
+                part.text += '/';
+                AppendUInt(part.text, triQuad.texCoordIndices[order[j]] + texCoordIndexOffset);
+                part.text += ' ';
+            }
+            part.text += '\n';
+        }
+    }
+};
+
+static void addParts(vector<WavefrontPart> &parts, WavefrontPartKind kind, uint count, uint partCount)
+{
+    if (partCount == 0)
+    {
+        partCount = count / WavefrontMinimumPartLines;
+        if (partCount > ParallelForThreadCount())
+            partCount = ParallelForThreadCount();
+        if (partCount < 1)
+            partCount = 1;
+    }
+    
+    for (uint i = 0; i < partCount; i++)
+    {
+        WavefrontPart part;
+        part.kind = kind;
+        part.first = (uint)((unsigned long long)count * i / partCount);
+        part.last = (uint)((unsigned long long)count * (i + 1) / partCount);
+        parts.push_back(part);
+    }
+}
+
+static void writeItems(ItemCollection &items, const char *version, uint partCount, TextOutput &output)
+{
+    string line;
+    
+    line = "# Exported from MeshMaker ";
+    line += version;
+    line += '\n';
+    output.append(line);
+    
+    // face indices in Wavefront Object starts from 1
+    uint vertexIndexOffset = 1;
+    uint texCoordIndexOffset = 1;
+    
+    vector<Vector3D> vertices;
+    vector<Vector3D> texCoords;
+    vector<TriQuad> triangles;
+    vector<WavefrontPart> parts;
+    
+    for (uint itemIndex = 0; itemIndex < items.count() && output.isValid(); itemIndex++)
+    {
+        Item *item = items.itemAtIndex(itemIndex);
+        Matrix4x4 transform = item->transform();
+        
+        vertices.clear();
+        texCoords.clear();
+        triangles.clear();
+        
+        // algorithm data of shared meshes are written here, not on workers
+        item->mesh->toIndexRepresentation(vertices, texCoords, triangles);
+        
+        parts.clear();
+        addParts(parts, WavefrontPartVertices, vertices.size(), partCount);
+        addParts(parts, WavefrontPartTexCoords, texCoords.size(), partCount);
+        addParts(parts, WavefrontPartTriangles, triangles.size(), partCount);
+        
+        FormatPartsBody formatParts(parts, vertices, texCoords, triangles, transform);
+        formatParts.vertexIndexOffset = vertexIndexOffset;
+        formatParts.texCoordIndexOffset = texCoordIndexOffset;
+        ParallelFor(parts.size(), 1, formatParts);
+        
+        line = "g Item_";
+        AppendUInt(line, itemIndex);
+        line += "\n# Number of vertices = ";
+        AppendUInt(line, vertices.size());
+        line += '\n';
+        output.append(line);
+        
+        for (uint i = 0; i < parts.size(); i++)
+        {
+            if (parts[i].kind == WavefrontPartTexCoords && (i == 0 || parts[i - 1].kind != WavefrontPartTexCoords))
+            {
+                line = "# Number of texture coordinates = ";
+                AppendUInt(line, texCoords.size());
+                line += '\n';
+                output.append(line);
+            }
+            else if (parts[i].kind == WavefrontPartTriangles && (i == 0 || parts[i - 1].kind != WavefrontPartTriangles))
+            {
+                line = "# Number of triangles and quads = ";
+                AppendUInt(line, triangles.size());
+                line += '\n';
+                output.append(line);
+            }
+            
+            output.append(parts[i].text);
+        }
+        
+        vertexIndexOffset += vertices.size();
+        texCoordIndexOffset += texCoords.size();
+    }
+}
+
+void WavefrontObject::write(ItemCollection &items, const char *version, string &text, uint partCount)
+{
+    TextOutput output(text);
+    writeItems(items, version, partCount, output);
+}
+
+bool WavefrontObject::writeFile(ItemCollection &items, const char *version, const char *fileName)
+{
+    TextOutput output(fileName);
+    writeItems(items, version, 0, output);
+    return output.close();
+}
@@ -0,0 +1,48 @@
+//
+//  WavefrontObject.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "MathDeclaration.h"
+#include "MeshForwardDeclaration.h"
+#include "ItemCollection.h"
+#include <string>
+
+// Wavefront Object in the index representation of Mesh2, already converted
+// to MeshMaker axes and winding. Text is split into line aligned chunks which
+// are parsed on ParallelFor worker threads and stitched together afterwards,
+// so negative (relative) indices work across chunks. Polygons with more than
+// four vertices are split into a fan of quads.
+class WavefrontObject
+{
+public:
+    vector<Vector3D> vertices;
+    // empty when the file has no vt, triangles then index vertices instead
+    vector<Vector3D> texCoords;
+    vector<TriQuad> triangles;
+    // first triangle of every g line
+    vector<uint> groups;
+    
+    // maps the file into memory, fileName is in UTF-8
+    bool readFile(const char *fileName);
+    // text does not need to end with zero, returns false for indices out of range,
+    // chunkCount 0 picks the count by length of the text and worker threads
+    bool read(const char *text, size_t length, uint chunkCount = 0);
+    
+    // every nonempty group becomes an item, without groups the whole object is one item
+    ItemCollection *makeItems() const;
+    
+    // Items as Wavefront Object text, each of them in a g group. Positions
+    // are transformed while formatting, vertices, texture coordinates and
+    // faces of every item are split into parts formatted on ParallelFor
+    // worker threads and appended in order. partCount 0 picks the count by
+    // lines and worker threads, the text is the same for every count.
+    static void write(ItemCollection &items, const char *version, string &text, uint partCount = 0);
+    // streams text to the file item after item, fileName is in UTF-8
+    static bool writeFile(ItemCollection &items, const char *version, const char *fileName);
+};
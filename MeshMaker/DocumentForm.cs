@@ -528,12 +528,19 @@ namespace MeshMaker
             {
                 using (MemoryStream stream = new MemoryStream(File.ReadAllBytes(lastFileName)))
                 {
-                    document.readModel3D(stream);
+                    if (!document.readModel3D(stream))
+                        MessageBox.Show("Cannot read Model 3D: " + lastFileName);
                 }
             }
             else if (Path.GetExtension(lastFileName).Equals(".obj", StringComparison.InvariantCultureIgnoreCase))
             {
-                document.readWavefrontObject(File.ReadAllText(lastFileName));
+                if (!document.readWavefrontObject(lastFileName))
+                    MessageBox.Show("Cannot read Wavefront Object: " + lastFileName);
+            }
+            else if (Path.GetExtension(lastFileName).Equals(".dae", StringComparison.InvariantCultureIgnoreCase))
+            {
+                if (!document.readCollada(lastFileName))
+                    MessageBox.Show("Cannot read Collada: " + lastFileName);
             }
             else
             {
@@ -553,8 +560,13 @@ namespace MeshMaker
             }
             else if (Path.GetExtension(lastFileName).Equals(".obj", StringComparison.InvariantCultureIgnoreCase))
             {
-                string contents = document.writeWavefrontObject();
-                File.WriteAllText(lastFileName, contents);
+                if (!document.writeWavefrontObject(lastFileName))
+                    MessageBox.Show("Cannot write Wavefront Object: " + lastFileName);
+            }
+            else if (Path.GetExtension(lastFileName).Equals(".dae", StringComparison.InvariantCultureIgnoreCase))
+            {
+                if (!document.writeCollada(lastFileName))
+                    MessageBox.Show("Cannot write Collada: " + lastFileName);
             }
             else
             {
@@ -0,0 +1,60 @@
+#-------------------------------------------------
+#
+# Headless render benchmark, draws scene with EGL
+# into offscreen pbuffer and reports per frame
+# times of mesh cache fills, uploads and draws.
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = MeshMakerBenchmark
+TEMPLATE = app
+CONFIG   += console
+CONFIG   -= app_bundle
+
+DEFINES += RENDER_STATISTICS
+
+SOURCES += main.cpp \
+    OffscreenSceneView.cpp \
+    ../Classes/Vector4D.cpp \
+    ../Classes/Vector3D.cpp \
+    ../Classes/Vector2D.cpp \
+    ../Classes/Quaternion.cpp \
+    ../Classes/Matrix4x4.cpp \
+    ../Classes/Camera.cpp \
+    ../Classes/Item.cpp \
+    ../Classes/ItemCollection.cpp \
+    ../Classes/Manipulator.cpp \
+    ../Classes/ManipulatorWidget.cpp \
+    ../Classes/MemoryStream.cpp \
+    ../Classes/Mesh2.drawing.cpp \
+    ../Classes/Mesh2.make.cpp \
+    ../Classes/Mesh2.cpp \
+    ../Classes/MeshHelpers.cpp \
+    ../Classes/OpenGLDrawing.cpp \
+    ../Classes/OpenGLManipulatingController.cpp \
+    ../Classes/Shader.cpp \
+    ../Classes/ShaderProgram.cpp \
+    ../Classes/Triangle.cpp \
+    ../Classes/OpenGLSceneViewCore.cpp \
+    ../Classes/VertexGrid.cpp \
+    ../Classes/TriangleBVH.cpp \
+    ../Classes/ParallelFor.cpp \
+    ../Classes/ColoredVertexBuffer.cpp \
+    ../Classes/SelectionFrustum.cpp \
+    ../Classes/SelectionFrame.cpp \
+    ../Classes/RenderStatistics.cpp
+
+HEADERS  += OffscreenSceneView.h \
+    ../Classes/OpenGLSceneViewCore.h \
+    ../Classes/RenderStatistics.h
+
+QMAKE_CXXFLAGS += -std=c++0x
+
+LIBS += -L/usr/local/lib -lEGL -lGLU -lGLEW -lpthread
+
+# shaders are loaded from the same resources as in MeshMakerQt
+RESOURCES += \
+    ../MeshMakerQt/resources.qrc
@@ -0,0 +1,170 @@
+//
+//  OffscreenSceneView.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "OffscreenSceneView.h"
+#include <EGL/eglext.h>
+
+static EGLDisplay OffscreenDisplay()
+{
+    // surfaceless platform works without X11 or a DRM device
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (getPlatformDisplay != NULL)
+    {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (display != EGL_NO_DISPLAY)
+            return display;
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+OffscreenSceneView::OffscreenSceneView(int width, int height)
+{
+    _width = width;
+    _height = height;
+    _surface = EGL_NO_SURFACE;
+    _context = EGL_NO_CONTEXT;
+    _coreView = NULL;
+
+    _display = OffscreenDisplay();
+    if (_display == EGL_NO_DISPLAY || !eglInitialize(_display, NULL, NULL))
+        return;
+
+    // fixed function drawing needs desktop OpenGL with compatibility profile
+    if (!eglBindAPI(EGL_OPENGL_API))
+        return;
+
+    const EGLint configAttributes[] =
+    {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(_display, configAttributes, &config, 1, &configCount) || configCount == 0)
+        return;
+
+    const EGLint surfaceAttributes[] =
+    {
+        EGL_WIDTH, width,
+        EGL_HEIGHT, height,
+        EGL_NONE
+    };
+
+    _surface = eglCreatePbufferSurface(_display, config, surfaceAttributes);
+    if (_surface == EGL_NO_SURFACE)
+        return;
+
+    EGLContext context = eglCreateContext(_display, config, EGL_NO_CONTEXT, NULL);
+    if (context == EGL_NO_CONTEXT)
+        return;
+
+    if (!eglMakeCurrent(_display, _surface, _surface, context))
+    {
+        eglDestroyContext(_display, context);
+        return;
+    }
+
+    _context = context;
+
+    glewExperimental = GL_TRUE;
+    glewInit();
+
+    // same state as OpenGLSceneView::initializeGL
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+    glShadeModel(GL_SMOOTH);
+    glEnable(GL_LIGHTING);
+    glEnable(GL_LIGHT0);
+
+    _coreView = new OpenGLSceneViewCore(this);
+}
+
+OffscreenSceneView::~OffscreenSceneView()
+{
+    delete _coreView;
+
+    if (_display == EGL_NO_DISPLAY)
+        return;
+
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (_context != EGL_NO_CONTEXT)
+        eglDestroyContext(_display, _context);
+    if (_surface != EGL_NO_SURFACE)
+        eglDestroySurface(_display, _surface);
+
+    eglTerminate(_display);
+}
+
+void OffscreenSceneView::drawFrame()
+{
+    makeCurrentContext();
+    _coreView->draw();
+    glFinish();
+}
+
+NSRect OffscreenSceneView::bounds()
+{
+    return NSMakeRect(0, 0, _width, _height);
+}
+
+void OffscreenSceneView::setNeedsDisplay()
+{
+    // frames are drawn only by drawFrame
+}
+
+void OffscreenSceneView::manipulationStarted()
+{
+
+}
+
+void OffscreenSceneView::manipulationEnded()
+{
+
+}
+
+void OffscreenSceneView::selectionChanged()
+{
+
+}
+
+bool OffscreenSceneView::texturePaintEnabled()
+{
+    return false;
+}
+
+bool OffscreenSceneView::vertexToolEnabled()
+{
+    return false;
+}
+
+void OffscreenSceneView::vertexAddOrConnect(Vector3D position, Camera *camera)
+{
+
+}
+
+void OffscreenSceneView::vertexAddOrConnectHint(Vector3D position, Camera *camera, vector<Vector3D> &vertices)
+{
+
+}
+
+void OffscreenSceneView::makeCurrentContext()
+{
+    eglMakeCurrent(_display, _surface, _surface, _context);
+}
@@ -0,0 +1,49 @@
+//
+//  OffscreenSceneView.h
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#pragma once
+
+#include "../Classes/OpenGLSceneViewCore.h"
+
+#define EGL_NO_X11
+#include <EGL/egl.h>
+
+// Scene view without a window. It renders with EGL into a pbuffer, on the
+// surfaceless platform when Mesa provides it, so no display server or GPU is
+// needed and Mesa falls back to its software rasterizer.
+class OffscreenSceneView : public IOpenGLSceneViewCoreDelegate
+{
+private:
+    EGLDisplay _display;
+    EGLSurface _surface;
+    EGLContext _context;
+    int _width;
+    int _height;
+    OpenGLSceneViewCore *_coreView;
+public:
+    OffscreenSceneView(int width, int height);
+    ~OffscreenSceneView();
+
+    bool isValid() const { return _context != EGL_NO_CONTEXT; }
+    OpenGLSceneViewCore *coreView() { return _coreView; }
+
+    // draws one frame and waits until the renderer finishes it
+    void drawFrame();
+
+    // IOpenGLSceneViewCoreDelegate
+    virtual NSRect bounds();
+    virtual void setNeedsDisplay();
+    virtual void manipulationStarted();
+    virtual void manipulationEnded();
+    virtual void selectionChanged();
+    virtual bool texturePaintEnabled();
+    virtual bool vertexToolEnabled();
+    virtual void vertexAddOrConnect(Vector3D position, Camera *camera);
+    virtual void vertexAddOrConnectHint(Vector3D position, Camera *camera, vector<Vector3D> &vertices);
+    virtual void makeCurrentContext();
+};
@@ -0,0 +1,265 @@
+//
+//  main.cpp
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#include "OffscreenSceneView.h"
+#include "../Classes/RenderStatistics.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct MeshTypeName
+{
+    const char *name;
+    MeshType type;
+};
+
+static const MeshTypeName meshTypeNames[] =
+{
+    { "plane", MeshType::Plane },
+    { "cube", MeshType::Cube },
+    { "cylinder", MeshType::Cylinder },
+    { "sphere", MeshType::Sphere },
+    { "icosahedron", MeshType::Icosahedron },
+};
+
+struct ViewModeName
+{
+    const char *name;
+    ViewMode mode;
+};
+
+static const ViewModeName viewModeNames[] =
+{
+    { "SolidFlat", ViewMode::SolidFlat },
+    { "SolidSmooth", ViewMode::SolidSmooth },
+    { "MixedWireSolid", ViewMode::MixedWireSolid },
+    { "Wireframe", ViewMode::Wireframe },
+    { "Unwrap", ViewMode::Unwrap },
+};
+
+struct SelectionModeName
+{
+    const char *name;
+    MeshSelectionMode mode;
+};
+
+static const SelectionModeName selectionModeNames[] =
+{
+    { "vertices", MeshSelectionMode::Vertices },
+    { "triangles", MeshSelectionMode::Triangles },
+    { "edges", MeshSelectionMode::Edges },
+};
+
+static void printUsage()
+{
+    printf("usage: MeshMakerBenchmark [-frames N] [-size WIDTHxHEIGHT] [-reset] [-edit vertices|triangles|edges] model...\n");
+    printf("  model      plane|cube|cylinder|sphere|icosahedron[:steps[:subdivisions]]\n");
+    printf("  -frames    frames rendered in every view mode, default 20\n");
+    printf("  -size      size of the offscreen view, default 1024x768\n");
+    printf("  -reset     resets mesh caches before every frame, so each frame fills them\n");
+    printf("  -edit      edits the first model in given selection mode\n");
+}
+
+// type[:steps[:subdivisions]], like sphere:32:2
+static Item *makeItem(const char *model)
+{
+    char name[32] = { 0 };
+    uint steps = 0;
+    uint subdivisions = 0;
+
+    const char *separator = strchr(model, ':');
+    size_t nameLength = separator != NULL ? (size_t)(separator - model) : strlen(model);
+    if (nameLength >= sizeof(name))
+        return NULL;
+
+    memcpy(name, model, nameLength);
+    if (separator != NULL)
+        sscanf(separator + 1, "%u:%u", &steps, &subdivisions);
+
+    for (uint i = 0; i < sizeof(meshTypeNames) / sizeof(meshTypeNames[0]); i++)
+    {
+        if (strcmp(name, meshTypeNames[i].name) != 0)
+            continue;
+
+        Item *item = new Item(new Mesh2());
+        Mesh2 *mesh = item->mesh;
+        mesh->make(meshTypeNames[i].type, steps);
+
+        for (uint j = 0; j < subdivisions; j++)
+        {
+            mesh->setSelectionMode(MeshSelectionMode::Triangles);
+            for (uint k = 0; k < mesh->selectedCount(); k++)
+                mesh->setSelectedAtIndex(true, k);
+            mesh->loopSubdivision();
+        }
+
+        mesh->setSelectionMode(MeshSelectionMode::Vertices);
+        for (uint k = 0; k < mesh->selectedCount(); k++)
+            mesh->setSelectedAtIndex(false, k);
+
+        return item;
+    }
+
+    return NULL;
+}
+
+static void resetCaches(ItemCollection &items)
+{
+    for (uint i = 0; i < items.count(); i++)
+        items.itemAtIndex(i)->mesh->resetTriangleCache();
+}
+
+static double milliseconds(double seconds)
+{
+    return seconds * 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+    uint frameCount = 20;
+    int width = 1024;
+    int height = 768;
+    bool reset = false;
+    int editMode = -1;
+
+    ItemCollection items;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-frames") == 0 && i + 1 < argc)
+        {
+            frameCount = (uint)max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "-size") == 0 && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0)
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-reset") == 0)
+        {
+            reset = true;
+        }
+        else if (strcmp(argv[i], "-edit") == 0 && i + 1 < argc)
+        {
+            i++;
+            for (uint j = 0; j < sizeof(selectionModeNames) / sizeof(selectionModeNames[0]); j++)
+            {
+                if (strcmp(argv[i], selectionModeNames[j].name) == 0)
+                    editMode = (int)j;
+            }
+            if (editMode < 0)
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        else
+        {
+            Item *item = makeItem(argv[i]);
+            if (item == NULL)
+            {
+                printUsage();
+                return 1;
+            }
+            // side by side, so all of them are in the view
+            item->position = Vector3D(3.0f * (float)items.count(), 0.0f, 0.0f);
+            items.addItem(item);
+        }
+    }
+
+    if (items.count() == 0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    OffscreenSceneView view(width, height);
+    if (!view.isValid())
+    {
+        printf("cannot create offscreen OpenGL context\n");
+        return 1;
+    }
+
+    printf("%s, %s\n", (const char *)glGetString(GL_RENDERER), (const char *)glGetString(GL_VERSION));
+
+    OpenGLManipulatingController itemsController;
+    OpenGLManipulatingController meshController;
+    itemsController.setModel(&items);
+
+    OpenGLSceneViewCore *coreView = view.coreView();
+    coreView->setDisplayed(&itemsController);
+    coreView->setManipulated(&itemsController);
+
+    uint triangleCount = 0;
+    for (uint i = 0; i < items.count(); i++)
+        triangleCount += items.itemAtIndex(i)->mesh->triangleCount();
+
+    if (editMode >= 0)
+    {
+        Item *item = items.itemAtIndex(0);
+        item->mesh->setSelectionMode(selectionModeNames[editMode].mode);
+        meshController.setModel(item);
+        meshController.setPositionRotationScale(item->position, item->rotation, item->scale);
+        coreView->setManipulated(&meshController);
+    }
+
+    printf("%u items, %u triangles, %dx%d, %u frames per view mode%s\n",
+           items.count(), triangleCount, width, height, frameCount, reset ? ", caches reset every frame" : "");
+    printf("%-16s %6s %10s %10s %10s %10s %10s\n", "view mode", "frame", "fill ms", "upload ms", "draw ms", "other ms", "total ms");
+
+    for (uint i = 0; i < sizeof(viewModeNames) / sizeof(viewModeNames[0]); i++)
+    {
+        // controller changes view mode only of selected items
+        for (uint j = 0; j < items.count(); j++)
+            items.itemAtIndex(j)->setViewMode(viewModeNames[i].mode);
+
+        double sums[RenderPhaseCount + 2] = { 0.0 };
+
+        for (uint frame = 0; frame < frameCount; frame++)
+        {
+            if (reset)
+                resetCaches(items);
+
+            RenderStatistics::reset();
+
+            double start = RenderStatistics::seconds();
+            view.drawFrame();
+            double total = RenderStatistics::seconds() - start;
+
+            double fill = RenderStatistics::total(RenderPhase::CacheFill);
+            double upload = RenderStatistics::total(RenderPhase::Upload);
+            double draw = RenderStatistics::total(RenderPhase::Draw);
+
+            // grid, manipulators and waiting for the renderer in glFinish
+            double other = total - fill - upload - draw;
+
+            printf("%-16s %6u %10.3f %10.3f %10.3f %10.3f %10.3f\n", viewModeNames[i].name, frame,
+                   milliseconds(fill), milliseconds(upload), milliseconds(draw), milliseconds(other), milliseconds(total));
+
+            // the first frame fills caches, the average is of later frames
+            if (frame > 0 || frameCount == 1)
+            {
+                sums[0] += fill;
+                sums[1] += upload;
+                sums[2] += draw;
+                sums[3] += other;
+                sums[4] += total;
+            }
+        }
+
+        double averaged = (double)max(1U, frameCount - 1);
+        printf("%-16s %6s %10.3f %10.3f %10.3f %10.3f %10.3f\n", viewModeNames[i].name, "avg",
+               milliseconds(sums[0] / averaged), milliseconds(sums[1] / averaged), milliseconds(sums[2] / averaged),
+               milliseconds(sums[3] / averaged), milliseconds(sums[4] / averaged));
+    }
+
+    return 0;
+}
@@ -29,6 +29,17 @@ namespace MeshMakerCppCLI
 			return native;
 		}
 
+		static string NativeUTF8String(String ^managedString)
+		{
+			array<Byte> ^chars = Encoding::UTF8->GetBytes(managedString);
+			if (chars->Length == 0)
+				return string();
+			pin_ptr<Byte> charsPointer = &(chars[0]);
+			char *nativeCharsPointer = reinterpret_cast<char *>(static_cast<unsigned char *>(charsPointer));
+			string native(nativeCharsPointer, chars->Length);
+			return native;
+		}
+
 		static String ^ManagedString(string nativeString)
 		{
 			return gcnew String(nativeString.c_str());
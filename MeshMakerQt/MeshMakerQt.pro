@@ -34,7 +34,18 @@ SOURCES += main.cpp\
     ../Classes/OpenGLSceneViewCore.cpp \
     ../Classes/OpenGLSceneView.cpp \
     ../Classes/MyDocument+archiving.cpp \
-    ../Classes/MyDocument.cpp
+    ../Classes/MyDocument.cpp \
+    ../Classes/VertexGrid.cpp \
+    ../Classes/TriangleBVH.cpp \
+    ../Classes/ParallelFor.cpp \
+    ../Classes/ColoredVertexBuffer.cpp \
+    ../Classes/SelectionFrustum.cpp \
+    ../Classes/SelectionFrame.cpp \
+    ../Classes/RenderStatistics.cpp \
+    ../Classes/MappedFile.cpp \
+    ../Classes/WavefrontObject.cpp \
+    ../Classes/TextHelpers.cpp \
+    ../Classes/ColladaDocument.cpp
 
 HEADERS  += mainwindow.h \
     ../Classes/VertexEdge.h \
@@ -75,11 +86,23 @@ HEADERS  += mainwindow.h \
     ../Classes/Camera.h \
     ../Classes/OpenGLSceneViewCore.h \
     ../Classes/OpenGLSceneView.h \
-    ../Classes/MyDocument.h
+    ../Classes/MyDocument.h \
+    ../Classes/FPPool.h \
+    ../Classes/VertexGrid.h \
+    ../Classes/TriangleBVH.h \
+    ../Classes/ParallelFor.h \
+    ../Classes/ColoredVertexBuffer.h \
+    ../Classes/SelectionFrustum.h \
+    ../Classes/SelectionFrame.h \
+    ../Classes/RenderStatistics.h \
+    ../Classes/MappedFile.h \
+    ../Classes/WavefrontObject.h \
+    ../Classes/TextHelpers.h \
+    ../Classes/ColladaDocument.h
 
 QMAKE_CXXFLAGS += -std=c++0x
 
-LIBS += -L/usr/local/lib -lGLU -lGLEW
+LIBS += -L/usr/local/lib -lGLU -lGLEW -lpthread
 
 RESOURCES += \
     resources.qrc
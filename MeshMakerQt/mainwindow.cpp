@@ -1,6 +1,8 @@
 #include "../Classes/OpenGLSceneView.h"
 #include "../Classes/MyDocument.h"
 #include "mainwindow.h"
+#include <QtGui/QFileDialog>
+#include <QtGui/QMessageBox>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -8,7 +10,9 @@ MainWindow::MainWindow(QWidget *parent)
     setWindowTitle(tr("MeshMaker"));
 
     QMenuBar *menuBar = new QMenuBar;
-    menuBar->addMenu(tr("File"));
+    QMenu *fileMenu = menuBar->addMenu(tr("File"));
+    fileMenu->addAction(tr("Open..."), this, SLOT(openFile()), QKeySequence::Open);
+    fileMenu->addAction(tr("Save As..."), this, SLOT(saveFileAs()), QKeySequence::SaveAs);
     menuBar->addMenu(tr("Edit"));
     menuBar->addMenu(tr("View"));
     setMenuBar(menuBar);
@@ -84,3 +88,35 @@ void MainWindow::addIcosahedron()
 {
     document->addItem(MeshType::Icosahedron, 0);
 }
+
+void MainWindow::openFile()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open"), QString(), tr("Wavefront Object (*.obj);;Collada (*.dae)"));
+    if (fileName.isEmpty())
+        return;
+
+    bool read;
+    if (fileName.endsWith(".dae", Qt::CaseInsensitive))
+        read = document->readCollada(fileName.toUtf8().constData());
+    else
+        read = document->readWavefrontObject(fileName.toUtf8().constData());
+
+    if (!read)
+        QMessageBox::warning(this, tr("MeshMaker"), tr("Cannot read %1").arg(fileName));
+}
+
+void MainWindow::saveFileAs()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save As"), QString(), tr("Wavefront Object (*.obj);;Collada (*.dae)"));
+    if (fileName.isEmpty())
+        return;
+
+    bool written;
+    if (fileName.endsWith(".dae", Qt::CaseInsensitive))
+        written = document->writeCollada(fileName.toUtf8().constData());
+    else
+        written = document->writeWavefrontObject(fileName.toUtf8().constData());
+
+    if (!written)
+        QMessageBox::warning(this, tr("MeshMaker"), tr("Cannot write %1").arg(fileName));
+}
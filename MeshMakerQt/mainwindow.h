@@ -17,6 +17,9 @@ public:
     ~MainWindow();
 
 public slots:
+    void openFile();
+    void saveFileAs();
+
     void setSelect();
     void setTranslate();
     void setRotate();
@@ -1,5 +1,6 @@
 // fragment.fs
 
+uniform bool flatShading;
 varying vec3 normal;
 varying vec3 eyeCoords;
 
@@ -21,6 +22,10 @@ void main()
         baseColor = vec4(0.5, 0.5, 0.5, 0.0);
     }
     
+    // face normal from screen space derivatives, it always faces the eye
+    if (flatShading)
+        n = normalize(cross(dFdx(eyeCoords), dFdy(eyeCoords)));
+    
     vec4 material = baseColor;
     
     vec3 s = normalize(l - eyeCoords);
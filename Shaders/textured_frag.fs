@@ -1,6 +1,7 @@
 // textured_frag.fs
 
 uniform sampler2D texture;
+uniform bool flatShading;
 varying vec3 normal;
 varying vec3 eyeCoords;
 
@@ -22,6 +23,10 @@ void main()
         baseColor = vec4(0.5, 0.5, 0.5, 0.0);
     }
     
+    // face normal from screen space derivatives, it always faces the eye
+    if (flatShading)
+        n = normalize(cross(dFdx(eyeCoords), dFdy(eyeCoords)));
+    
     vec4 material = baseColor;
     
     vec4 textureColor = texture2D(texture, gl_TexCoord[0].st);
@@ -0,0 +1,357 @@
+//
+//  ColladaDocumentTest.mm
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import "ColladaDocument.h"
+#import <limits.h>
+#import <locale.h>
+
+@interface ColladaDocumentTest : SenTestCase
+{
+}
+
+@end
+
+@implementation ColladaDocumentTest
+
+// Two nodes share the square, one uses the triangle, one refers to
+// a geometry which does not exist and one is a light without geometry.
+static const char *documentText =
+    "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n"
+    "<COLLADA xmlns=\"http://www.collada.org/2005/11/COLLADASchema\" version=\"1.4.1\">\n"
+    "<library_geometries>\n"
+    "<geometry id=\"Geometry-Square\">\n"
+    "<mesh>\n"
+    "<source id=\"Geometry-Square-positions\">\n"
+    "<float_array id=\"Geometry-Square-positions-array\" count=\"12\">0 0 0 1 0 0 1 1 0 0 1 0</float_array>\n"
+    "<technique_common><accessor source=\"#Geometry-Square-positions-array\" count=\"4\" stride=\"3\" /></technique_common>\n"
+    "</source>\n"
+    "<source id=\"Geometry-Square-texcoords\">\n"
+    "<float_array id=\"Geometry-Square-texcoords-array\" count=\"8\">0 0 1 0 1 1 0 1</float_array>\n"
+    "<technique_common><accessor source=\"#Geometry-Square-texcoords-array\" count=\"4\" stride=\"2\" /></technique_common>\n"
+    "</source>\n"
+    "<vertices id=\"Geometry-Square-vertices\"><input semantic=\"POSITION\" source=\"#Geometry-Square-positions\" /></vertices>\n"
+    "<triangles count=\"2\">\n"
+    "<input semantic=\"VERTEX\" source=\"#Geometry-Square-vertices\" offset=\"0\" />\n"
+    "<input semantic=\"TEXCOORD\" source=\"#Geometry-Square-texcoords\" offset=\"1\" />\n"
+    "<p>0 0 1 1 2 2 0 0 2 2 3 3</p>\n"
+    "</triangles>\n"
+    "</mesh>\n"
+    "</geometry>\n"
+    "<geometry id=\"Geometry-Triangle\">\n"
+    "<mesh>\n"
+    "<source id=\"Geometry-Triangle-positions\">\n"
+    "<float_array id=\"Geometry-Triangle-positions-array\" count=\"9\">0 0 0 1 0 0 0 1 0</float_array>\n"
+    "</source>\n"
+    "<vertices id=\"Geometry-Triangle-vertices\"><input semantic=\"POSITION\" source=\"#Geometry-Triangle-positions\" /></vertices>\n"
+    "<triangles count=\"1\">\n"
+    "<input semantic=\"VERTEX\" source=\"#Geometry-Triangle-vertices\" offset=\"0\" />\n"
+    "<p>0 1 2</p>\n"
+    "</triangles>\n"
+    "</mesh>\n"
+    "</geometry>\n"
+    "</library_geometries>\n"
+    "<library_visual_scenes>\n"
+    "<visual_scene id=\"DefaultScene\">\n"
+    "<node id=\"Square\" name=\"Square\">\n"
+    "<translate sid=\"Position\">1 2 3</translate>\n"
+    "<instance_geometry url=\"#Geometry-Square\" />\n"
+    "</node>\n"
+    "<node id=\"Light\" name=\"Light\">\n"
+    "<translate sid=\"Position\">9 9 9</translate>\n"
+    "<instance_light url=\"#Light-Render\" />\n"
+    "</node>\n"
+    "<node id=\"Triangle\" name=\"Triangle\">\n"
+    "<translate sid=\"Position\">-1 0 0.5</translate>\n"
+    "<instance_geometry url=\"#Geometry-Triangle\" />\n"
+    "</node>\n"
+    "<node id=\"Square_2_\" name=\"Square_2_\">\n"
+    "<translate sid=\"Position\">0 0 -5</translate>\n"
+    "<instance_geometry url=\"#Geometry-Square\" />\n"
+    "</node>\n"
+    "<node id=\"Missing\" name=\"Missing\">\n"
+    "<translate sid=\"Position\">4 4 4</translate>\n"
+    "<instance_geometry url=\"#Geometry-Missing\" />\n"
+    "</node>\n"
+    "</visual_scene>\n"
+    "</library_visual_scenes>\n"
+    "</COLLADA>\n";
+
+// read changes the text, tests read their own copy
+static bool readDocument(ColladaDocument &document, const string &text)
+{
+    vector<char> copy(text.begin(), text.end());
+    copy.push_back('\0');
+    return document.read(&copy[0]);
+}
+
+static string replaced(const string &text, const string &oldValue, const string &newValue)
+{
+    string result = text;
+    result.replace(result.find(oldValue), oldValue.size(), newValue);
+    return result;
+}
+
+// Cube of quads, sphere of quads and triangles and a duplicate of the cube
+// sharing its mesh, all of them moved, rotated or scaled.
+static ItemCollection *makeTestItems()
+{
+    ItemCollection *items = new ItemCollection();
+    
+    Item *cube = new Item(new Mesh2());
+    cube->mesh->make(MeshType::Cube, 0);
+    cube->position = Vector3D(1.5f, -2.25f, 3.0f);
+    cube->rotation.FromEulerAngles(Vector3D(0.3f, 0.7f, -0.2f));
+    items->addItem(cube);
+    
+    Item *sphere = new Item(new Mesh2());
+    sphere->mesh->make(MeshType::Sphere, 7);
+    sphere->position = Vector3D(-4.0f, 0.1f, 0.0f);
+    sphere->scale = Vector3D(0.5f, 2.0f, 1.0f / 3.0f);
+    items->addItem(sphere);
+    
+    Item *duplicate = cube->duplicate();
+    duplicate->position = Vector3D(0.0f, 10.0f, -0.001f);
+    items->addItem(duplicate);
+    
+    return items;
+}
+
+// Written geometry must read back as the transformed index representation
+// of the item with quads split into triangles.
+static bool geometryMatchesItem(const ColladaGeometry &geometry, Item *item)
+{
+    vector<Vector3D> vertices, texCoords;
+    vector<TriQuad> triangles;
+    item->mesh->toIndexRepresentation(vertices, texCoords, triangles);
+    item->transform().TransformPositions(&vertices[0], vertices.size());
+    
+    if (geometry.vertices != vertices || geometry.texCoords.size() != texCoords.size())
+        return false;
+    
+    for (uint i = 0; i < texCoords.size(); i++)
+    {
+        if (geometry.texCoords[i].x != texCoords[i].x || geometry.texCoords[i].y != texCoords[i].y)
+            return false;
+    }
+    
+    uint triangleIndex = 0;
+    
+    for (uint i = 0; i < triangles.size(); i++)
+    {
+        const TriQuad &triQuad = triangles[i];
+        
+        for (uint j = 0; j < (triQuad.isQuad ? 6U : 3U); j += 3)
+        {
+            if (triangleIndex >= geometry.triangles.size())
+                return false;
+            
+            const TriQuad &triangle = geometry.triangles[triangleIndex++];
+            
+            for (uint k = 0; k < 3; k++)
+            {
+                uint corner = Triangle2::twoTriIndices[j + k];
+                if (triangle.isQuad ||
+                    triangle.vertexIndices[k] != triQuad.vertexIndices[corner] ||
+                    triangle.texCoordIndices[k] != triQuad.texCoordIndices[corner])
+                    return false;
+            }
+        }
+    }
+    
+    return triangleIndex == geometry.triangles.size();
+}
+
+- (void)testReadInstances
+{
+    ColladaDocument document;
+    
+    STAssertTrue(readDocument(document, documentText), @"document must be read");
+    
+    STAssertEquals((uint)document.geometries.size(), 2U, @"geometry count must be 2");
+    STAssertEquals((uint)document.instances.size(), 4U, @"nodes without instance_geometry must be skipped");
+    STAssertEquals(document.instances[0].geometryIndex, 0U, @"first node must be the square");
+    STAssertEquals(document.instances[1].geometryIndex, 1U, @"second node must be the triangle");
+    STAssertEquals(document.instances[2].geometryIndex, 0U, @"third node must be the square");
+    STAssertEquals(document.instances[3].geometryIndex, (uint)UINT_MAX, @"unknown url must have no geometry");
+    
+    const ColladaGeometry &square = document.geometries[0];
+    STAssertEquals((uint)square.vertices.size(), 4U, @"square must have 4 vertices");
+    STAssertEquals((uint)square.texCoords.size(), 4U, @"square must have 4 texCoords");
+    STAssertEquals((uint)square.triangles.size(), 2U, @"square must have 2 triangles");
+    
+    // without TEXCOORD all corners use one (0, 0)
+    const ColladaGeometry &triangle = document.geometries[1];
+    STAssertEquals((uint)triangle.vertices.size(), 3U, @"triangle must have 3 vertices");
+    STAssertEquals((uint)triangle.texCoords.size(), 1U, @"triangle must have 1 texCoord");
+    STAssertEquals((uint)triangle.triangles.size(), 1U, @"triangle must have 1 triangle");
+}
+
+- (void)testMakeItems
+{
+    ColladaDocument document;
+    
+    STAssertTrue(readDocument(document, documentText), @"document must be read");
+    
+    ItemCollection *items = document.makeItems();
+    
+    STAssertEquals(items->count(), 4U, @"every instance must be one item");
+    
+    Item *square = items->itemAtIndex(0U);
+    Item *triangle = items->itemAtIndex(1U);
+    Item *squareInstance = items->itemAtIndex(2U);
+    Item *missing = items->itemAtIndex(3U);
+    
+    STAssertTrue(square->mesh == squareInstance->mesh, @"instances of one geometry must share the mesh");
+    STAssertTrue(square->mesh != triangle->mesh, @"different geometries must have different meshes");
+    
+    STAssertEquals(square->mesh->vertexCount(), 4U, @"square must have 4 vertices");
+    STAssertEquals(square->mesh->triangleCount(), 2U, @"square must have 2 triangles");
+    STAssertEquals(triangle->mesh->vertexCount(), 3U, @"triangle must have 3 vertices");
+    STAssertEquals(triangle->mesh->triangleCount(), 1U, @"triangle must have 1 triangle");
+    STAssertEquals(missing->mesh->vertexCount(), 0U, @"unknown url must give an empty mesh");
+    STAssertEquals(missing->mesh->triangleCount(), 0U, @"unknown url must give an empty mesh");
+    
+    STAssertEquals(square->position, Vector3D(1, 2, 3), @"square position must be (1, 2, 3)");
+    STAssertEquals(triangle->position, Vector3D(-1, 0, 0.5f), @"triangle position must be (-1, 0, 0.5)");
+    STAssertEquals(squareInstance->position, Vector3D(0, 0, -5), @"square instance position must be (0, 0, -5)");
+    STAssertEquals(missing->position, Vector3D(4, 4, 4), @"missing position must be (4, 4, 4)");
+    
+    delete items;
+}
+
+- (void)testReadErrors
+{
+    string text(documentText);
+    ColladaDocument document;
+    
+    STAssertFalse(readDocument(document, text.substr(0, text.size() / 2)), @"truncated XML must fail");
+    STAssertFalse(readDocument(document, "<library_geometries />"), @"document without COLLADA must fail");
+    
+    STAssertFalse(readDocument(document, replaced(text, "<p>0 1 2</p>", "<p>0 1 3</p>")), @"vertex index out of range must fail");
+    STAssertFalse(readDocument(document, replaced(text, "3 3</p>", "3 4</p>")), @"texCoord index out of range must fail");
+    STAssertFalse(readDocument(document, replaced(text, "source=\"#Geometry-Triangle-positions\"", "source=\"#Geometry-Triangle-normals\"")), @"unknown source must fail");
+    STAssertFalse(readDocument(document, replaced(text, "1 1 0 0 1 0</float_array>", "1 1 0 0 1 x</float_array>")), @"malformed number must fail");
+}
+
+// Many instanced triangles, geometries are read on several worker threads
+// at once. Only the one at invalidIndex has a vertex index out of range.
+static string manyGeometriesText(uint count, uint invalidIndex)
+{
+    string text = "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n<COLLADA version=\"1.4.1\">\n<library_geometries>\n";
+    char line[512];
+    
+    for (uint i = 0; i < count; i++)
+    {
+        snprintf(line, sizeof(line),
+                 "<geometry id=\"Geometry-%u\"><mesh>\n"
+                 "<source id=\"Geometry-%u-positions\"><float_array count=\"9\">0 0 0 1 0 0 0 1 %u</float_array></source>\n"
+                 "<vertices id=\"Geometry-%u-vertices\"><input semantic=\"POSITION\" source=\"#Geometry-%u-positions\" /></vertices>\n"
+                 "<triangles count=\"1\"><input semantic=\"VERTEX\" source=\"#Geometry-%u-vertices\" offset=\"0\" /><p>0 1 %u</p></triangles>\n"
+                 "</mesh></geometry>\n",
+                 i, i, i, i, i, i, i == invalidIndex ? 3U : 2U);
+        text += line;
+    }
+    
+    text += "</library_geometries>\n<library_visual_scenes>\n<visual_scene id=\"DefaultScene\">\n";
+    
+    for (uint i = 0; i < count; i++)
+    {
+        snprintf(line, sizeof(line), "<node id=\"Node-%u\"><instance_geometry url=\"#Geometry-%u\" /></node>\n", i, i);
+        text += line;
+    }
+    
+    text += "</visual_scene>\n</library_visual_scenes>\n</COLLADA>\n";
+    return text;
+}
+
+- (void)testReadOneInvalidOfManyGeometries
+{
+    const uint count = 64;
+    ColladaDocument document;
+    
+    STAssertTrue(readDocument(document, manyGeometriesText(count, UINT_MAX)), @"valid geometries must be read");
+    STAssertEquals((uint)document.geometries.size(), count, @"geometry count must be %u", count);
+    
+    for (uint i = 0; i < count; i++)
+    {
+        STAssertTrue(document.geometries[i].valid, @"geometry %u must be valid", i);
+        STAssertEquals(document.geometries[i].vertices[2].z, (float)i, @"geometry %u must have its own vertices", i);
+    }
+    
+    // every neighbour of the invalid geometry is valid and read at the same time
+    for (uint invalidIndex = 0; invalidIndex < count; invalidIndex++)
+    {
+        STAssertFalse(readDocument(document, manyGeometriesText(count, invalidIndex)), @"geometry %u out of range must fail", invalidIndex);
+        
+        for (uint i = 0; i < count; i++)
+            STAssertEquals(document.geometries[i].valid, i != invalidIndex, @"only geometry %u must be invalid", invalidIndex);
+    }
+}
+
+- (void)testWriteReadRoundTrip
+{
+    ItemCollection *items = makeTestItems();
+    
+    string text;
+    ColladaDocument::write(*items, "Test", text);
+    
+    ColladaDocument document;
+    STAssertTrue(readDocument(document, text), @"written document must be read");
+    STAssertEquals((uint)document.instances.size(), items->count(), @"every item must be one instance");
+    
+    ItemCollection *readItems = document.makeItems();
+    STAssertEquals(readItems->count(), items->count(), @"every item must be read back");
+    
+    for (uint i = 0; i < items->count(); i++)
+    {
+        STAssertEquals(document.instances[i].geometryIndex, i, @"item %u must have its own geometry", i);
+        STAssertTrue(geometryMatchesItem(document.geometries[i], items->itemAtIndex(i)), @"geometry %u must match the item", i);
+        
+        Item *item = readItems->itemAtIndex(i);
+        STAssertEquals(item->position, Vector3D(), @"positions are in the vertices, item %u must stay at origin", i);
+        STAssertEquals(item->mesh->vertexCount(), items->itemAtIndex(i)->mesh->vertexCount(), @"item %u vertex count must match", i);
+    }
+    
+    delete readItems;
+    delete items;
+}
+
+- (void)testWriteIgnoresLocale
+{
+    ItemCollection *items = makeTestItems();
+    
+    string text;
+    ColladaDocument::write(*items, "Test", text);
+    
+    string oldLocale = setlocale(LC_NUMERIC, NULL);
+    const char *commaLocales[] = { "de_DE.UTF-8", "de_DE", "fr_FR.UTF-8", "cs_CZ.UTF-8" };
+    const char *commaLocale = NULL;
+    for (uint i = 0; i < sizeof(commaLocales) / sizeof(commaLocales[0]) && commaLocale == NULL; i++)
+        commaLocale = setlocale(LC_NUMERIC, commaLocales[i]);
+    
+    STAssertTrue(commaLocale != NULL, @"locale with decimal comma must exist");
+    STAssertEquals(localeconv()->decimal_point[0], ',', @"locale must use decimal comma");
+    
+    string localeText;
+    ColladaDocument::write(*items, "Test", localeText);
+    
+    ColladaDocument document;
+    bool read = readDocument(document, localeText);
+    
+    setlocale(LC_NUMERIC, oldLocale.c_str());
+    
+    STAssertTrue(localeText == text, @"text must not depend on locale");
+    STAssertTrue(text.find('.') != string::npos && text.find(',') == string::npos, @"numbers must use decimal point");
+    STAssertTrue(read, @"document must be read with decimal comma locale");
+    STAssertTrue(geometryMatchesItem(document.geometries[1], items->itemAtIndex(1)), @"numbers must be read without locale");
+    
+    delete items;
+}
+
+@end
@@ -0,0 +1,108 @@
+//
+//  Matrix4x4Test.mm
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import "MathDeclaration.h"
+#import <vector>
+
+using namespace std;
+
+@interface Matrix4x4Test : SenTestCase
+{
+}
+
+@end
+
+@implementation Matrix4x4Test
+
+// guard positions around the transformed range must stay as they are
+static const uint guardCount = 5;
+
+static void makePositions(vector<Vector3D> &positions, vector<float> &weights, uint count)
+{
+    positions.clear();
+    weights.clear();
+    
+    for (uint i = 0; i < count + 2 * guardCount; i++)
+    {
+        positions.push_back(Vector3D(sinf(i * 0.7f) * 3.0f, cosf(i * 1.3f) * 2.0f, sinf(i * 2.9f) - 0.5f));
+        // full, none and partial weights like soft selection
+        weights.push_back(i % 5 == 0 ? 1.0f : (i % 5 == 1 ? 0.0f : 0.5f + 0.5f * sinf(i * 0.37f)));
+    }
+}
+
+static bool nearlyEqual(const Vector3D &a, const Vector3D &b)
+{
+    for (uint i = 0; i < 3; i++)
+    {
+        if (fabsf(a[i] - b[i]) > 1.0e-5f * (1.0f + fabsf(b[i])))
+            return false;
+    }
+    return true;
+}
+
+static uint countTransformMismatches(const Matrix4x4 &matrix, uint count, bool weighted)
+{
+    uint mismatchCount = 0;
+    vector<Vector3D> positions;
+    vector<float> weights;
+    
+    // the range starts at every offset of a 16 byte block, so kernel loads are unaligned
+    for (uint offset = guardCount - 3; offset <= guardCount; offset++)
+    {
+        makePositions(positions, weights, count);
+        vector<Vector3D> expected(positions);
+        
+        for (uint i = offset; i < offset + count; i++)
+        {
+            if (weighted)
+                expected[i] = expected[i].Lerp(matrix.Transform(expected[i]), weights[i]);
+            else
+                expected[i] = matrix.Transform(expected[i]);
+        }
+        
+        if (weighted)
+            matrix.TransformPositions(&positions[offset], &weights[offset], count);
+        else
+            matrix.TransformPositions(&positions[offset], count);
+        
+        for (uint i = 0; i < positions.size(); i++)
+        {
+            if (!nearlyEqual(positions[i], expected[i]))
+                mismatchCount++;
+        }
+    }
+    return mismatchCount;
+}
+
+- (void)testTransformPositionsMatchesTransform
+{
+    Matrix4x4 matrix(Vector3D(0.5f, -1.5f, 2.0f), Quaternion(0.8f, Vector3D(1.0f, 2.0f, -0.5f)), Vector3D(1.5f, 0.75f, -2.0f));
+    
+    // counts around the four position blocks, tails of one to three included
+    uint counts[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 1001 };
+    
+    for (uint i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        STAssertEquals(countTransformMismatches(matrix, counts[i], false), 0U, @"%u positions must match Transform", counts[i]);
+    }
+}
+
+- (void)testWeightedTransformPositionsMatchesLerp
+{
+    Matrix4x4 matrix(Vector3D(-1.0f, 0.25f, 3.0f), Quaternion(-1.2f, Vector3D(0.3f, -1.0f, 0.7f)), Vector3D(0.5f, 2.5f, 1.25f));
+    
+    uint counts[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 1001 };
+    
+    for (uint i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        STAssertEquals(countTransformMismatches(matrix, counts[i], true), 0U, @"%u weighted positions must match Lerp", counts[i]);
+    }
+}
+
+@end
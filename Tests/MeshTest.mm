@@ -8,6 +8,10 @@
 
 #import <SenTestingKit/SenTestingKit.h>
 #import "Mesh2.h"
+#import "ItemCollection.h"
+#import "TextureCollection.h"
+#import <algorithm>
+#import <set>
 
 @interface MeshTest : SenTestCase 
 {
@@ -18,6 +22,432 @@
 
 @implementation MeshTest
 
+static TriangleNode *rayToUVBruteForce(Mesh2 *mesh, const Vector3D &origin, const Vector3D &direction, float &u, float &v)
+{
+    TriangleNode *nearest = NULL;
+    float lastSqDistance = 0.0f;
+    u = 0.0f;
+    v = 0.0f;
+    
+    for (TriangleNode *node = mesh->triangles().begin(), *end = mesh->triangles().end(); node != end; node = node->next())
+    {
+        float tempU = 0.0f;
+        float tempV = 0.0f;
+        Vector3D tempIntersect;
+        
+        if (node->data().rayIntersect(origin, direction, tempU, tempV, tempIntersect))
+        {
+            float tempSqDistance = tempIntersect.SqDistance(origin);
+            if (nearest == NULL || lastSqDistance > tempSqDistance)
+            {
+                lastSqDistance = tempSqDistance;
+                nearest = node;
+                u = tempU;
+                v = tempV;
+            }
+        }
+    }
+    
+    if (nearest)
+        nearest->data().convertBarycentricToUVs(u, v);
+    return nearest;
+}
+
+static uint countRayToUVMismatches(Mesh2 *mesh, uint rayCount, uint &hitCount)
+{
+    uint mismatchCount = 0;
+    hitCount = 0;
+    
+    for (uint i = 0; i < rayCount; i++)
+    {
+        // origins on a golden angle spiral around the mesh, aimed near its center
+        float z = 1.0f - 2.0f * (i + 0.5f) / rayCount;
+        float radius = sqrtf(1.0f - z * z);
+        float angle = 2.39996323f * i;
+        Vector3D origin(5.0f * radius * cosf(angle), 5.0f * radius * sinf(angle), 5.0f * z);
+        Vector3D target(0.6f * sinf(i * 1.7f), 0.6f * cosf(i * 2.3f), 0.6f * sinf(i * 3.1f));
+        Vector3D direction = target - origin;
+        
+        float u, v, bruteU, bruteV;
+        TriangleNode *node = mesh->rayToUV(origin, direction, u, v);
+        TriangleNode *bruteNode = rayToUVBruteForce(mesh, origin, direction, bruteU, bruteV);
+        
+        if (node)
+            hitCount++;
+        if (node != bruteNode || u != bruteU || v != bruteV)
+            mismatchCount++;
+    }
+    return mismatchCount;
+}
+
+static void findNearestBruteForce(Mesh2 *mesh, const Vector3D &position, uint count, const vector<VertexNode *> &skipVertices, vector<float> &distances)
+{
+    for (VertexNode *node = mesh->vertices().begin(), *end = mesh->vertices().end(); node != end; node = node->next())
+    {
+        if (find(skipVertices.begin(), skipVertices.end(), node) == skipVertices.end())
+            distances.push_back(node->data().position.SqDistance(position));
+    }
+    
+    sort(distances.begin(), distances.end());
+    if (distances.size() > count)
+        distances.resize(count);
+}
+
+static uint countNearestMismatches(Mesh2 *mesh, uint queryCount)
+{
+    uint mismatchCount = 0;
+    
+    set<VertexNode *> liveVertices;
+    for (VertexNode *node = mesh->vertices().begin(), *end = mesh->vertices().end(); node != end; node = node->next())
+        liveVertices.insert(node);
+    
+    for (uint i = 0; i < queryCount; i++)
+    {
+        // positions inside, near and far from the surface
+        float z = 1.0f - 2.0f * (i + 0.5f) / queryCount;
+        float radius = sqrtf(1.0f - z * z);
+        float angle = 2.39996323f * i;
+        float distance = 0.2f + 3.0f * (i % 7) / 6.0f;
+        Vector3D position(distance * radius * cosf(angle), distance * radius * sinf(angle), distance * z);
+        
+        // the nearest vertices are skipped, as the connect tools do with picked ones
+        vector<float> skipped;
+        vector<VertexNode *> skipVertices;
+        mesh->findNearestVertices(position, i % 4, skipVertices);
+        findNearestBruteForce(mesh, position, i % 4, vector<VertexNode *>(), skipped);
+        
+        vector<VertexNode *> nearest(skipVertices);
+        mesh->findNearestVertices(position, 4, nearest);
+        
+        vector<float> expected;
+        findNearestBruteForce(mesh, position, 4, skipVertices, expected);
+        
+        if (skipVertices.size() != skipped.size() || nearest.size() != skipVertices.size() + expected.size())
+        {
+            mismatchCount++;
+            continue;
+        }
+        
+        for (uint j = 0; j < nearest.size(); j++)
+        {
+            VertexNode *node = nearest[j];
+            float sqDistance = node->data().position.SqDistance(position);
+            bool isSkipped = j < skipVertices.size();
+            float expectedSqDistance = isSkipped ? skipped[j] : expected[j - skipVertices.size()];
+            
+            if (liveVertices.count(node) == 0 || sqDistance != expectedSqDistance ||
+                (!isSkipped && find(skipVertices.begin(), skipVertices.end(), node) != skipVertices.end()))
+                mismatchCount++;
+        }
+    }
+    return mismatchCount;
+}
+
+static NSData *encodeItems(ItemCollection &items, TextureCollection &textures, ModelVersion version)
+{
+    NSMutableData *data = [[NSMutableData alloc] init];
+    MemoryWriteStream *stream = new MemoryWriteStream(data);
+    stream->setVersion((uint)version);
+    items.encode(stream, textures);
+    delete stream;
+    return data;
+}
+
+// NULL when the stream failed or was not read to the end
+static ItemCollection *decodeItems(NSData *data, TextureCollection &textures, ModelVersion version)
+{
+    MemoryReadStream *stream = new MemoryReadStream(data);
+    stream->setVersion((uint)version);
+    ItemCollection *items = new ItemCollection(stream, textures);
+    
+    if (!stream->isValid() || stream->remainingLength() > 0)
+    {
+        delete items;
+        items = NULL;
+    }
+    
+    delete stream;
+    return items;
+}
+
+static bool meshesAreEqual(Mesh2 *a, Mesh2 *b)
+{
+    vector<Vector3D> vertices[2], texCoords[2];
+    vector<TriQuad> triangles[2];
+    a->toIndexRepresentation(vertices[0], texCoords[0], triangles[0]);
+    b->toIndexRepresentation(vertices[1], texCoords[1], triangles[1]);
+    
+    if (vertices[0] != vertices[1] || texCoords[0] != texCoords[1] || triangles[0].size() != triangles[1].size())
+        return false;
+    
+    for (uint i = 0; i < triangles[0].size(); i++)
+    {
+        const TriQuad &x = triangles[0][i];
+        const TriQuad &y = triangles[1][i];
+        if (x.isQuad != y.isQuad)
+            return false;
+        
+        for (uint j = 0; j < (x.isQuad ? 4U : 3U); j++)
+        {
+            if (x.vertexIndices[j] != y.vertexIndices[j] || x.texCoordIndices[j] != y.texCoordIndices[j])
+                return false;
+        }
+    }
+    return true;
+}
+
+// cube of quads, sphere of quads and triangles and a moved duplicate of the sphere
+static void makeEncodedItems(ItemCollection &items)
+{
+    Item *cube = new Item(new Mesh2());
+    cube->mesh->make(MeshType::Cube, 0);
+    cube->position = Vector3D(1, 2, 3);
+    items.addItem(cube);
+    
+    Item *sphere = new Item(new Mesh2());
+    sphere->mesh->make(MeshType::Sphere, 12);
+    sphere->scale = Vector3D(2, 1, 1);
+    items.addItem(sphere);
+    
+    Item *duplicate = sphere->duplicate();
+    duplicate->position = Vector3D(0, 5, 0);
+    items.addItem(duplicate);
+}
+
+typedef pair<const void *, const void *> NodePair;
+
+static NodePair orderedPair(const void *a, const void *b)
+{
+    return a < b ? NodePair(a, b) : NodePair(b, a);
+}
+
+// Edges, sharedEdge answers and selection of a mesh, either after an
+// incremental update or after makeEdges() and setSelectionMode().
+struct TopologySnapshot
+{
+    vector<pair<NodePair, NodePair> > edges; // vertices and triangles of each edge, sorted
+    vector<bool> edgeSelection; // in the order of edges
+    vector<NodePair> vertexQueries; // vertices of the found edge, NULL when none
+    vector<NodePair> texCoordQueries;
+    vector<bool> vertexSelection;
+    vector<bool> cachedSelection;
+};
+
+// Counts sharedEdge answers which do not match the triangle corners or are
+// not in the edge list, and selection cache entries which do not follow
+// the lists. Node pairs may point to released nodes, they are only compared.
+static uint takeTopologySnapshot(Mesh2 *mesh, const vector<NodePair> &vertexPairs, const vector<NodePair> &texCoordPairs,
+                                 TopologySnapshot &snapshot)
+{
+    uint mismatchCount = 0;
+    set<const VertexEdgeNode *> edgeNodes;
+    vector<pair<pair<NodePair, NodePair>, bool> > edges;
+    
+    for (VertexEdgeNode *node = mesh->vertexEdges().begin(), *end = mesh->vertexEdges().end(); node != end; node = node->next())
+    {
+        VertexEdge &edge = node->data();
+        edgeNodes.insert(node);
+        edges.push_back(make_pair(make_pair(orderedPair(edge.vertex(0), edge.vertex(1)),
+                                            orderedPair(edge.triangle(0), edge.triangle(1))), edge.selected));
+    }
+    
+    sort(edges.begin(), edges.end());
+    snapshot.edges.clear();
+    snapshot.edgeSelection.clear();
+    for (uint i = 0; i < edges.size(); i++)
+    {
+        snapshot.edges.push_back(edges[i].first);
+        snapshot.edgeSelection.push_back(edges[i].second);
+    }
+    
+    for (TriangleNode *node = mesh->triangles().begin(), *end = mesh->triangles().end(); node != end; node = node->next())
+    {
+        Triangle2 &triangle = node->data();
+        for (uint i = 0; i < triangle.count(); i++)
+        {
+            uint j = (i + 1) % triangle.count();
+            if (mesh->sharedEdge(triangle.vertex(i), triangle.vertex(j)) != triangle.vertexEdge(i))
+                mismatchCount++;
+            if (mesh->sharedEdge(triangle.texCoord(i), triangle.texCoord(j)) != triangle.texCoordEdge(i))
+                mismatchCount++;
+        }
+    }
+    
+    snapshot.vertexQueries.clear();
+    for (uint i = 0; i < vertexPairs.size(); i++)
+    {
+        VertexEdgeNode *node = mesh->sharedEdge((const VertexNode *)vertexPairs[i].first, (const VertexNode *)vertexPairs[i].second);
+        if (node && edgeNodes.count(node) == 0)
+            mismatchCount++;
+        snapshot.vertexQueries.push_back(node ? orderedPair(node->data().vertex(0), node->data().vertex(1)) : NodePair());
+    }
+    
+    snapshot.texCoordQueries.clear();
+    for (uint i = 0; i < texCoordPairs.size(); i++)
+    {
+        TexCoordEdgeNode *node = mesh->sharedEdge((const TexCoordNode *)texCoordPairs[i].first, (const TexCoordNode *)texCoordPairs[i].second);
+        snapshot.texCoordQueries.push_back(node ? orderedPair(node->data().vertex(0), node->data().vertex(1)) : NodePair());
+    }
+    
+    snapshot.vertexSelection.clear();
+    for (VertexNode *node = mesh->vertices().begin(), *end = mesh->vertices().end(); node != end; node = node->next())
+        snapshot.vertexSelection.push_back(node->data().selected);
+    
+    // cached selection must hold the nodes of the list in list order
+    vector<bool> listSelection;
+    switch (mesh->selectionMode())
+    {
+        case MeshSelectionMode::Vertices:
+            listSelection = snapshot.vertexSelection;
+            break;
+        case MeshSelectionMode::Triangles:
+            for (TriangleNode *node = mesh->triangles().begin(), *end = mesh->triangles().end(); node != end; node = node->next())
+                listSelection.push_back(node->data().selected);
+            break;
+        case MeshSelectionMode::Edges:
+            for (VertexEdgeNode *node = mesh->vertexEdges().begin(), *end = mesh->vertexEdges().end(); node != end; node = node->next())
+                listSelection.push_back(node->data().selected);
+            break;
+        default:
+            break;
+    }
+    
+    snapshot.cachedSelection.clear();
+    for (uint i = 0; i < mesh->selectedCount(); i++)
+        snapshot.cachedSelection.push_back(mesh->isSelectedAtIndex(i));
+    
+    if (snapshot.cachedSelection != listSelection)
+        mismatchCount++;
+    
+    return mismatchCount;
+}
+
+// in any selection mode, setSelectionMode() selects vertices of the triangles
+static void selectEveryTriangle(Mesh2 *mesh, uint step)
+{
+    uint index = 0;
+    for (TriangleNode *node = mesh->triangles().begin(), *end = mesh->triangles().end(); node != end; node = node->next(), index++)
+        node->data().selected = index % step == 0;
+    
+    mesh->setSelectionMode(mesh->selectionMode());
+}
+
+static void addTriangleCornerPairs(Mesh2 *mesh, vector<NodePair> &vertexPairs, vector<NodePair> &texCoordPairs)
+{
+    for (TriangleNode *node = mesh->triangles().begin(), *end = mesh->triangles().end(); node != end; node = node->next())
+    {
+        Triangle2 &triangle = node->data();
+        for (uint i = 0; i < triangle.count(); i++)
+        {
+            uint j = (i + 1) % triangle.count();
+            vertexPairs.push_back(NodePair(triangle.vertex(i), triangle.vertex(j)));
+            texCoordPairs.push_back(NodePair(triangle.texCoord(i), triangle.texCoord(j)));
+        }
+    }
+}
+
+// Compares the incremental update of an edit with makeEdges() and
+// setSelectionMode() run afterwards on the same mesh. Corners of triangles
+// before the edit are queried too, so removed edges must not be found.
+static uint countIncrementalTopologyMismatches(Mesh2 *mesh, const vector<NodePair> &vertexPairs, const vector<NodePair> &texCoordPairs)
+{
+    TopologySnapshot incremental, rebuilt;
+    uint mismatchCount = takeTopologySnapshot(mesh, vertexPairs, texCoordPairs, incremental);
+    
+    mesh->makeEdges();
+    mesh->setSelectionMode(mesh->selectionMode());
+    mismatchCount += takeTopologySnapshot(mesh, vertexPairs, texCoordPairs, rebuilt);
+    
+    // makeEdges() creates edges without selection
+    if (incremental.edges != rebuilt.edges ||
+        count(incremental.edgeSelection.begin(), incremental.edgeSelection.end(), true) > 0)
+        mismatchCount++;
+    
+    for (uint i = 0; i < vertexPairs.size(); i++)
+    {
+        if (incremental.vertexQueries[i] != rebuilt.vertexQueries[i])
+            mismatchCount++;
+    }
+    
+    for (uint i = 0; i < texCoordPairs.size(); i++)
+    {
+        if (incremental.texCoordQueries[i] != rebuilt.texCoordQueries[i])
+            mismatchCount++;
+    }
+    
+    if (incremental.vertexSelection != rebuilt.vertexSelection || incremental.cachedSelection != rebuilt.cachedSelection)
+        mismatchCount++;
+    
+    return mismatchCount;
+}
+
+// Triangle soup positions, every position is followed by copies moved just
+// inside and just outside the weld distance, some along cell diagonals.
+static void makeWeldSoup(vector<Vector3D> &positions, float squaredEpsilon, uint count)
+{
+    float distance = sqrtf(squaredEpsilon);
+    
+    for (uint i = 0; i < count; i++)
+    {
+        Vector3D position(sinf(i * 0.37f), cosf(i * 0.91f), sinf(i * 1.63f));
+        position *= 20.0f * distance;
+        positions.push_back(position);
+        
+        Vector3D direction(sinf(i * 2.11f), cosf(i * 1.27f), sinf(i * 0.53f) + 0.1f);
+        direction.Normalize();
+        
+        switch (i % 4)
+        {
+            case 0:
+                positions.push_back(position);
+                break;
+            case 1:
+                positions.push_back(position + direction * (distance * 0.99f));
+                break;
+            case 2:
+                positions.push_back(position + direction * (distance * 1.01f));
+                break;
+            default:
+                positions.push_back(position + Vector3D(1.0f, 1.0f, 1.0f) * (distance * 0.57f));
+                break;
+        }
+    }
+}
+
+static uint countWeldMismatches(const vector<Vector3D> &positions, float squaredEpsilon)
+{
+    uint mismatchCount = 0;
+    VertexWelder welder(squaredEpsilon);
+    vector<Vector3D> unique;
+    
+    for (uint i = 0; i < positions.size(); i++)
+    {
+        uint found = UINT_MAX;
+        for (uint j = 0; j < unique.size(); j++)
+        {
+            if (unique[j].SqDistance(positions[i]) < squaredEpsilon)
+            {
+                found = j;
+                break;
+            }
+        }
+        
+        if (found == UINT_MAX)
+        {
+            found = unique.size();
+            unique.push_back(positions[i]);
+        }
+        
+        if (welder.findOrAdd(positions[i]) != found)
+            mismatchCount++;
+    }
+    
+    if (welder.count() != unique.size())
+        mismatchCount++;
+    
+    return mismatchCount;
+}
+
 - (void)testSimpleList
 {
     SimpleList<int> *list = new SimpleList<int>();
@@ -54,4 +484,237 @@
 	STAssertEquals(mesh->vertexEdgeCount(), 18, @"edgeCount in cube must be equal to 18");
 }
 
+- (void)testRayToUVPerformance
+{
+    mesh = new Mesh2();
+    mesh->make(MeshType::Sphere, 300);
+    
+    const uint rayCount = 10000;
+    uint hitCount = 0;
+    
+    NSDate *start = [NSDate date];
+    
+    for (uint i = 0; i < rayCount; i++)
+    {
+        float x = (float)(i % 100) / 50.0f - 1.0f;
+        float y = (float)(i / 100) / 50.0f - 1.0f;
+        float u, v;
+        
+        if (mesh->rayToUV(Vector3D(x, y, 5.0f), Vector3D(0.0f, 0.0f, -1.0f), u, v))
+            hitCount++;
+    }
+    
+    NSTimeInterval seconds = -[start timeIntervalSinceNow];
+    printf("rayToUV: %u triangles, %.0f rays/s\n", mesh->triangleCount(), rayCount / seconds);
+    
+    STAssertTrue(hitCount > rayCount / 2, @"most rays must hit the sphere");
+    delete mesh;
+}
+
+- (void)testRayToUVMatchesBruteForce
+{
+    mesh = new Mesh2();
+    mesh->make(MeshType::Sphere, 20);
+    
+    const uint rayCount = 2000;
+    uint hitCount = 0;
+    
+    // hidden triangles stay pickable
+    mesh->setSelectionMode(MeshSelectionMode::Triangles);
+    for (uint i = 0; i < mesh->selectedCount(); i += 5)
+        mesh->setSelectedAtIndex(true, i);
+    mesh->hideSelected();
+    
+    STAssertEquals(countRayToUVMismatches(mesh, rayCount, hitCount), 0U, @"build must match brute force");
+    STAssertTrue(hitCount > 0, @"rays must hit the mesh");
+    
+    // moving vertices refits the hierarchy
+    mesh->setSelectionMode(MeshSelectionMode::Vertices);
+    for (uint i = 0; i < mesh->selectedCount(); i += 3)
+        mesh->setSelectedAtIndex(true, i);
+    mesh->transformSelected(Matrix4x4(Vector3D(0.2f, -0.1f, 0.3f), Quaternion(), Vector3D(1.4f, 0.7f, 1.1f)));
+    
+    STAssertEquals(countRayToUVMismatches(mesh, rayCount, hitCount), 0U, @"refit must match brute force");
+    STAssertTrue(hitCount > 0, @"rays must hit the mesh");
+    
+    // adding and removing faces rebuilds it
+    mesh->setSelectionMode(MeshSelectionMode::Triangles);
+    for (uint i = 0; i < mesh->selectedCount(); i += 7)
+        mesh->setSelectedAtIndex(true, i);
+    mesh->removeSelected();
+    
+    VertexNode *v0 = mesh->vertices().begin();
+    VertexNode *v1 = v0->next()->next()->next();
+    VertexNode *v2 = v1->next()->next()->next();
+    VertexNode *v3 = v2->next()->next()->next();
+    TriangleNode *quad = mesh->addQuad(v0, v1, v2, v3);
+    mesh->addTriangle(v3, v2, v0);
+    
+    STAssertEquals(countRayToUVMismatches(mesh, rayCount, hitCount), 0U, @"rebuild must match brute force");
+    STAssertTrue(hitCount > 0, @"rays must hit the mesh");
+    
+    mesh->removeTriQuad(quad);
+    
+    STAssertEquals(countRayToUVMismatches(mesh, rayCount, hitCount), 0U, @"rebuild must match brute force");
+    STAssertTrue(hitCount > 0, @"rays must hit the mesh");
+    
+    delete mesh;
+}
+
+- (void)testVertexWelderMatchesBruteForce
+{
+    float epsilons[] = { FLOAT_EPS, 0.01f, 4.0f };
+    
+    for (uint i = 0; i < sizeof(epsilons) / sizeof(epsilons[0]); i++)
+    {
+        vector<Vector3D> positions;
+        makeWeldSoup(positions, epsilons[i], 3000);
+        
+        STAssertEquals(countWeldMismatches(positions, epsilons[i]), 0U, @"welder must match brute force with epsilon %f", epsilons[i]);
+    }
+}
+
+- (void)testVertexGridMatchesBruteForce
+{
+    mesh = new Mesh2();
+    mesh->make(MeshType::Sphere, 12);
+    
+    const uint queryCount = 500;
+    
+    mesh->setSelectionMode(MeshSelectionMode::Vertices);
+    for (uint i = 0; i < mesh->selectedCount(); i += 3)
+        mesh->setSelectedAtIndex(true, i);
+    
+    // the first query builds the grid, the edits below keep it current
+    STAssertEquals(countNearestMismatches(mesh, queryCount), 0U, @"build must match brute force");
+    
+    for (uint i = 0; i < 20; i++)
+        mesh->addVertex(Vector3D(sinf(i * 0.7f), cosf(i * 1.3f), sinf(i * 2.9f)) * (0.5f + 0.1f * i));
+    
+    STAssertEquals(countNearestMismatches(mesh, queryCount), 0U, @"addVertex must match brute force");
+    
+    mesh->transformSelected(Matrix4x4(Vector3D(0.3f, -0.2f, 0.1f), Quaternion(), Vector3D(1.3f, 0.8f, 1.1f)));
+    
+    STAssertEquals(countNearestMismatches(mesh, queryCount), 0U, @"transformSelected must match brute force");
+    
+    mesh->setSelectionMode(MeshSelectionMode::Triangles);
+    selectEveryTriangle(mesh, 2);
+    countNearestMismatches(mesh, 1);
+    mesh->removeSelectedTriangles();
+    
+    STAssertEquals(countNearestMismatches(mesh, queryCount), 0U, @"removal must match brute force");
+    
+    delete mesh;
+}
+
+- (void)testIncrementalTopologyMatchesRebuild
+{
+    MeshSelectionMode modes[] = { MeshSelectionMode::Vertices, MeshSelectionMode::Triangles, MeshSelectionMode::Edges };
+    
+    for (uint m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        mesh = new Mesh2();
+        mesh->make(MeshType::Sphere, 12);
+        
+        vector<NodePair> vertexPairs, texCoordPairs;
+        addTriangleCornerPairs(mesh, vertexPairs, texCoordPairs);
+        mesh->setSelectionMode(modes[m]);
+        
+        // every check leaves valid edge tables behind, the next edit updates them
+        STAssertEquals(countIncrementalTopologyMismatches(mesh, vertexPairs, texCoordPairs), 0U, @"make must match rebuild in mode %u", m);
+        
+        // removals alone create no edges
+        selectEveryTriangle(mesh, 4);
+        mesh->removeSelectedTriangles();
+        STAssertEquals(countIncrementalTopologyMismatches(mesh, vertexPairs, texCoordPairs), 0U, @"removal must match rebuild in mode %u", m);
+        
+        addTriangleCornerPairs(mesh, vertexPairs, texCoordPairs);
+        selectEveryTriangle(mesh, 3);
+        mesh->triangulateSelectedQuads();
+        STAssertEquals(countIncrementalTopologyMismatches(mesh, vertexPairs, texCoordPairs), 0U, @"triangulation must match rebuild in mode %u", m);
+        
+        addTriangleCornerPairs(mesh, vertexPairs, texCoordPairs);
+        mesh->duplicateSelectedTriangles();
+        STAssertEquals(countIncrementalTopologyMismatches(mesh, vertexPairs, texCoordPairs), 0U, @"duplication must match rebuild in mode %u", m);
+        
+        addTriangleCornerPairs(mesh, vertexPairs, texCoordPairs);
+        mesh->extrudeSelectedTriangles();
+        STAssertEquals(countIncrementalTopologyMismatches(mesh, vertexPairs, texCoordPairs), 0U, @"extrusion must match rebuild in mode %u", m);
+        
+        addTriangleCornerPairs(mesh, vertexPairs, texCoordPairs);
+        mesh->removeSelectedTriangles();
+        STAssertEquals(countIncrementalTopologyMismatches(mesh, vertexPairs, texCoordPairs), 0U, @"removal after extrusion must match rebuild in mode %u", m);
+        
+        delete mesh;
+    }
+}
+
+- (void)testEncodeDecodeVersions
+{
+    TextureCollection textures;
+    ItemCollection items;
+    makeEncodedItems(items);
+    
+    // per element triangles, first shared meshes, bulk arrays
+    ModelVersion versions[] = { ModelVersion::CrossPlatform, ModelVersion::SharedMeshes, ModelVersion::BulkArrays };
+    
+    for (uint i = 0; i < sizeof(versions) / sizeof(versions[0]); i++)
+    {
+        NSData *data = encodeItems(items, textures, versions[i]);
+        ItemCollection *decoded = decodeItems(data, textures, versions[i]);
+        
+        STAssertTrue(decoded != NULL, @"version %u must be read to the end", (uint)versions[i]);
+        if (decoded == NULL)
+            continue;
+        
+        STAssertEquals(decoded->count(), items.count(), @"version %u item count must match", (uint)versions[i]);
+        
+        for (uint j = 0; j < items.count(); j++)
+        {
+            STAssertEquals(decoded->itemAtIndex(j)->position, items.itemAtIndex(j)->position, @"version %u item %u position must match", (uint)versions[i], j);
+            STAssertEquals(decoded->itemAtIndex(j)->scale, items.itemAtIndex(j)->scale, @"version %u item %u scale must match", (uint)versions[i], j);
+            STAssertTrue(meshesAreEqual(decoded->itemAtIndex(j)->mesh, items.itemAtIndex(j)->mesh), @"version %u item %u mesh must match", (uint)versions[i], j);
+        }
+        
+        bool shared = decoded->itemAtIndex(1)->mesh == decoded->itemAtIndex(2)->mesh;
+        STAssertEquals(shared, versions[i] >= ModelVersion::SharedMeshes, @"version %u must share meshes since SharedMeshes", (uint)versions[i]);
+        
+        delete decoded;
+    }
+}
+
+- (void)testDecodeTruncated
+{
+    TextureCollection textures;
+    ItemCollection items;
+    makeEncodedItems(items);
+    
+    ModelVersion versions[] = { ModelVersion::CrossPlatform, ModelVersion::SharedMeshes, ModelVersion::BulkArrays };
+    
+    for (uint i = 0; i < sizeof(versions) / sizeof(versions[0]); i++)
+    {
+        NSData *data = encodeItems(items, textures, versions[i]);
+        NSUInteger step = [data length] / 97 + 1;
+        
+        for (NSUInteger length = 0; length < [data length]; length += step)
+        {
+            NSData *truncated = [data subdataWithRange:NSMakeRange(0, length)];
+            STAssertTrue(decodeItems(truncated, textures, versions[i]) == NULL, @"version %u truncated to %u bytes must fail", (uint)versions[i], (uint)length);
+        }
+    }
+    
+    // vertex, texCoord and triangle counts of the cube set to UINT_MAX, after
+    // item count, shared index, item transform, texture index and color
+    NSData *data = encodeItems(items, textures, ModelVersion::Latest);
+    const NSUInteger countsOffset = 4 + 4 + 10 * 4 + 1 + 4 + 4 * 4;
+    
+    for (uint i = 0; i < 3; i++)
+    {
+        NSMutableData *damaged = [data mutableCopy];
+        uint count = UINT_MAX;
+        [damaged replaceBytesInRange:NSMakeRange(countsOffset + i * 4, 4) withBytes:&count];
+        STAssertTrue(decodeItems(damaged, textures, ModelVersion::Latest) == NULL, @"count %u out of range must fail", i);
+    }
+}
+
 @end
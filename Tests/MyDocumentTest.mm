@@ -195,4 +195,48 @@
 	STAssertEquals([[document->items itemAtIndex:1U] position], Vector3D(5, 5, 0), @"second item (5, 5, 0)");
 }
 
+- (void)testDuplicateSharesMeshUntilEdit
+{
+	[self prepareDocument];
+	
+	[self groupAction:^ { [document addCube:self]; }];
+	[self groupAction:^ { [document duplicateSelected:self]; }];
+	
+	STAssertEquals(document->items->count(), 2U, @"items count must be two");
+	
+	Item *original = document->items->itemAtIndex(0U);
+	Item *duplicate = document->items->itemAtIndex(1U);
+	Vector3D originalPosition = original->mesh->vertices().begin()->data().position;
+	
+	STAssertTrue(original->mesh == duplicate->mesh, @"duplicate must share the mesh");
+	
+	// model3D writes the shared mesh once, both items read it back
+	MyDocument *loaded = [[MyDocument alloc] init];
+	STAssertTrue([loaded readFromModel3D:[document dataOfModel3D]], @"model3D must load");
+	STAssertEquals(loaded->items->count(), 2U, @"loaded items count must be two");
+	STAssertTrue(loaded->items->itemAtIndex(0U)->mesh == loaded->items->itemAtIndex(1U)->mesh, @"loaded items must share the mesh");
+	STAssertEquals(loaded->items->itemAtIndex(0U)->mesh->vertexCount(), 8U, @"shared mesh must be a cube");
+	
+	// editing the duplicate gives it its own mesh
+	[document editMeshWithMode:MeshSelectionMode::Vertices];
+	[document selectAll:self];
+	
+	STAssertTrue(original->mesh != duplicate->mesh, @"edited item must have its own mesh");
+	
+	[self groupAction:^ 
+	{ 
+		[document manipulationStartedInView:nil];
+		document->meshController->moveSelectedByOffset(Vector3D(0, 5, 0));
+		[document manipulationEndedInView:nil]; 
+	}];
+	
+	STAssertEquals(original->mesh->vertices().begin()->data().position, originalPosition, @"original mesh must not change");
+	STAssertEquals(duplicate->mesh->vertices().begin()->data().position, originalPosition + Vector3D(0, 5, 0), @"edited mesh must move by (0, 5, 0)");
+	
+	[[document undoManager] undo];
+	
+	STAssertEquals(original->mesh->vertices().begin()->data().position, originalPosition, @"original mesh must not change");
+	STAssertEquals(duplicate->mesh->vertices().begin()->data().position, originalPosition, @"undo must restore the edited mesh");
+}
+
 @end
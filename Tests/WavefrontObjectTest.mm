@@ -0,0 +1,298 @@
+//
+//  WavefrontObjectTest.mm
+//  MeshMaker
+//
+//  Created by Filip Kunc on 10/18/26.
+//  For license see LICENSE.TXT
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+#import "WavefrontObject.h"
+
+@interface WavefrontObjectTest : SenTestCase
+{
+}
+
+@end
+
+@implementation WavefrontObjectTest
+
+// Groups, an n-gon and negative indices pointing back over several lines,
+// so that they cross chunk boundaries when the text is split. Malformed
+// lines are skipped and the last line does not end with a newline.
+static const char *objectText =
+    "# MeshMaker test object\n"
+    "v 0 0 0\n"
+    "v 1 0 0\n"
+    "v 1 1 0\n"
+    "v 0 1 0\n"
+    "v 2 0 0\n"
+    "v 2 1 0\n"
+    "vt 0 0\n"
+    "vt 1 0\n"
+    "vt 1 1\n"
+    "vt 0 1\n"
+    "g quads\n"
+    "f 1/1 2/2 3/3 4/4\n"
+    "f 2/1/1 5/2/1 6/3/1 3/4/1\n"
+    "\n"
+    "g ngon\n"
+    "v 3 0.5 0\n"
+    "f 1/1 2/2 5/3 7/4 6/1 3/2\n"
+    "f 4//1 3//1 6//1 7//1 5//1\r\n"
+    "f 1/1 2/2\n"
+    "f x y z\n"
+    "vn 0 0 1\n"
+    "usemtl unknown\n"
+    "   \t\n"
+    "g relative\n"
+    "v 0 2 0\n"
+    "v 1 2 0\n"
+    "f -6/-4 -7/-3 -2/-2 -1/-1\n"
+    "f\t-9/-4\t-8/-3\t-7/-2";
+
+static bool objectsAreEqual(const WavefrontObject &a, const WavefrontObject &b)
+{
+    if (a.vertices.size() != b.vertices.size() || a.texCoords.size() != b.texCoords.size() ||
+        a.triangles.size() != b.triangles.size() || a.groups != b.groups)
+        return false;
+    
+    for (uint i = 0; i < a.vertices.size(); i++)
+    {
+        if (a.vertices[i] != b.vertices[i])
+            return false;
+    }
+    
+    for (uint i = 0; i < a.texCoords.size(); i++)
+    {
+        if (a.texCoords[i] != b.texCoords[i])
+            return false;
+    }
+    
+    for (uint i = 0; i < a.triangles.size(); i++)
+    {
+        const TriQuad &x = a.triangles[i];
+        const TriQuad &y = b.triangles[i];
+        if (x.isQuad != y.isQuad)
+            return false;
+        
+        for (uint j = 0; j < (x.isQuad ? 4U : 3U); j++)
+        {
+            if (x.vertexIndices[j] != y.vertexIndices[j] || x.texCoordIndices[j] != y.texCoordIndices[j])
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool itemsAreEqual(ItemCollection *a, ItemCollection *b)
+{
+    if (a->count() != b->count())
+        return false;
+    
+    for (uint i = 0; i < a->count(); i++)
+    {
+        vector<Vector3D> vertices[2], texCoords[2];
+        vector<TriQuad> triangles[2];
+        a->itemAtIndex(i)->mesh->toIndexRepresentation(vertices[0], texCoords[0], triangles[0]);
+        b->itemAtIndex(i)->mesh->toIndexRepresentation(vertices[1], texCoords[1], triangles[1]);
+        
+        if (vertices[0] != vertices[1] || texCoords[0] != texCoords[1] || triangles[0].size() != triangles[1].size())
+            return false;
+        
+        for (uint j = 0; j < triangles[0].size(); j++)
+        {
+            if (triangles[0][j].isQuad != triangles[1][j].isQuad ||
+                memcmp(triangles[0][j].vertexIndices, triangles[1][j].vertexIndices, sizeof(triangles[0][j].vertexIndices)) != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+// Moved, rotated and scaled items, two of them share a mesh and one is
+// shown in the unwrap view, which must not change what is written.
+static void makeWrittenItems(ItemCollection &items)
+{
+    Item *cube = new Item(new Mesh2());
+    cube->mesh->make(MeshType::Cube, 0);
+    cube->position = Vector3D(1, 2, 3);
+    cube->rotation = Quaternion(0.7f, Vector3D(1, 1, 0));
+    items.addItem(cube);
+    
+    Item *sphere = new Item(new Mesh2());
+    sphere->mesh->make(MeshType::Sphere, 12);
+    sphere->scale = Vector3D(2, 0.5f, 1);
+    items.addItem(sphere);
+    
+    Item *duplicate = sphere->duplicate();
+    duplicate->position = Vector3D(0, 5, 0);
+    duplicate->scale = Vector3D(0.25f, 3, 1.5f);
+    items.addItem(duplicate);
+    
+    Item *cylinder = new Item(new Mesh2());
+    cylinder->mesh->make(MeshType::Cylinder, 9);
+    cylinder->mesh->setUnwrapped(true);
+    cylinder->position = Vector3D(-4, 0, 1);
+    items.addItem(cylinder);
+}
+
+// items in one object with transformed positions, every item in its own group
+static void makeWrittenObject(ItemCollection &items, WavefrontObject &object)
+{
+    for (uint i = 0; i < items.count(); i++)
+    {
+        Item *item = items.itemAtIndex(i);
+        vector<Vector3D> vertices, texCoords;
+        vector<TriQuad> triangles;
+        item->mesh->toIndexRepresentation(vertices, texCoords, triangles);
+        item->transform().TransformPositions(&vertices[0], vertices.size());
+        
+        uint vertexOffset = object.vertices.size();
+        uint texCoordOffset = object.texCoords.size();
+        object.groups.push_back(object.triangles.size());
+        object.vertices.insert(object.vertices.end(), vertices.begin(), vertices.end());
+        
+        // only u and v are written
+        for (uint j = 0; j < texCoords.size(); j++)
+            object.texCoords.push_back(Vector3D(texCoords[j].x, texCoords[j].y, 0.0f));
+        
+        for (uint j = 0; j < triangles.size(); j++)
+        {
+            TriQuad triQuad = triangles[j];
+            for (uint k = 0; k < 4; k++)
+            {
+                triQuad.vertexIndices[k] += vertexOffset;
+                triQuad.texCoordIndices[k] += texCoordOffset;
+            }
+            object.triangles.push_back(triQuad);
+        }
+    }
+}
+
+- (void)testReadOneChunk
+{
+    WavefrontObject object;
+    
+    STAssertTrue(object.read(objectText, strlen(objectText), 1), @"object must be read");
+    
+    STAssertEquals((uint)object.vertices.size(), 9U, @"vertex count must be 9");
+    STAssertEquals((uint)object.texCoords.size(), 4U, @"texCoord count must be 4");
+    // two quads, hexagon as two quads, pentagon as quad and triangle, quad and triangle
+    STAssertEquals((uint)object.triangles.size(), 8U, @"triangle count must be 8");
+    STAssertEquals((uint)object.groups.size(), 3U, @"group count must be 3");
+    STAssertEquals(object.groups[1], 2U, @"second group starts with third triangle");
+    STAssertEquals(object.groups[2], 6U, @"third group starts with seventh triangle");
+    
+    STAssertTrue(object.triangles[2].isQuad && object.triangles[3].isQuad, @"hexagon must be two quads");
+    STAssertTrue(object.triangles[4].isQuad && !object.triangles[5].isQuad, @"pentagon must be quad and triangle");
+    
+    // f -6/-4 -7/-3 -2/-2 -1/-1 after nine vertices, in reversed order
+    const TriQuad &relative = object.triangles[6];
+    STAssertEquals(relative.vertexIndices[0], 7U, @"-2 must be the eighth vertex");
+    STAssertEquals(relative.vertexIndices[1], 2U, @"-7 must be the third vertex");
+    STAssertEquals(relative.vertexIndices[2], 3U, @"-6 must be the fourth vertex");
+    STAssertEquals(relative.vertexIndices[3], 8U, @"-1 must be the ninth vertex");
+    STAssertEquals(relative.texCoordIndices[3], 3U, @"-1 must be the fourth texCoord");
+    
+    // line without newline at the end
+    const TriQuad &last = object.triangles[7];
+    STAssertEquals(last.vertexIndices[0], 2U, @"-7 must be the third vertex");
+    STAssertEquals(last.vertexIndices[2], 0U, @"-9 must be the first vertex");
+    
+    ItemCollection *items = object.makeItems();
+    STAssertEquals(items->count(), 3U, @"every group must be one item");
+    delete items;
+}
+
+- (void)testReadChunksMatchOneChunk
+{
+    size_t length = strlen(objectText);
+    
+    WavefrontObject expected;
+    STAssertTrue(expected.read(objectText, length, 1), @"object must be read");
+    ItemCollection *expectedItems = expected.makeItems();
+    
+    // up to one chunk for every character, so every line is split from its
+    // neighbours somewhere, empty chunks included
+    for (uint chunkCount = 2; chunkCount <= length + 1; chunkCount++)
+    {
+        WavefrontObject object;
+        STAssertTrue(object.read(objectText, length, chunkCount), @"object must be read in %u chunks", chunkCount);
+        STAssertTrue(objectsAreEqual(expected, object), @"%u chunks must match one chunk", chunkCount);
+        
+        ItemCollection *items = object.makeItems();
+        STAssertTrue(itemsAreEqual(expectedItems, items), @"items from %u chunks must match one chunk", chunkCount);
+        delete items;
+    }
+    
+    delete expectedItems;
+}
+
+- (void)testReadIndicesOutOfRange
+{
+    const char *texts[] =
+    {
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 4\n",
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nf -4 -2 -1\n",
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nf 1/1 2/2 3/1\n",
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 3\nf -1 -2 -3\nv 0 1 0\nf -1 -2 -5",
+    };
+    
+    for (uint i = 0; i < sizeof(texts) / sizeof(texts[0]); i++)
+    {
+        for (uint chunkCount = 1; chunkCount <= 4; chunkCount++)
+        {
+            WavefrontObject object;
+            STAssertFalse(object.read(texts[i], strlen(texts[i]), chunkCount), @"text %u in %u chunks must fail", i, chunkCount);
+        }
+    }
+}
+
+- (void)testReadEmpty
+{
+    WavefrontObject object;
+    
+    STAssertTrue(object.read("", 0, 4), @"empty text must be read");
+    STAssertTrue(object.vertices.empty() && object.triangles.empty(), @"empty text must have no geometry");
+}
+
+- (void)testWriteReadRoundTrip
+{
+    ItemCollection items;
+    makeWrittenItems(items);
+    
+    WavefrontObject expected;
+    makeWrittenObject(items, expected);
+    
+    string text;
+    WavefrontObject::write(items, "test", text, 1);
+    
+    WavefrontObject object;
+    STAssertTrue(object.read(text.c_str(), text.length()), @"written text must be read");
+    STAssertTrue(objectsAreEqual(expected, object), @"read object must match the transformed items");
+    
+    // 0 picks the count, 64 leaves empty parts in every item
+    uint partCounts[] = { 0, 2, 3, 4, 7, 64 };
+    
+    for (uint i = 0; i < sizeof(partCounts) / sizeof(partCounts[0]); i++)
+    {
+        string partsText;
+        WavefrontObject::write(items, "test", partsText, partCounts[i]);
+        STAssertTrue(partsText == text, @"text in %u parts must match one part", partCounts[i]);
+    }
+    
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"WavefrontObjectTest.obj"];
+    STAssertTrue(WavefrontObject::writeFile(items, "test", [path fileSystemRepresentation]), @"file must be written");
+    
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    STAssertTrue(data.length == text.length() && memcmp(data.bytes, text.data(), text.length()) == 0, @"file must match the text");
+    
+    WavefrontObject fileObject;
+    STAssertTrue(fileObject.readFile([path fileSystemRepresentation]), @"written file must be read");
+    STAssertTrue(objectsAreEqual(expected, fileObject), @"file object must match the transformed items");
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+@end